@@ -0,0 +1,76 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  ConvertParams.cpp - Converts Parameter Files between XML and Binary
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+/*
+ * Converts instruments (.xiz), songs (.xmz) or any other parameter file
+ * between XML and the binary format. The input format is detected, the
+ * output is binary unless -x is given. Loading accepts both formats, so a
+ * converted file may keep its name.
+ *
+ * usage: zynaddsubfx-convert-params [-x] [-z level] IN OUT
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "Misc/MiddleWare.h"
+#include "Misc/XMLwrapper.h"
+#include "globals.h"
+using namespace std;
+using namespace zyn;
+
+// for linking purposes only:
+MiddleWare *middleware = 0;
+char *instance_name=(char*)"";
+
+static int usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-x] [-z level] IN OUT\n"
+            "  -x        write XML instead of the binary format\n"
+            "  -z level  gzip level of the XML (0 for plain text)\n", name);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    bool xml         = false;
+    int  compression = 3;
+    int  opt;
+    while((opt = getopt(argc, argv, "xz:")) != -1) {
+        switch(opt) {
+            case 'x':
+                xml = true;
+                break;
+            case 'z':
+                compression = atoi(optarg);
+                break;
+            default:
+                return usage(argv[0]);
+        }
+    }
+    if(argc - optind != 2)
+        return usage(argv[0]);
+
+    XMLwrapper params;
+    if(params.loadXMLfile(argv[optind]) < 0) {
+        fprintf(stderr, "Could not load %s\n", argv[optind]);
+        return 1;
+    }
+
+    const int result = xml ? params.saveXMLfile(argv[optind + 1], compression)
+                           : params.saveBinaryFile(argv[optind + 1]);
+    if(result < 0) {
+        fprintf(stderr, "Could not save %s\n", argv[optind + 1]);
+        return 1;
+    }
+    return 0;
+}
@@ -19,21 +19,15 @@
 
 namespace zyn {
 
-static pthread_mutex_t *mutex = NULL;
+//The fftw planner is not thread safe
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
 FFTwrapper::FFTwrapper(int fftsize_)
 {
-    //first one will spawn the mutex (yeah this may be a race itself)
-    if(!mutex) {
-        mutex = new pthread_mutex_t;
-        pthread_mutex_init(mutex, NULL);
-    }
-
-
     fftsize  = fftsize_;
     time     = new fftw_real[fftsize];
     fft      = new fftw_complex[fftsize + 1];
-    pthread_mutex_lock(mutex);
+    pthread_mutex_lock(&mutex);
     planfftw = fftw_plan_dft_r2c_1d(fftsize,
                                     time,
                                     fft,
@@ -42,15 +36,15 @@ FFTwrapper::FFTwrapper(int fftsize_)
                                         fft,
                                         time,
                                         FFTW_ESTIMATE);
-    pthread_mutex_unlock(mutex);
+    pthread_mutex_unlock(&mutex);
 }
 
 FFTwrapper::~FFTwrapper()
 {
-    pthread_mutex_lock(mutex);
+    pthread_mutex_lock(&mutex);
     fftw_destroy_plan(planfftw);
     fftw_destroy_plan(planfftw_inv);
-    pthread_mutex_unlock(mutex);
+    pthread_mutex_unlock(&mutex);
 
     delete [] time;
     delete [] fft;
@@ -88,10 +82,9 @@ void FFTwrapper::freqs2smps(const fft_t *freqs, float *smps)
 
 void FFT_cleanup()
 {
+    pthread_mutex_lock(&mutex);
     fftw_cleanup();
-    pthread_mutex_destroy(mutex);
-    delete mutex;
-    mutex = NULL;
+    pthread_mutex_unlock(&mutex);
 }
 
 }
@@ -0,0 +1,169 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  Resampler.cpp - Windowed sinc polyphase sample rate converter
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+#include "Resampler.h"
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+namespace zyn {
+
+//Phases stored for one input sample when the rates have no small ratio
+#define MAX_PHASES 1024
+
+//filter length (at 1:1), Kaiser beta and passband per quality
+static const int   qualityTaps[] = {16, 32, 64};
+static const float qualityBeta[] = {6.0f, 8.0f, 10.0f};
+static const float qualityBand[] = {0.85f, 0.90f, 0.95f};
+
+static unsigned gcd(unsigned a, unsigned b)
+{
+    while(b) {
+        const unsigned t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+//modified Bessel function of the first kind
+static double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for(int k = 1; k < 50 && term > sum * 1e-12; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum  += term;
+    }
+    return sum;
+}
+
+//Sum of products, kept in 8 partial sums so that the loop vectorizes
+static inline float dot(const float *x, const float *h, int n)
+{
+    float acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for(int i = 0; i < n; i += 8)
+        for(int k = 0; k < 8; ++k)
+            acc[k] += x[i + k] * h[i + k];
+    return ((acc[0] + acc[4]) + (acc[1] + acc[5]))
+           + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+Resampler::Resampler(unsigned srcRate, unsigned dstRate, int maxIn_,
+                     int quality)
+    :src(srcRate), dst(dstRate), maxIn(maxIn_)
+{
+    if(quality < Fast || quality > Best)
+        quality = Best;
+
+    //when decimating the cutoff drops, so the filter gets longer
+    const unsigned ratio = (src + dst - 1) / dst;
+    taps = qualityTaps[quality] * (ratio > 1 ? ratio : 1);
+    taps = (taps + 7) / 8 * 8;
+
+    //the position advances by exactly M/L input samples per output
+    const unsigned g = gcd(src, dst);
+    const unsigned L = dst / g, M = src / g;
+    interp   = L > MAX_PHASES;
+    phases   = interp ? MAX_PHASES : L;
+    den      = L;
+    stepInt  = M / L;
+    stepFrac = M % L;
+
+    //cutoff relative to the input nyquist frequency
+    const double cutoff = qualityBand[quality]
+                          * (dst < src ? (double)dst / src : 1.0);
+    const double beta   = qualityBeta[quality];
+    const double half   = taps / 2;
+    coeff = new float[(phases + 1) * taps];
+    for(int p = 0; p <= phases; ++p) {
+        float *h   = coeff + p * taps;
+        double sum = 0.0;
+        for(int j = 0; j < taps; ++j) {
+            //distance of the output position to input sample j
+            const double t = half - 1 - j + (double)p / phases;
+            const double x = M_PI * cutoff * t;
+            const double s = fabs(x) < 1e-9 ? 1.0 : sin(x) / x;
+            const double w = t / half;
+            const double k = fabs(w) >= 1.0 ? 0.0
+                             : bessel_i0(beta * sqrt(1 - w * w))
+                               / bessel_i0(beta);
+            h[j] = s * k;
+            sum += h[j];
+        }
+        //unity gain at DC for every phase
+        for(int j = 0; j < taps; ++j)
+            h[j] /= sum;
+    }
+
+    hist = new float[taps + maxIn];
+    reset();
+}
+
+Resampler::~Resampler()
+{
+    delete [] coeff;
+    delete [] hist;
+}
+
+void Resampler::reset()
+{
+    //centre the first window on the first input sample
+    memset(hist, 0, (taps + maxIn) * sizeof(float));
+    fill = taps / 2 - 1;
+    ipos = 0;
+    frac = 0;
+}
+
+int Resampler::maxOut(int n) const
+{
+    return (uint64_t)n * dst / src + 2;
+}
+
+float Resampler::phaseOut(const float *x, unsigned f) const
+{
+    if(!interp)
+        return dot(x, coeff + f * taps, taps);
+    const uint64_t t = (uint64_t)f * phases;
+    const unsigned p = t / den;
+    const float    w = (t % den) / (float)den;
+    const float    a = dot(x, coeff + p * taps, taps);
+    const float    b = dot(x, coeff + (p + 1) * taps, taps);
+    return a + w * (b - a);
+}
+
+int Resampler::process(const float *in, int n, float *out)
+{
+    if(n > maxIn)
+        n = maxIn;
+    memcpy(hist + fill, in, n * sizeof(float));
+    fill += n;
+
+    int count = 0;
+    while(ipos + taps <= fill) {
+        out[count++] = phaseOut(hist + ipos, frac);
+        ipos += stepInt;
+        frac += stepFrac;
+        if(frac >= den) {
+            frac -= den;
+            ipos++;
+        }
+    }
+
+    //keep the samples the next windows still need
+    const int keep = fill - ipos;
+    memmove(hist, hist + ipos, keep * sizeof(float));
+    fill = keep;
+    ipos = 0;
+    return count;
+}
+
+}
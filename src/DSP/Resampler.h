@@ -0,0 +1,75 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  Resampler.h - Windowed sinc polyphase sample rate converter
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include "../globals.h"
+
+namespace zyn {
+
+/**Converts one channel from one sample rate to another
+ *
+ * The signal is filtered with a Kaiser windowed sinc, stored as a table
+ * of phases. For rates with a small common divisor (44.1/48/96kHz and the
+ * like) there is one phase per output position, for others neighbouring
+ * phases are interpolated. The filter state persists between calls, so a
+ * stream may be converted in blocks of any size up to maxIn.
+ *
+ * Only the constructor allocates.*/
+class Resampler
+{
+    public:
+        enum Quality {
+            Fast   = 0,
+            Medium = 1,
+            Best   = 2
+        };
+
+        Resampler(unsigned srcRate, unsigned dstRate, int maxIn,
+                  int quality = Best);
+        ~Resampler();
+
+        /**Convert n (at most maxIn) samples
+         * @return number of samples written to out (at most maxOut(n))*/
+        int process(const float *in, int n, float *out) REALTIME;
+
+        /**Largest number of samples process() writes for n inputs*/
+        int maxOut(int n) const;
+
+        /**Forget the filter state*/
+        void reset();
+
+        unsigned srcRate() const {return src; }
+        unsigned dstRate() const {return dst; }
+
+    private:
+        float phaseOut(const float *x, unsigned frac) const;
+
+        unsigned src, dst;
+        int      maxIn;
+        int      taps;       //filter length (a multiple of 8)
+        int      phases;     //number of phases in the table
+        bool     interp;     //interpolate between phases
+        unsigned den;        //denominator of the position fraction
+        unsigned stepInt, stepFrac; //input samples per output sample
+        float   *coeff;      //(phases + 1) x taps
+
+        float   *hist;       //taps + maxIn input samples
+        int      fill;       //samples in hist
+        int      ipos;       //first sample of the next window
+        unsigned frac;       //fractional position in 1/den
+};
+
+}
+
+#endif
@@ -26,7 +26,8 @@
 
 namespace zyn {
 
-Unison::Unison(Allocator *alloc_, int update_period_samples_, float max_delay_sec_, float srate_f)
+Unison::Unison(Allocator *alloc_, int update_period_samples_, float max_delay_sec_, float srate_f,
+               prng_t seed)
     :unison_size(0),
       base_freq(1.0f),
       uv(NULL),
@@ -39,6 +40,7 @@ Unison::Unison(Allocator *alloc_, int update_period_samples_, float max_delay_se
       unison_amplitude_samples(0.0f),
       unison_bandwidth_cents(10.0f),
       samplerate_f(srate_f),
+      prng_state(seed),
       alloc(*alloc_)
 {
     if(max_delay < 10)
@@ -60,6 +62,8 @@ void Unison::setSize(int new_size)
     unison_size = new_size;
     alloc.devalloc(uv);
     uv = alloc.valloc<UnisonVoice>(unison_size);
+    for(int i = 0; i < unison_size; ++i)
+        uv[i].position = prng_float(prng_state) * 1.8f - 0.9f;
     first_time = true;
     updateParameters();
 }
@@ -93,11 +97,11 @@ void Unison::updateParameters(void)
                                   / (float) update_period_samples;
 //	printf("#%g, %g\n",increments_per_second,base_freq);
     for(int i = 0; i < unison_size; ++i) {
-        float base = powf(UNISON_FREQ_SPAN, SYNTH_T::numRandom() * 2.0f - 1.0f);
+        float base = powf(UNISON_FREQ_SPAN, prng_float(prng_state) * 2.0f - 1.0f);
         uv[i].relative_amplitude = base;
         float period = base / base_freq;
         float m      = 4.0f / (period * increments_per_second);
-        if(SYNTH_T::numRandom() < 0.5f)
+        if(prng_float(prng_state) < 0.5f)
             m = -m;
         uv[i].step = m;
 //		printf("%g %g\n",uv[i].relative_amplitude,period);
@@ -26,7 +26,8 @@ class Allocator;
 class Unison
 {
     public:
-        Unison(Allocator *alloc_, int update_period_samples_, float max_delay_sec_, float srate_f);
+        Unison(Allocator *alloc_, int update_period_samples_, float max_delay_sec_, float srate_f,
+               prng_t seed = 0x1234);
         ~Unison();
 
         void setSize(int new_size);
@@ -50,7 +51,7 @@ class Unison
             float lin_fpos;
             float lin_ffreq;
             UnisonVoice() {
-                position = RND * 1.8f - 0.9f;
+                position = 0.0f;
                 realpos1 = 0.0f;
                 realpos2 = 0.0f;
                 step     = 0.0f;
@@ -68,6 +69,7 @@ class Unison
 
         // current setup
         float samplerate_f;
+        prng_t prng_state;
         Allocator &alloc;
 };
 
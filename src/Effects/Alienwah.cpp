@@ -56,6 +56,10 @@ rtosc::Ports Alienwah::ports = {
     rEffPar(Plrcross,  9, rShort("l/r"), rDefault(0), "Left/Right Crossover"),
     rEffPar(Pphase,   10, rShort("phase"), rDefault(64), rPreset(2, 42),
             rPreset(3, 86), "Phase"),
+    rEffParOpt(Psync, 11, rShort("sync"),
+            rOptions(off, 1/16, 1/8t, 1/8, 1/4t, 1/8d, 1/4, 1/2t, 1/4d, 1/2, 1/2d,
+                     1 bar, 2 bars, 4 bars),
+            rDefault(off), "LFO tempo sync (overrides the frequency)"),
 };
 #undef rBegin
 #undef rEnd
@@ -63,7 +67,7 @@ rtosc::Ports Alienwah::ports = {
 
 Alienwah::Alienwah(EffectParams pars)
     :Effect(pars),
-      lfo(pars.srate, pars.bufsize),
+      lfo(pars.srate, pars.bufsize, pars.transport, pars.seed),
       oldl(NULL),
       oldr(NULL)
 {
@@ -248,6 +252,9 @@ void Alienwah::changepar(int npar, unsigned char value)
         case 10:
             setphase(value);
             break;
+        case 11:
+            lfo.Psync = value;
+            break;
     }
 }
 
@@ -265,6 +272,7 @@ unsigned char Alienwah::getpar(int npar) const
         case 8:  return Pdelay;
         case 9:  return Plrcross;
         case 10: return Pphase;
+        case 11: return lfo.Psync;
         default: return 0;
     }
 }
@@ -65,6 +65,10 @@ rtosc::Ports Chorus::ports = {
               "Flange Mode"),
     rEffParTF(Poutsub, 11, rShort("sub"), rPreset(4, true), rPreset(7, true),
               rDefault(false), "Output Subtraction"),
+    rEffParOpt(Psync, 12, rShort("sync"),
+            rOptions(off, 1/16, 1/8t, 1/8, 1/4t, 1/8d, 1/4, 1/2t, 1/4d, 1/2, 1/2d,
+                     1 bar, 2 bars, 4 bars),
+            rDefault(off), "LFO tempo sync (overrides the frequency)"),
 };
 #undef rBegin
 #undef rEnd
@@ -72,7 +76,7 @@ rtosc::Ports Chorus::ports = {
 
 Chorus::Chorus(EffectParams pars)
     :Effect(pars),
-      lfo(pars.srate, pars.bufsize),
+      lfo(pars.srate, pars.bufsize, pars.transport, pars.seed),
       maxdelay((int)(MAX_CHORUS_DELAY / 1000.0f * samplerate_f)),
       delaySample(memory.valloc<float>(maxdelay), memory.valloc<float>(maxdelay))
 {
@@ -289,6 +293,9 @@ void Chorus::changepar(int npar, unsigned char value)
         case 11:
             Poutsub = (value > 1) ? 1 : value;
             break;
+        case 12:
+            lfo.Psync = value;
+            break;
     }
 }
 
@@ -307,6 +314,7 @@ unsigned char Chorus::getpar(int npar) const
         case 9:  return Plrcross;
         case 10: return Pflangemode;
         case 11: return Poutsub;
+        case 12: return lfo.Psync;
         default: return 0;
     }
 }
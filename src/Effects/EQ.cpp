@@ -12,6 +12,7 @@
 */
 
 #include <cmath>
+#include <cstring>
 #include <rtosc/ports.h>
 #include <rtosc/port-sugar.h>
 #include "EQ.h"
@@ -96,6 +97,8 @@ rtosc::Ports EQ::ports = {
 #undef rBegin
 #undef rEnd
 
+static const float unityCoeff[5] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
 EQ::EQ(EffectParams pars)
     :Effect(pars)
 {
@@ -105,8 +108,10 @@ EQ::EQ(EffectParams pars)
         filter[i].Pgain   = 64;
         filter[i].Pq      = 64;
         filter[i].Pstages = 0;
-        filter[i].l = memory.alloc<AnalogFilter>(6, 1000.0f, 1.0f, 0, pars.srate, pars.bufsize);
-        filter[i].r = memory.alloc<AnalogFilter>(6, 1000.0f, 1.0f, 0, pars.srate, pars.bufsize);
+    }
+    for(int i = 0; i < MAX_EQ_BANDS * MAX_FILTER_STAGES; ++i) {
+        memcpy(section[i].target, unityCoeff, sizeof(unityCoeff));
+        section[i].active = false;
     }
     //default values
     Pvolume = 50;
@@ -116,19 +121,111 @@ EQ::EQ(EffectParams pars)
 }
 
 EQ::~EQ()
-{
-       for(int i = 0; i < MAX_EQ_BANDS; ++i) {
-           memory.dealloc(filter[i].l);
-           memory.dealloc(filter[i].r);
-       }
-}
+{}
 
 // Cleanup the effect
 void EQ::cleanup(void)
 {
-    for(int i = 0; i < MAX_EQ_BANDS; ++i) {
-        filter[i].l->cleanup();
-        filter[i].r->cleanup();
+    for(int i = 0; i < MAX_EQ_BANDS * MAX_FILTER_STAGES; ++i) {
+        Section &s = section[i];
+        memcpy(s.coeff, s.target, sizeof(s.coeff));
+        memset(s.step, 0, sizeof(s.step));
+        for(int ch = 0; ch < 2; ++ch)
+            s.x1[ch] = s.x2[ch] = s.y1[ch] = s.y2[ch] = 0.0f;
+        s.smoothing = false;
+        s.active    = memcmp(s.target, unityCoeff, sizeof(unityCoeff)) != 0;
+    }
+}
+
+/*
+ * The coefficients of a section are moved linearly towards their new values
+ * over one buffer.
+ * The set of stable (a1, a2) pairs is convex, so every intermediate biquad
+ * between two stable ones is stable as well and no crossfade between an old
+ * and a new filter is needed.
+ */
+void EQ::settarget(Section &s, const float *target)
+{
+    if(!memcmp(s.target, target, sizeof(s.target)))
+        return;
+    memcpy(s.target, target, sizeof(s.target));
+    if(!s.active && !memcmp(target, unityCoeff, sizeof(unityCoeff)))
+        return;
+    for(int k = 0; k < 5; ++k)
+        s.step[k] = (s.target[k] - s.coeff[k]) / buffersize_f;
+    s.smoothing = true;
+    s.active    = true;
+}
+
+void EQ::updateband(int nb)
+{
+    const auto &F = filter[nb];
+    float coeff[5];
+    memcpy(coeff, unityCoeff, sizeof(coeff));
+    if(F.Ptype != 0) {
+        const float freq = 600.0f * powf(30.0f, (F.Pfreq - 64.0f) / 64.0f);
+        const float gain = dB2rap(30.0f * (F.Pgain - 64.0f) / 64.0f);
+        const float q    = powf(30.0f, (F.Pq - 64.0f) / 64.0f);
+        int order = 0;
+        const AnalogFilter::Coeff c = AnalogFilter::computeCoeff(F.Ptype - 1,
+                freq, q, F.Pstages, gain, samplerate_f, order);
+        coeff[0] = c.c[0];
+        coeff[1] = c.c[1];
+        coeff[2] = c.c[2];
+        coeff[3] = c.d[1];
+        coeff[4] = c.d[2];
+    }
+
+    for(int j = 0; j < MAX_FILTER_STAGES; ++j) {
+        const bool used = F.Ptype != 0 && j <= F.Pstages;
+        settarget(section[nb * MAX_FILTER_STAGES + j],
+                  used ? coeff : unityCoeff);
+    }
+}
+
+//Apply one section of the cascade to both channels
+//The L/R lanes share the coefficients, so the inner loop works on pairs
+void EQ::sectionout(Section &s, float *smpl, float *smpr)
+{
+    float *const smp[2] = {smpl, smpr};
+    float x1[2] = {s.x1[0], s.x1[1]}, x2[2] = {s.x2[0], s.x2[1]};
+    float y1[2] = {s.y1[0], s.y1[1]}, y2[2] = {s.y2[0], s.y2[1]};
+    float c[5];
+    memcpy(c, s.coeff, sizeof(c));
+    const bool smoothing = s.smoothing;
+
+    for(int i = 0; i < buffersize; ++i) {
+        if(smoothing)
+            for(int k = 0; k < 5; ++k)
+                c[k] += s.step[k];
+        for(int ch = 0; ch < 2; ++ch) {
+            const float x = smp[ch][i];
+            const float y = c[0] * x + c[1] * x1[ch] + c[2] * x2[ch]
+                            + c[3] * y1[ch] + c[4] * y2[ch];
+            x2[ch]     = x1[ch];
+            x1[ch]     = x;
+            y2[ch]     = y1[ch];
+            y1[ch]     = y;
+            smp[ch][i] = y;
+        }
+    }
+
+    for(int ch = 0; ch < 2; ++ch) {
+        s.x1[ch] = x1[ch];
+        s.x2[ch] = x2[ch];
+        s.y1[ch] = y1[ch];
+        s.y2[ch] = y2[ch];
+    }
+
+    if(smoothing) {
+        //Remove the accumulated rounding error of the ramp
+        memcpy(s.coeff, s.target, sizeof(s.coeff));
+        s.smoothing = false;
+        if(!memcmp(s.target, unityCoeff, sizeof(unityCoeff))) {
+            s.active = false;
+            for(int ch = 0; ch < 2; ++ch)
+                s.x1[ch] = s.x2[ch] = s.y1[ch] = s.y2[ch] = 0.0f;
+        }
     }
 }
 
@@ -140,12 +237,9 @@ void EQ::out(const Stereo<float *> &smp)
         efxoutr[i] = smp.r[i] * volume;
     }
 
-    for(int i = 0; i < MAX_EQ_BANDS; ++i) {
-        if(filter[i].Ptype == 0)
-            continue;
-        filter[i].l->filterout(efxoutl);
-        filter[i].r->filterout(efxoutr);
-    }
+    for(int i = 0; i < MAX_EQ_BANDS * MAX_FILTER_STAGES; ++i)
+        if(section[i].active)
+            sectionout(section[i], efxoutl, efxoutr);
 }
 
 
@@ -190,43 +284,30 @@ void EQ::changepar(int npar, unsigned char value)
         return;
     int bp = npar % 5; //band paramenter
 
-    float tmp;
     switch(bp) {
         case 0:
             filter[nb].Ptype = value;
             if(value > 9)
                 filter[nb].Ptype = 0;  //has to be changed if more filters will be added
-            if(filter[nb].Ptype != 0) {
-                filter[nb].l->settype(value - 1);
-                filter[nb].r->settype(value - 1);
-            }
             break;
         case 1:
             filter[nb].Pfreq = value;
-            tmp = 600.0f * powf(30.0f, (value - 64.0f) / 64.0f);
-            filter[nb].l->setfreq(tmp);
-            filter[nb].r->setfreq(tmp);
             break;
         case 2:
             filter[nb].Pgain = value;
-            tmp = 30.0f * (value - 64.0f) / 64.0f;
-            filter[nb].l->setgain(tmp);
-            filter[nb].r->setgain(tmp);
             break;
         case 3:
             filter[nb].Pq = value;
-            tmp = powf(30.0f, (value - 64.0f) / 64.0f);
-            filter[nb].l->setq(tmp);
-            filter[nb].r->setq(tmp);
             break;
         case 4:
             filter[nb].Pstages = value;
             if(value >= MAX_FILTER_STAGES)
                 filter[nb].Pstages = MAX_FILTER_STAGES - 1;
-            filter[nb].l->setstages(value);
-            filter[nb].r->setstages(value);
             break;
+        default:
+            return;
     }
+    updateband(nb);
 }
 
 unsigned char EQ::getpar(int npar) const
@@ -267,13 +348,38 @@ unsigned char EQ::getpar(int npar) const
 
 float EQ::getfreqresponse(float freq)
 {
-    float resp = 1.0f;
+    float dB;
+    getfreqresponse(&freq, &dB, 1);
+    return dB;
+}
+
+void EQ::getfreqresponse(const float *freq, float *dB, int n) const
+{
+    //Gather the sections in use once for all of the requested points
+    const float *coeff[MAX_EQ_BANDS * MAX_FILTER_STAGES];
+    int nsections = 0;
     for(int i = 0; i < MAX_EQ_BANDS; ++i) {
         if(filter[i].Ptype == 0)
             continue;
-        resp *= filter[i].l->H(freq);
+        for(int j = 0; j <= filter[i].Pstages; ++j)
+            coeff[nsections++] = section[i * MAX_FILTER_STAGES + j].target;
+    }
+
+    for(int i = 0; i < n; ++i) {
+        const float fr  = freq[i] / samplerate_f * PI * 2.0f;
+        const float cs1 = cosf(fr), sn1 = sinf(fr);
+        const float cs2 = cosf(2.0f * fr), sn2 = sinf(2.0f * fr);
+        float h = 1.0f;
+        for(int j = 0; j < nsections; ++j) {
+            const float *c = coeff[j];
+            const float nx = c[0] + c[1] * cs1 + c[2] * cs2;
+            const float ny = -c[1] * sn1 - c[2] * sn2;
+            const float dx = 1.0f - c[3] * cs1 - c[4] * cs2;
+            const float dy = c[3] * sn1 + c[4] * sn2;
+            h *= (nx * nx + ny * ny) / (dx * dx + dy * dy);
+        }
+        dB[i] = rap2dB(sqrtf(h) * outvolume);
     }
-    return rap2dB(resp * outvolume);
 }
 
 //Not exactly the most efficient manner to derive the total taps, but it should
@@ -287,10 +393,11 @@ void EQ::getFilter(float *a, float *b) const
         auto &F = filter[i];
         if(F.Ptype == 0)
             continue;
-        const double Fb[3] = {F.l->coeff.c[0], F.l->coeff.c[1], F.l->coeff.c[2]};
-        const double Fa[3] = {1.0f, -F.l->coeff.d[1], -F.l->coeff.d[2]};
 
         for(int j=0; j<F.Pstages+1; ++j) {
+            const float *c = section[i * MAX_FILTER_STAGES + j].target;
+            const double Fb[3] = {c[0], c[1], c[2]};
+            const double Fa[3] = {1.0f, -c[3], -c[4]};
             for(int k=0; k<3; ++k) {
                 a[off] = Fa[k];
                 b[off] = Fb[k];
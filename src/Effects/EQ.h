@@ -30,6 +30,11 @@ class EQ:public Effect
         unsigned char getpar(int npar) const;
         void cleanup(void);
         float getfreqresponse(float freq);
+        /**Evaluate the response (in dB) of the whole EQ at n frequencies
+         * @param freq  frequencies in Hz
+         * @param dB    output response for every frequency
+         * @param n     number of points*/
+        void getfreqresponse(const float *freq, float *dB, int n) const;
 
         void getFilter(float *a/*[MAX_EQ_BANDS*MAX_FILTER_STAGES*3]*/,
                        float *b/*[MAX_EQ_BANDS*MAX_FILTER_STAGES*3]*/) const;
@@ -44,15 +49,27 @@ class EQ:public Effect
         struct {
             //parameters
             unsigned char Ptype, Pfreq, Pgain, Pq, Pstages;
-            //internal values
-
-            /* TODO
-             * The analog filters here really ought to be dumbed down some as
-             * you are just looking to do a batch convolution in the end
-             * Perhaps some static functions to do the filter design?
-             */
-            class AnalogFilter *l, *r;
         } filter[MAX_EQ_BANDS];
+
+        /* All bands are rendered as one cascade of biquads.
+         * Band n owns the sections [n*MAX_FILTER_STAGES, (n+1)*MAX_FILTER_STAGES)
+         * and uses the first Pstages+1 of them, the others are kept at unity.
+         * Coefficients are stored as {b0, b1, b2, a1, a2} using the
+         * AnalogFilter sign convention (y = b.x + a1*y1 + a2*y2).
+         */
+        struct Section {
+            float coeff[5];  //coefficients currently applied
+            float target[5]; //coefficients requested by the parameters
+            float step[5];   //per sample increment while smoothing
+            float x1[2], x2[2], y1[2], y2[2]; //history of the L/R lanes
+            bool  smoothing; //coeff is moving towards target
+            bool  active;    //section is not a unity pass-through
+        } section[MAX_EQ_BANDS * MAX_FILTER_STAGES];
+
+        //Recompute the target coefficients of band nb
+        void updateband(int nb);
+        void settarget(Section &s, const float *target);
+        void sectionout(Section &s, float *smpl, float *smpr);
 };
 
 }
@@ -17,6 +17,7 @@
 #include <rtosc/ports.h>
 #include <rtosc/port-sugar.h>
 #include "../Misc/Allocator.h"
+#include "../Misc/Time.h"
 #include "Echo.h"
 
 #define MAX_DELAY 2
@@ -56,6 +57,10 @@ rtosc::Ports Echo::ports = {
     rEffPar(Phidamp,  6, rShort("damp"),
             rPresets(0, 0, 10, 0, 48, 24, 18, 36, 55),
             "Dampen High Frequencies"),
+    rEffParOpt(Psync, 7, rShort("sync"),
+            rOptions(off, 1/16, 1/8t, 1/8, 1/4t, 1/8d, 1/4, 1/2t, 1/4d, 1/2, 1/2d,
+                     1 bar, 2 bars, 4 bars),
+            rDefault(off), "Tempo sync (overrides the delay)"),
 };
 #undef rBegin
 #undef rEnd
@@ -68,6 +73,7 @@ Echo::Echo(EffectParams pars)
       Plrdelay(100),
       Pfb(40),
       Phidamp(60),
+      Psync(0),
       delayTime(1),
       lrdelay(0),
       avgDelay(0),
@@ -101,24 +107,51 @@ inline int max(int a, int b)
     return a > b ? a : b;
 }
 
+inline int min(int a, int b)
+{
+    return a < b ? a : b;
+}
+
 //Initialize the delays
 void Echo::initdelays(void)
 {
     cleanup();
+    setdelaylengths();
+    delta = ndelta;
+}
+
+//Compute the target delay lengths, out() glides towards them
+void Echo::setdelaylengths(void)
+{
     //number of seconds to delay left chan
     float dl = avgDelay - lrdelay;
 
     //number of seconds to delay right chan
     float dr = avgDelay + lrdelay;
 
-    ndelta.l = max(1, (int) (dl * samplerate));
-    ndelta.r = max(1, (int) (dr * samplerate));
-    delta = ndelta;
+    const int maxdelta = MAX_DELAY * samplerate - 1;
+    ndelta.l = min(maxdelta, max(1, (int) (dl * samplerate)));
+    ndelta.r = min(maxdelta, max(1, (int) (dr * samplerate)));
+}
+
+//Follow the tempo of the transport
+//Tempo changes glide to the new length rather than clearing the buffer
+void Echo::syncdelays(void)
+{
+    const float beatDelay =
+        Transport::division(Psync) * transport->secondsPerBeat();
+    if(beatDelay == avgDelay)
+        return;
+    avgDelay = beatDelay;
+    setdelaylengths();
 }
 
 //Effect output
 void Echo::out(const Stereo<float *> &input)
 {
+    if(Psync && transport)
+        syncdelays();
+
     for(int i = 0; i < buffersize; ++i) {
         float ldl = delay.l[pos.l];
         float rdl = delay.r[pos.r];
@@ -174,7 +207,10 @@ void Echo::setvolume(unsigned char _Pvolume)
 void Echo::setdelay(unsigned char _Pdelay)
 {
     Pdelay   = _Pdelay;
-    avgDelay = (Pdelay / 127.0f * 1.5f); //0 .. 1.5 sec
+    if(Psync && transport)
+        avgDelay = Transport::division(Psync) * transport->secondsPerBeat();
+    else
+        avgDelay = (Pdelay / 127.0f * 1.5f); //0 .. 1.5 sec
     initdelays();
 }
 
@@ -202,6 +238,12 @@ void Echo::sethidamp(unsigned char _Phidamp)
     hidamp  = 1.0f - Phidamp / 127.0f;
 }
 
+void Echo::setsync(unsigned char _Psync)
+{
+    Psync = _Psync;
+    setdelay(Pdelay);
+}
+
 void Echo::setpreset(unsigned char npreset)
 {
     const int     PRESET_SIZE = 7;
@@ -252,6 +294,9 @@ void Echo::changepar(int npar, unsigned char value)
         case 6:
             sethidamp(value);
             break;
+        case 7:
+            setsync(value);
+            break;
     }
 }
 
@@ -265,6 +310,7 @@ unsigned char Echo::getpar(int npar) const
         case 4:  return Plrcross;
         case 5:  return Pfb;
         case 6:  return Phidamp;
+        case 7:  return Psync;
         default: return 0; // in case of bogus parameter number
     }
 }
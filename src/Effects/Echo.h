@@ -39,6 +39,7 @@ class Echo:public Effect
          *   -# L/R Crossover
          *   -# Feedback
          *   -# Dampening
+         *   -# Tempo Sync
          * @param npar number of chosen parameter
          * @param value the new value
          */
@@ -55,6 +56,7 @@ class Echo:public Effect
          *   -# L/R Crossover
          *   -# Feedback
          *   -# Dampening
+         *   -# Tempo Sync
          * @param npar number of chosen parameter
          * @return value of parameter
          */
@@ -70,12 +72,14 @@ class Echo:public Effect
         unsigned char Plrdelay; /**<#4 L/R delay difference*/
         unsigned char Pfb;      /**<#6Feedback*/
         unsigned char Phidamp;  /**<#7Dampening of the Echo*/
+        unsigned char Psync;    /**<#8Tempo division of the delay (0=off)*/
 
         void setvolume(unsigned char _Pvolume);
         void setdelay(unsigned char _Pdelay);
         void setlrdelay(unsigned char _Plrdelay);
         void setfb(unsigned char _Pfb);
         void sethidamp(unsigned char _Phidamp);
+        void setsync(unsigned char _Psync);
 
         //Real Parameters
         float fb, hidamp;
@@ -85,6 +89,8 @@ class Echo:public Effect
         float       avgDelay;
 
         void initdelays(void);
+        void setdelaylengths(void);
+        void syncdelays(void);
         //2 channel ring buffer
         Stereo<float *> delay;
         Stereo<float>   old;
@@ -21,10 +21,10 @@ namespace zyn {
 
 EffectParams::EffectParams(Allocator &alloc_, bool insertion_, float *efxoutl_, float *efxoutr_,
             unsigned char Ppreset_, unsigned int srate_, int bufsize_, FilterParams *filterpars_,
-            bool filterprotect_)
+            bool filterprotect_, const Transport *transport_, prng_t seed_)
     :alloc(alloc_), insertion(insertion_), efxoutl(efxoutl_), efxoutr(efxoutr_),
      Ppreset(Ppreset_), srate(srate_), bufsize(bufsize_), filterpars(filterpars_),
-     filterprotect(filterprotect_)
+     filterprotect(filterprotect_), transport(transport_), seed(seed_)
 {}
 Effect::Effect(EffectParams pars)
     :Ppreset(pars.Ppreset),
@@ -33,6 +33,7 @@ Effect::Effect(EffectParams pars)
       filterpars(pars.filterpars),
       insertion(pars.insertion),
       memory(pars.alloc),
+      transport(pars.transport),
       samplerate(pars.srate),
       buffersize(pars.bufsize)
 {
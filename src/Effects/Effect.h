@@ -89,10 +89,13 @@ struct EffectParams
      * @param efxoutr_     Effect output buffer Right channel
      * @param filterpars_  pointer to FilterParams array
      * @param Ppreset_     chosen preset
+     * @param transport_   musical clock for tempo synced effects (may be NULL)
+     * @param seed_        seed of the random generators of the effect
      * @return Initialized Effect Parameter object*/
     EffectParams(Allocator &alloc_, bool insertion_, float *efxoutl_, float *efxoutr_,
             unsigned char Ppreset_, unsigned int srate, int bufsize, FilterParams *filterpars_,
-            bool filterprotect=false);
+            bool filterprotect=false, const Transport *transport_=nullptr,
+            prng_t seed_=0x1234);
 
 
     Allocator &alloc;
@@ -104,6 +107,8 @@ struct EffectParams
     int bufsize;
     FilterParams *filterpars;
     bool filterprotect;
+    const Transport *transport;
+    prng_t seed;
 };
 
 /**this class is inherited by the all effects(Reverb, Echo, ..)*/
@@ -171,6 +176,9 @@ class Effect
         //Allocator
         Allocator &memory;
 
+        //Musical clock used by tempo synced parameters (may be NULL)
+        const Transport *transport;
+
         // current setup
         unsigned int samplerate;
         int buffersize;
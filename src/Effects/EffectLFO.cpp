@@ -13,26 +13,31 @@
 
 #include "EffectLFO.h"
 #include "../Misc/Util.h"
+#include "../Misc/Time.h"
 
 #include <cmath>
 #include "globals.h"
 
 namespace zyn {
 
-EffectLFO::EffectLFO(float srate_f, float bufsize_f)
+EffectLFO::EffectLFO(float srate_f, float bufsize_f,
+                     const Transport *transport_, prng_t seed)
     :Pfreq(40),
       Prandomness(0),
       PLFOtype(0),
       Pstereo(64),
+      Psync(0),
       xl(0.0f),
       xr(0.0f),
-      ampl1(RND),
-      ampl2(RND),
-      ampr1(RND),
-      ampr2(RND),
+      prng_state(seed),
+      ampl1(prng_float(prng_state)),
+      ampl2(prng_float(prng_state)),
+      ampr1(prng_float(prng_state)),
+      ampr2(prng_float(prng_state)),
       lfornd(0.0f),
       samplerate_f(srate_f),
-      buffersize_f(bufsize_f)
+      buffersize_f(bufsize_f),
+      transport(transport_)
 {
     updateparams();
 }
@@ -53,7 +58,8 @@ void EffectLFO::updateparams(void)
     if(PLFOtype > 1)
         PLFOtype = 1;  //this has to be updated if more lfo's are added
     lfotype = PLFOtype;
-    xr      = xl + (Pstereo - 64.0f) / 127.0f + 1.0f;
+    stereo  = (Pstereo - 64.0f) / 127.0f + 1.0f;
+    xr      = xl + stereo;
     xr      -= floorf(xr);
 }
 
@@ -79,32 +85,58 @@ float EffectLFO::getlfoshape(float x)
     return out;
 }
 
+float EffectLFO::channelout(float x, float amp1, float amp2)
+{
+    float out = getlfoshape(x);
+    if((lfotype == 0) || (lfotype == 1))
+        out *= (amp1 + x * (amp2 - amp1));
+    return (out + 1.0f) * 0.5f;
+}
+
+//Pick the amplitude of the next cycle (used for "randomness")
+void EffectLFO::newamplitude(float &amp1, float &amp2)
+{
+    amp1 = amp2;
+    amp2 = (1.0f - lfornd) + lfornd * prng_float(prng_state);
+}
+
 //LFO output
 void EffectLFO::effectlfoout(float *outl, float *outr)
 {
-    float out;
+    if(Psync && transport) {
+        //Tempo synced: the phase is derived from the musical position of
+        //the first sample of this buffer rather than accumulated, so it
+        //stays locked to the host after tempo changes and relocations.
+        //Like the free running LFO it is evaluated once per buffer, the
+        //effects interpolate between the values of consecutive buffers.
+        const double pos = transport->beat() / Transport::division(Psync);
+        float nxl = pos - floor(pos);
+        float nxr = nxl + stereo;
+        nxr -= floorf(nxr);
+        if(nxl < xl)
+            newamplitude(ampl1, ampl2);
+        if(nxr < xr)
+            newamplitude(ampr1, ampr2);
+        xl = nxl;
+        xr = nxr;
+        *outl = channelout(xl, ampl1, ampl2);
+        *outr = channelout(xr, ampr1, ampr2);
+        return;
+    }
 
-    out = getlfoshape(xl);
-    if((lfotype == 0) || (lfotype == 1))
-        out *= (ampl1 + xl * (ampl2 - ampl1));
+    *outl = channelout(xl, ampl1, ampl2);
     xl += incx;
     if(xl > 1.0f) {
-        xl   -= 1.0f;
-        ampl1 = ampl2;
-        ampl2 = (1.0f - lfornd) + lfornd * RND;
+        xl -= 1.0f;
+        newamplitude(ampl1, ampl2);
     }
-    *outl = (out + 1.0f) * 0.5f;
 
-    out = getlfoshape(xr);
-    if((lfotype == 0) || (lfotype == 1))
-        out *= (ampr1 + xr * (ampr2 - ampr1));
+    *outr = channelout(xr, ampr1, ampr2);
     xr += incx;
     if(xr > 1.0f) {
-        xr   -= 1.0f;
-        ampr1 = ampr2;
-        ampr2 = (1.0f - lfornd) + lfornd * RND;
+        xr -= 1.0f;
+        newamplitude(ampr1, ampr2);
     }
-    *outr = (out + 1.0f) * 0.5f;
 }
 
 }
@@ -14,14 +14,20 @@
 #ifndef EFFECT_LFO_H
 #define EFFECT_LFO_H
 
+#include "../Misc/Util.h"
+
 namespace zyn {
 
+class Transport;
+
 /**LFO for some of the Effect objects
  * \todo see if this should inherit LFO*/
 class EffectLFO
 {
     public:
-        EffectLFO(float srate_f, float bufsize_f);
+        EffectLFO(float srate_f, float bufsize_f,
+                  const Transport *transport_ = nullptr,
+                  prng_t seed = 0x1234);
         ~EffectLFO();
         void effectlfoout(float *outl, float *outr);
         void updateparams(void);
@@ -29,11 +35,16 @@ class EffectLFO
         unsigned char Prandomness;
         unsigned char PLFOtype;
         unsigned char Pstereo; // 64 is centered
+        unsigned char Psync;   // 0 is free running, else a tempo division
     private:
         float getlfoshape(float x);
+        float channelout(float x, float amp1, float amp2);
+        void  newamplitude(float &amp1, float &amp2);
 
         float xl, xr;
         float incx;
+        float stereo; //phase offset of the right channel
+        prng_t prng_state;
         float ampl1, ampl2, ampr1, ampr2; //necessary for "randomness"
         float lfornd;
         char  lfotype;
@@ -41,6 +52,7 @@ class EffectLFO
         // current setup
         float samplerate_f;
         float buffersize_f;
+        const Transport *transport;
 };
 
 }
@@ -30,6 +30,7 @@
 #include "../Misc/Util.h"
 #include "../Params/FilterParams.h"
 #include "../Misc/Allocator.h"
+#include "../Misc/Time.h"
 
 namespace zyn {
 
@@ -165,7 +166,8 @@ static const rtosc::Ports local_ports = {
 const rtosc::Ports &EffectMgr::ports = local_ports;
 
 EffectMgr::EffectMgr(Allocator &alloc, const SYNTH_T &synth_,
-                     const bool insertion_, const AbsTime *time_)
+                     const bool insertion_, const AbsTime *time_,
+                     const char *location)
     :insertion(insertion_),
       efxoutl(new float[synth_.buffersize]),
       efxoutr(new float[synth_.buffersize]),
@@ -174,6 +176,7 @@ EffectMgr::EffectMgr(Allocator &alloc, const SYNTH_T &synth_,
       efx(NULL),
       time(time_),
       dryonly(false),
+      seed(prng_seed(location)),
       memory(alloc),
       synth(synth_)
 {
@@ -211,7 +214,8 @@ void EffectMgr::changeeffectrt(int _nefx, bool avoidSmash)
     memset(efxoutr, 0, synth.bufferbytes);
     memory.dealloc(efx);
     EffectParams pars(memory, insertion, efxoutl, efxoutr, 0,
-            synth.samplerate, synth.buffersize, filterpars, avoidSmash);
+            synth.samplerate, synth.buffersize, filterpars, avoidSmash,
+            time ? time->transport() : nullptr, seed);
     try {
         switch (nefx) {
             case 1:
@@ -372,12 +376,8 @@ void EffectMgr::out(float *smpsl, float *smpsr)
             }
         return;
     }
-    for(int i = 0; i < synth.buffersize; ++i) {
-        smpsl[i]  += synth.denormalkillbuf[i];
-        smpsr[i]  += synth.denormalkillbuf[i];
-        efxoutl[i] = 0.0f;
-        efxoutr[i] = 0.0f;
-    }
+    memset(efxoutl, 0, synth.bufferbytes);
+    memset(efxoutr, 0, synth.bufferbytes);
     efx->out(smpsl, smpsr);
 
     float volume = efx->volume;
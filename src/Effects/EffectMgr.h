@@ -16,6 +16,7 @@
 
 #include <pthread.h>
 
+#include "../Misc/Util.h"
 #include "../Params/FilterParams.h"
 #include "../Params/Presets.h"
 
@@ -31,7 +32,7 @@ class EffectMgr:public Presets
 {
     public:
         EffectMgr(Allocator &alloc, const SYNTH_T &synth, const bool insertion_,
-              const AbsTime *time_ = nullptr);
+              const AbsTime *time_ = nullptr, const char *location = nullptr);
         ~EffectMgr();
 
         void paste(EffectMgr &e);
@@ -104,6 +105,7 @@ class EffectMgr:public Presets
         char settings[128];
 
         bool dryonly;
+        prng_t seed; //of the effects, derived from the location
         Allocator &memory;
         const SYNTH_T &synth;
 };
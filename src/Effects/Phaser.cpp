@@ -100,6 +100,10 @@ rtosc::Ports Phaser::ports = {
     rEffParTF(Panalog,      14, rShort("analog"),
             rPresetsAt(6, true, true, true, true, true, true), rDefault(false),
             "Use analog phaser"),
+    rEffParOpt(lfo.Psync,   15, rShort("sync"),
+            rOptions(off, 1/16, 1/8t, 1/8, 1/4t, 1/8d, 1/4, 1/2t, 1/4d, 1/2, 1/2d,
+                     1 bar, 2 bars, 4 bars),
+            rDefault(off), "LFO tempo sync (overrides the frequency)"),
 };
 #undef rBegin
 #undef rEnd
@@ -110,8 +114,10 @@ rtosc::Ports Phaser::ports = {
 #define ZERO_ 0.00001f        // Same idea as above.
 
 Phaser::Phaser(EffectParams pars)
-    :Effect(pars), lfo(pars.srate, pars.bufsize), old(NULL), xn1(NULL),
-      yn1(NULL), diff(0.0f), oldgain(0.0f), fb(0.0f)
+    :Effect(pars), lfo(pars.srate, pars.bufsize, pars.transport, pars.seed),
+      old(NULL), xn1(NULL),
+      yn1(NULL), diff(0.0f), oldgain(0.0f), fb(0.0f),
+      mod(memory.valloc<float>(buffersize), memory.valloc<float>(buffersize))
 {
     analog_setup();
     setpreset(Ppreset);
@@ -136,11 +142,9 @@ void Phaser::analog_setup()
 
     barber = 0;  //Deactivate barber pole phasing by default
 
-    mis       = 1.0f;
     Rmin      = 625.0f; // 2N5457 typical on resistance at Vgs = 0
     Rmax      = 22000.0f; // Resistor parallel to FET
     Rmx       = Rmin / Rmax;
-    Rconst    = 1.0f + Rmx; // Handle parallel resistor relationship
     C         = 0.00000005f; // 50 nF
     CFs       = 2.0f * samplerate_f * C;
     invperiod = 1.0f / buffersize_f;
@@ -148,12 +152,11 @@ void Phaser::analog_setup()
 
 Phaser::~Phaser()
 {
-    memory.devalloc(old.l);
-    memory.devalloc(old.r);
-    memory.devalloc(xn1.l);
-    memory.devalloc(xn1.r);
-    memory.devalloc(yn1.l);
-    memory.devalloc(yn1.r);
+    memory.devalloc(old);
+    memory.devalloc(xn1);
+    memory.devalloc(yn1);
+    memory.devalloc(mod.l);
+    memory.devalloc(mod.r);
 }
 
 /*
@@ -169,40 +172,38 @@ void Phaser::out(const Stereo<float *> &input)
 
 void Phaser::AnalogPhase(const Stereo<float *> &input)
 {
-    Stereo<float> gain(0.0f), lfoVal(0.0f), mod(0.0f), g(0.0f), b(0.0f), hpf(
-        0.0f);
+    Stereo<float> lfoVal(0.0f), gain(0.0f), g(0.0f);
 
     lfo.effectlfoout(&lfoVal.l, &lfoVal.r);
-    mod.l = lfoVal.l * width + (depth - 0.5f);
-    mod.r = lfoVal.r * width + (depth - 0.5f);
+    gain.l = lfoVal.l * width + (depth - 0.5f);
+    gain.r = lfoVal.r * width + (depth - 0.5f);
 
-    mod.l = limit(mod.l, ZERO_, ONE_);
-    mod.r = limit(mod.r, ZERO_, ONE_);
+    gain.l = limit(gain.l, ZERO_, ONE_);
+    gain.r = limit(gain.r, ZERO_, ONE_);
 
     if(Phyper) {
         //Triangle wave squared is approximately sin on bottom, tri on top
         //Result is exponential sweep more akin to filter in synth with
         //exponential generator circuitry.
-        mod.l *= mod.l;
-        mod.r *= mod.r;
+        gain.l *= gain.l;
+        gain.r *= gain.r;
     }
 
     //g.l,g.r is Vp - Vgs. Typical FET drain-source resistance follows constant/[1-sqrt(Vp - Vgs)]
-    mod.l = sqrtf(1.0f - mod.l);
-    mod.r = sqrtf(1.0f - mod.r);
+    gain.l = sqrtf(1.0f - gain.l);
+    gain.r = sqrtf(1.0f - gain.r);
 
-    diff.r = (mod.r - oldgain.r) * invperiod;
-    diff.l = (mod.l - oldgain.l) * invperiod;
+    diff.r = (gain.r - oldgain.r) * invperiod;
+    diff.l = (gain.l - oldgain.l) * invperiod;
 
     g = oldgain;
-    oldgain = mod;
+    oldgain = gain;
 
+    //Build the modulation curve of the whole buffer
     for(int i = 0; i < buffersize; ++i) {
         g.l += diff.l; // Linear interpolation between LFO samples
         g.r += diff.r;
 
-        Stereo<float> xn(input.l[i] * pangainL, input.r[i] * pangainR);
-
         if(barber) {
             g.l += 0.25;
             g.l -= floorf(g.l);
@@ -210,14 +211,22 @@ void Phaser::AnalogPhase(const Stereo<float *> &input)
             g.r -= floorf(g.r);
         }
 
-        xn.l = applyPhase(xn.l, g.l, fb.l, hpf.l, yn1.l, xn1.l);
-        xn.r = applyPhase(xn.r, g.r, fb.r, hpf.r, yn1.r, xn1.r);
+        mod.l[i] = g.l;
+        mod.r[i] = g.r;
+    }
 
+    float hpf[2] = {0.0f, 0.0f};
+    for(int i = 0; i < buffersize; ++i) {
+        float xn[2] = {input.l[i] * pangainL, input.r[i] * pangainR};
+        const float gi[2]  = {mod.l[i], mod.r[i]};
+        const float fbi[2] = {fb.l, fb.r};
 
-        fb.l = xn.l * feedback;
-        fb.r = xn.r * feedback;
-        efxoutl[i] = xn.l;
-        efxoutr[i] = xn.r;
+        applyPhase(xn, gi, fbi, hpf);
+
+        fb.l = xn[0] * feedback;
+        fb.r = xn[1] * feedback;
+        efxoutl[i] = xn[0];
+        efxoutr[i] = xn[1];
     }
 
     if(Poutsub) {
@@ -226,34 +235,48 @@ void Phaser::AnalogPhase(const Stereo<float *> &input)
     }
 }
 
-float Phaser::applyPhase(float x, float g, float fb,
-                         float &hpf, float *yn1, float *xn1)
+/*
+ * Both lanes run through the same stages, so the stage loop is outside and
+ * the channel loop inside.
+ *
+ * The FET model of a stage is
+ *     d    = (1 + 2(0.25 + g) hpf^2 distortion) mis
+ *     b    = (Rconst - g) / (d Rmin)
+ *     gain = (CFs - b) / (CFs + b)
+ * which is rewritten as a single division, with the mismatch dependent terms
+ * precomputed per stage by setoffset():
+ *     gain = (CFsR u - (Rconst - g)) / (CFsR u + (Rconst - g))
+ * where u = 1 + 2(0.25 + g) hpf^2 distortion
+ *
+ * This is symmetrical.
+ * FET is not, so this deviates slightly, however sym dist. is
+ * better sounding than a real FET.
+ */
+void Phaser::applyPhase(float *x, const float *g, const float *fb, float *hpf)
 {
+    const float dist[2] = {2.0f * (0.25f + g[0]) * distortion,
+                           2.0f * (0.25f + g[1]) * distortion};
     for(int j = 0; j < Pstages; ++j) { //Phasing routine
-        mis = 1.0f + offsetpct * offset[j];
-
-        //This is symmetrical.
-        //FET is not, so this deviates slightly, however sym dist. is
-        //better sounding than a real FET.
-        float d = (1.0f + 2.0f * (0.25f + g) * hpf * hpf * distortion) * mis;
-        Rconst = 1.0f + mis * Rmx;
-
-        // This is 1/R. R is being modulated to control filter fc.
-        float b    = (Rconst - g) / (d * Rmin);
-        float gain = (CFs - b) / (CFs + b);
-        yn1[j] = gain * (x + yn1[j]) - xn1[j];
-
-        //high pass filter:
-        //Distortion depends on the high-pass part of the AP stage.
-        hpf = yn1[j] + (1.0f - gain) * xn1[j];
-
-        xn1[j] = x;
-        x      = yn1[j];
-        if(j == 1)
-            x += fb;  //Insert feedback after first phase stage
+        float *y1 = yn1 + 2 * j;
+        float *x1 = xn1 + 2 * j;
+        for(int ch = 0; ch < 2; ++ch) {
+            const float u    = CFsR[j] * (1.0f + dist[ch] * hpf[ch] * hpf[ch]);
+            const float r    = Rconst[j] - g[ch];
+            const float gain = (u - r) / (u + r);
+            y1[ch] = gain * (x[ch] + y1[ch]) - x1[ch];
+
+            //high pass filter:
+            //Distortion depends on the high-pass part of the AP stage.
+            hpf[ch] = y1[ch] + (1.0f - gain) * x1[ch];
+
+            x1[ch] = x[ch];
+            x[ch]  = y1[ch];
+            if(j == 1)
+                x[ch] += fb[ch];  //Insert feedback after first phase stage
+        }
     }
-    return x;
 }
+
 void Phaser::normalPhase(const Stereo<float *> &input)
 {
     Stereo<float> gain(0.0f), lfoVal(0.0f);
@@ -272,26 +295,29 @@ void Phaser::normalPhase(const Stereo<float *> &input)
     gain.l = limit(gain.l, ZERO_, ONE_);
     gain.r = limit(gain.r, ZERO_, ONE_);
 
+    //Build the modulation curve of the whole buffer
     for(int i = 0; i < buffersize; ++i) {
         float x  = (float) i / buffersize_f;
         float x1 = 1.0f - x;
-        //TODO think about making panning an external feature
-        Stereo<float> xn(input.l[i] * pangainL + fb.l,
-                         input.r[i] * pangainR + fb.r);
+        mod.l[i] = gain.l * x + oldgain.l * x1;
+        mod.r[i] = gain.r * x + oldgain.r * x1;
+    }
 
-        Stereo<float> g(gain.l * x + oldgain.l * x1,
-                        gain.r * x + oldgain.r * x1);
+    for(int i = 0; i < buffersize; ++i) {
+        //TODO think about making panning an external feature
+        float xn[2] = {input.l[i] * pangainL + fb.l,
+                       input.r[i] * pangainR + fb.r};
+        const float g[2] = {mod.l[i], mod.r[i]};
 
-        xn.l = applyPhase(xn.l, g.l, old.l);
-        xn.r = applyPhase(xn.r, g.r, old.r);
+        applyPhase(xn, g);
 
         //Left/Right crossing
-        crossover(xn.l, xn.r, lrcross);
+        crossover(xn[0], xn[1], lrcross);
 
-        fb.l = xn.l * feedback;
-        fb.r = xn.r * feedback;
-        efxoutl[i] = xn.l;
-        efxoutr[i] = xn.r;
+        fb.l = xn[0] * feedback;
+        fb.r = xn[1] * feedback;
+        efxoutl[i] = xn[0];
+        efxoutr[i] = xn[1];
     }
 
     oldgain = gain;
@@ -302,14 +328,16 @@ void Phaser::normalPhase(const Stereo<float *> &input)
     }
 }
 
-float Phaser::applyPhase(float x, float g, float *old)
+void Phaser::applyPhase(float *x, const float *g)
 {
     for(int j = 0; j < Pstages * 2; ++j) { //Phasing routine
-        float tmp = old[j];
-        old[j] = g * tmp + x;
-        x      = tmp - g * old[j];
+        float *st = old + 2 * j;
+        for(int ch = 0; ch < 2; ++ch) {
+            float tmp = st[ch];
+            st[ch] = g[ch] * tmp + x[ch];
+            x[ch]  = tmp - g[ch] * st[ch];
+        }
     }
-    return x;
 }
 
 /*
@@ -318,15 +346,11 @@ float Phaser::applyPhase(float x, float g, float *old)
 void Phaser::cleanup()
 {
     fb = oldgain = Stereo<float>(0.0f);
+    for(int i = 0; i < Pstages * 2 * 2; ++i)
+        old[i] = 0.0f;
     for(int i = 0; i < Pstages * 2; ++i) {
-        old.l[i] = 0.0f;
-        old.r[i] = 0.0f;
-    }
-    for(int i = 0; i < Pstages; ++i) {
-        xn1.l[i] = 0.0f;
-        yn1.l[i] = 0.0f;
-        xn1.r[i] = 0.0f;
-        yn1.r[i] = 0.0f;
+        xn1[i] = 0.0f;
+        yn1[i] = 0.0f;
     }
 }
 
@@ -365,27 +389,24 @@ void Phaser::setoffset(unsigned char Poffset)
 {
     this->Poffset = Poffset;
     offsetpct     = (float)Poffset / 127.0f;
+    for(int j = 0; j < MAX_PHASER_STAGES; ++j) {
+        const float mis = 1.0f + offsetpct * offset[j];
+        Rconst[j] = 1.0f + mis * Rmx;
+        CFsR[j]   = CFs * Rmin * mis;
+    }
 }
 
 void Phaser::setstages(unsigned char Pstages_)
 {
-    memory.devalloc(old.l);
-    memory.devalloc(old.r);
-    memory.devalloc(xn1.l);
-    memory.devalloc(xn1.r);
-    memory.devalloc(yn1.l);
-    memory.devalloc(yn1.r);
+    memory.devalloc(old);
+    memory.devalloc(xn1);
+    memory.devalloc(yn1);
 
     Pstages = limit<int>(Pstages_, 1, MAX_PHASER_STAGES);
 
-    old = Stereo<float *>(memory.valloc<float>(Pstages * 2),
-                          memory.valloc<float>(Pstages * 2));
-
-    xn1 = Stereo<float *>(memory.valloc<float>(Pstages),
-                          memory.valloc<float>(Pstages));
-
-    yn1 = Stereo<float *>(memory.valloc<float>(Pstages),
-                          memory.valloc<float>(Pstages));
+    old = memory.valloc<float>(Pstages * 2 * 2);
+    xn1 = memory.valloc<float>(Pstages * 2);
+    yn1 = memory.valloc<float>(Pstages * 2);
 
     cleanup();
 }
@@ -501,6 +522,9 @@ void Phaser::changepar(int npar, unsigned char value)
         case 14:
             Panalog = value;
             break;
+        case 15:
+            lfo.Psync = value;
+            break;
     }
 }
 
@@ -524,6 +548,7 @@ unsigned char Phaser::getpar(int npar) const
         case 12: return Phyper;
         case 13: return Pdistortion;
         case 14: return Panalog;
+        case 15: return lfo.Psync;
         default: return 0;
     }
 }
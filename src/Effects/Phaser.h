@@ -66,27 +66,30 @@ class Phaser:public Effect
         bool  barber; //Barber pole phasing flag
         float distortion, width, offsetpct;
         float feedback, depth, phase;
-        Stereo<float *> old, xn1, yn1;
+        //All-pass state with the L/R lanes interleaved ([2*stage + channel])
+        float *old, *xn1, *yn1;
         Stereo<float>   diff, oldgain, fb;
+        Stereo<float *> mod; //Modulation curve of the current buffer
         float invperiod;
         float offset[12];
 
-        float mis;
         float Rmin;     // 3N5457 typical on resistance at Vgs = 0
         float Rmax;     // Resistor parallel to FET
         float Rmx;      // Rmin/Rmax to avoid division in loop
-        float Rconst;   // Handle parallel resistor relationship
         float C;        // Capacitor
         float CFs;      // A constant derived from capacitor and resistor relationships
+        //Per stage constants, derived from the mismatch between FETs
+        float Rconst[MAX_PHASER_STAGES]; // Handle parallel resistor relationship
+        float CFsR[MAX_PHASER_STAGES];   // CFs * Rmin * mismatch
 
         void analog_setup();
         void AnalogPhase(const Stereo<float *> &input);
         //analog case
-        float applyPhase(float x, float g, float fb,
-                         float &hpf, float *yn1, float *xn1);
+        void applyPhase(float *x, const float *g, const float *fb,
+                        float *hpf);
 
         void normalPhase(const Stereo<float *> &input);
-        float applyPhase(float x, float g, float *old);
+        void applyPhase(float *x, const float *g);
 };
 
 }
@@ -93,12 +93,13 @@ Reverb::Reverb(EffectParams pars)
       roomsize(1.0f),
       rs(1.0f),
       bandwidth(NULL),
+      prng_state(pars.seed),
       idelay(NULL),
       lpf(NULL),
       hpf(NULL) // no filter
 {
     for(int i = 0; i < REV_COMBS * 2; ++i) {
-        comblen[i] = 800 + (int)(RND * 1400.0f);
+        comblen[i] = 800 + (int)(prng_float(prng_state) * 1400.0f);
         combk[i]   = 0;
         lpcomb[i]  = 0;
         combfb[i]  = -0.97f;
@@ -106,7 +107,7 @@ Reverb::Reverb(EffectParams pars)
     }
 
     for(int i = 0; i < REV_APS * 2; ++i) {
-        aplen[i] = 500 + (int)(RND * 500.0f);
+        aplen[i] = 500 + (int)(prng_float(prng_state) * 500.0f);
         apk[i]   = 0;
         ap[i]    = NULL;
     }
@@ -362,7 +363,7 @@ void Reverb::settype(unsigned char _Ptype)
     float tmp;
     for(int i = 0; i < REV_COMBS * 2; ++i) {
         if(Ptype == 0)
-            tmp = 800.0f + (int)(RND * 1400.0f);
+            tmp = 800.0f + (int)(prng_float(prng_state) * 1400.0f);
         else
             tmp = combtunings[Ptype][i % REV_COMBS];
         tmp *= roomsize;
@@ -382,7 +383,7 @@ void Reverb::settype(unsigned char _Ptype)
 
     for(int i = 0; i < REV_APS * 2; ++i) {
         if(Ptype == 0)
-            tmp = 500 + (int)(RND * 500.0f);
+            tmp = 500 + (int)(prng_float(prng_state) * 500.0f);
         else
             tmp = aptunings[Ptype][i % REV_APS];
         tmp *= roomsize;
@@ -404,7 +405,8 @@ void Reverb::settype(unsigned char _Ptype)
         //not been verified yet.
         //As this cannot be resized in a RT context, a good upper bound should
         //be found
-        bandwidth = memory.alloc<Unison>(&memory, buffersize / 4 + 1, 2.0f, samplerate_f);
+        bandwidth = memory.alloc<Unison>(&memory, buffersize / 4 + 1, 2.0f, samplerate_f,
+                                         prng(prng_state));
         bandwidth->setSize(50);
         bandwidth->setBaseFrequency(1.0f);
     }
@@ -73,6 +73,7 @@ class Reverb:public Effect
         int   comblen[REV_COMBS * 2];
         int   aplen[REV_APS * 2];
         class Unison * bandwidth;
+        prng_t prng_state; //for the random room type
 
         //Internal Variables
         float *comb[REV_COMBS * 2];
@@ -431,6 +431,11 @@ void Bank::rescanforbanks()
     db->scanBanks();
 }
 
+bool Bank::updatesearchdb()
+{
+    return db->update();
+}
+
 void Bank::setMsb(uint8_t msb)
 {
     if(msb < banks.size() && banks[msb].dir != bankfiletitle)
@@ -462,6 +467,7 @@ void Bank::scanrootdir(string rootdir)
         if((tmp == '/') || (tmp == '\\'))
             separator = "";
     }
+    db->addRootDir(rootdir + separator);
 
     struct dirent *fn;
     while((fn = readdir(dir))) {
@@ -511,8 +517,8 @@ std::vector<std::string> Bank::search(std::string s) const
     std::vector<std::string> out;
     auto vec = db->search(s);
     for(auto e:vec) {
-        out.push_back(e.name);
-        out.push_back(e.bank+e.file);
+        out.push_back(e->name);
+        out.push_back(e->bank+e->file);
     }
     return out;
 }
@@ -59,6 +59,11 @@ class Bank
 
         void rescanforbanks();
 
+        /**Updates the search index with the instruments added, changed or
+         * removed since the last scan
+         * @returns true if the index changed*/
+        bool updatesearchdb() NONREALTIME;
+
         void setMsb(uint8_t msb);
         void setLsb(uint8_t lsb);
 
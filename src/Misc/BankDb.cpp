@@ -2,20 +2,33 @@
 #include "XMLwrapper.h"
 #include "Util.h"
 #include "../globals.h"
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <thread>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
 
 namespace zyn {
 
 static const char* INSTRUMENT_EXTENSION = ".xiz";
 
+//Changes are applied once none came for a while, so that copying a bank
+//is one rebuild, but at the latest after UPDATE_MAX_DELAY_MS
+#define UPDATE_DELAY_MS     250
+#define UPDATE_MAX_DELAY_MS 2000
+
 using std::string;
 typedef BankDb::svec svec;
 typedef BankDb::bvec bvec;
+typedef BankDb::rvec rvec;
 
 BankEntry::BankEntry(void)
-    :id(0), add(false), pad(false), sub(false), time(0)
+    :id(0), add(false), pad(false), sub(false), time(0), size(0)
 {}
 
 bool platform_strcasestr(const char *hay, const char *needle)
@@ -92,23 +105,333 @@ static svec split(string s)
 //    return ss;
 //}
 
-bvec BankDb::search(std::string ss) const
+/*
+ * Search index
+ *
+ * The searched strings are split into words (runs of letters and digits,
+ * lower case). Each distinct word has the list of entries and fields it is
+ * found in, and every sequence of 1 to 3 bytes of the words maps to the
+ * words containing it.
+ *
+ * A keyword made of letters and digits can only match inside a word: the
+ * words containing it are found through its sequences (all trigrams are
+ * intersected for longer keywords) and their entries follow. Other
+ * keywords select the entries through their longest such part and are then
+ * checked against the full strings.
+ */
+
+//searched strings, most relevant first
+enum SearchField {
+    FIELD_NAME, FIELD_FILE, FIELD_TYPE, FIELD_AUTHOR, FIELD_BANK,
+    FIELD_COMMENTS, FIELDS
+};
+static const int fieldWeight[FIELDS] = {16, 8, 4, 4, 2, 1};
+
+static const string &field(const BankEntry &e, int f)
+{
+    switch(f) {
+        case FIELD_NAME:   return e.name;
+        case FIELD_FILE:   return e.file;
+        case FIELD_TYPE:   return e.type;
+        case FIELD_AUTHOR: return e.author;
+        case FIELD_BANK:   return e.bank;
+        default:           return e.comments;
+    }
+}
+
+static bool isword(char c)
+{
+    return isalnum((unsigned char)c);
+}
+
+static string lower(string s)
+{
+    for(auto &c:s)
+        c = tolower((unsigned char)c);
+    return s;
+}
+
+static unsigned gramKey(const char *s, int n)
+{
+    unsigned key = n;
+    for(int i = 0; i < n; ++i)
+        key = (key << 8) | (unsigned char)s[i];
+    return key;
+}
+
+static void intersect(BankDb::ilist &a, const BankDb::ilist &b)
+{
+    auto end = std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                                     a.begin());
+    a.erase(end, a.end());
+}
+
+void BankDb::reindex(void)
+{
+    words.clear();
+    postings.clear();
+    grams.clear();
+    for(auto &e:engines)
+        e.clear();
+
+    std::unordered_map<string, unsigned> known;
+    for(unsigned id = 0; id < fields.size(); ++id) {
+        const BankEntry &e = fields[id];
+        for(int f = 0; f < FIELDS; ++f) {
+            const string s = lower(field(e, f));
+            for(size_t i = 0; i < s.size();) {
+                if(!isword(s[i])) {
+                    ++i;
+                    continue;
+                }
+                size_t j = i;
+                while(j < s.size() && isword(s[j]))
+                    ++j;
+                auto w = known.emplace(s.substr(i, j - i), words.size());
+                if(w.second) {
+                    words.push_back(w.first->first);
+                    postings.emplace_back();
+                }
+                ilist &list = postings[w.first->second];
+                const unsigned posting = id << 3 | f;
+                if(list.empty() || list.back() != posting)
+                    list.push_back(posting);
+                i = j;
+            }
+        }
+
+        if(e.add)
+            engines[0].push_back(id);
+        if(e.pad)
+            engines[1].push_back(id);
+        if(e.sub)
+            engines[2].push_back(id);
+    }
+
+    ilist keys;
+    for(unsigned w = 0; w < words.size(); ++w) {
+        const string &s = words[w];
+        keys.clear();
+        for(unsigned i = 0; i < s.size(); ++i)
+            for(unsigned n = 1; n <= 3 && i + n <= s.size(); ++n)
+                keys.push_back(gramKey(&s[i], n));
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        for(unsigned key:keys)
+            grams[key].push_back(w);
+    }
+
+    order.resize(fields.size());
+    for(unsigned id = 0; id < fields.size(); ++id)
+        order[id] = id;
+    std::sort(order.begin(), order.end(), [this](unsigned a, unsigned b) {
+            return fields[a] < fields[b];
+            });
+    position.resize(fields.size());
+    for(unsigned i = 0; i < order.size(); ++i)
+        position[order[i]] = i;
+}
+
+//Words containing a string of letters and digits
+BankDb::ilist BankDb::wordsWith(const string &s) const
+{
+    static const ilist none;
+    auto find = [this](const char *g, int n) -> const ilist & {
+        auto itr = grams.find(gramKey(g, n));
+        return itr == grams.end() ? none : itr->second;
+    };
+    if(s.size() <= 3)
+        return find(s.c_str(), s.size());
+
+    //the shortest lists first
+    std::vector<const ilist *> lists;
+    for(unsigned i = 0; i + 3 <= s.size(); ++i)
+        lists.push_back(&find(&s[i], 3));
+    std::sort(lists.begin(), lists.end(), [](const ilist *a, const ilist *b) {
+            return a->size() < b->size();
+            });
+    ilist found = *lists[0];
+    for(unsigned i = 1; i < lists.size() && !found.empty(); ++i)
+        intersect(found, *lists[i]);
+
+    found.erase(std::remove_if(found.begin(), found.end(), [&](unsigned w) {
+                return words[w].find(s) == string::npos;
+                }), found.end());
+    return found;
+}
+
+//Rank of a keyword in an entry, 0 if it is not found: the weight of the
+//most relevant field containing it, twice as much at the start of a word
+int BankDb::rank(unsigned id, const string &s) const
 {
-    bvec vec;
-    const svec sterm = split(ss);
-    for(auto field:fields) {
-        bool match = true;
-        for(auto s:sterm)
-            match &= field.match(s);
-        if(match)
-            vec.push_back(field);
+    //s is lower case
+    auto find = [&s](const string &t, size_t from) {
+        for(size_t i = from; i + s.size() <= t.size(); ++i) {
+            size_t k = 0;
+            while(k < s.size() && tolower((unsigned char)t[i + k]) == s[k])
+                ++k;
+            if(k == s.size())
+                return i;
+        }
+        return string::npos;
+    };
+
+    int best = 0;
+    for(int f = 0; f < FIELDS; ++f) {
+        const string &t = field(fields[id], f);
+        for(size_t pos = find(t, 0); pos != string::npos;
+            pos = find(t, pos + 1)) {
+            const bool start = pos == 0 || !isword(t[pos - 1]);
+            best = std::max(best, fieldWeight[f] * (start ? 2 : 1));
+            if(start)
+                break;
+        }
     }
+    return best;
+}
 
-    std::sort(vec.begin(), vec.end());
+rvec BankDb::search(std::string ss) const
+{
+    typedef std::vector<std::pair<unsigned, int>> ranked; //entry, rank
+    const svec sterm = split(lower(ss));
+
+    //Each keyword is a tag or has words containing its longest run of
+    //letters and digits, the keywords with the fewest entries go first
+    struct Keyword {
+        const string *s;
+        int    tag;
+        string part;
+        ilist  words;
+        size_t cost;
+    };
+    std::vector<Keyword> keys;
+    for(auto &s:sterm) {
+        Keyword k{&s, s == "#add" ? 0 : s == "#pad" ? 1 : s == "#sub" ? 2
+                      : -1, "", ilist(), fields.size()};
+        if(k.tag >= 0)
+            k.cost = engines[k.tag].size();
+        else {
+            for(size_t i = 0; i < s.size();) {
+                size_t j = i;
+                while(j < s.size() && isword(s[j]))
+                    ++j;
+                if(j - i > k.part.size())
+                    k.part = s.substr(i, j - i);
+                i = j + 1;
+            }
+            if(!k.part.empty()) {
+                k.words = wordsWith(k.part);
+                k.cost  = 0;
+                for(unsigned w:k.words)
+                    k.cost += postings[w].size();
+            }
+        }
+        keys.push_back(std::move(k));
+    }
+    std::sort(keys.begin(), keys.end(), [](const Keyword &a, const Keyword &b) {
+            return a.cost < b.cost;
+            });
+
+    //entries having all keywords so far, sorted by entry
+    ranked found;
+    bool   all = true;
+    auto   candidate = [&](unsigned id) {
+        return all || std::binary_search(found.begin(), found.end(),
+                                         std::make_pair(id, 0),
+                                         [](const std::pair<unsigned, int> &a,
+                                            const std::pair<unsigned, int> &b) {
+                                             return a.first < b.first;
+                                         });
+    };
+
+    ranked m;
+    for(auto &k:keys) {
+        const string &s = *k.s;
+        m.clear();
+        if(k.tag >= 0) {
+            for(unsigned id:engines[k.tag])
+                if(candidate(id))
+                    m.emplace_back(id, 0);
+        }
+        else if(k.part.empty()) {
+            if(all)
+                for(unsigned id = 0; id < fields.size(); ++id)
+                    m.emplace_back(id, 0);
+            else
+                for(auto &f:found)
+                    m.emplace_back(f.first, 0);
+        }
+        else {
+            for(unsigned w:k.words) {
+                const bool start = !words[w].compare(0, k.part.size(), k.part);
+                for(unsigned posting:postings[w])
+                    if(candidate(posting >> 3))
+                        m.emplace_back(posting >> 3, fieldWeight[posting & 7]
+                                                     * (start ? 2 : 1));
+            }
+            //one entry per match, with its best rank
+            std::sort(m.begin(), m.end());
+            auto out = m.begin();
+            for(auto itr = m.begin(); itr != m.end(); ++itr) {
+                if(out != m.begin() && (out - 1)->first == itr->first)
+                    (out - 1)->second = itr->second;
+                else
+                    *out++ = *itr;
+            }
+            m.erase(out, m.end());
+        }
+
+        //anything else than a single word is checked on the full strings
+        if(k.tag < 0 && k.part.size() != s.size()) {
+            auto out = m.begin();
+            for(auto &c:m)
+                if(int r = rank(c.first, s))
+                    *out++ = {c.first, r};
+            m.erase(out, m.end());
+        }
+
+        //m only holds candidates, so it replaces them
+        if(!all) {
+            auto itr = found.begin();
+            for(auto &c:m) {
+                while(itr->first < c.first)
+                    ++itr;
+                c.second += itr->second;
+            }
+        }
+        found.swap(m);
+        all = false;
+        if(found.empty())
+            return rvec();
+    }
 
+    if(all)
+        for(unsigned id:order)
+            found.emplace_back(id, 0);
+    std::sort(found.begin(), found.end(),
+              [this](const std::pair<unsigned, int> &a,
+                     const std::pair<unsigned, int> &b) {
+                  if(a.second != b.second)
+                      return a.second > b.second;
+                  return position[a.first] < position[b.first];
+              });
+
+    rvec vec;
+    vec.reserve(found.size());
+    for(auto &f:found)
+        vec.push_back(&fields[f.first]);
     return vec;
 }
 
+BankDb::BankDb(void)
+    :notify(-1)
+{}
+
+BankDb::~BankDb(void)
+{
+    clear();
+}
+
 void BankDb::addBankDir(std::string bnk)
 {
     bool repeat = false;
@@ -119,17 +442,33 @@ void BankDb::addBankDir(std::string bnk)
         banks.push_back(bnk);
 }
 
+void BankDb::addRootDir(std::string root)
+{
+    if(std::find(roots.begin(), roots.end(), root) == roots.end())
+        roots.push_back(root);
+}
+
 void BankDb::clear(void)
 {
+    cancelUpdate();
     banks.clear();
+    roots.clear();
     fields.clear();
+    reindex();
+
+    //closing the descriptor drops all watches
+    if(notify >= 0)
+        close(notify);
+    notify = -1;
+    watches.clear();
 }
 
+//Binary (see XMLwrapper::saveBinaryFile()), older xml caches are still read
 static std::string getCacheName(void)
 {
     char name[512] = {0};
     snprintf(name, sizeof(name), "%s%s", getenv("HOME"),
-            "/.zynaddsubfx-bank-cache.xml");
+            "/.zynaddsubfx-bank-index");
     return name;
 }
 
@@ -137,7 +476,12 @@ static bvec loadCache(void)
 {
     bvec cache;
     XMLwrapper xml;
-    xml.loadXMLfile(getCacheName());
+    if(xml.loadXMLfile(getCacheName()) < 0) {
+        char name[512] = {0};
+        snprintf(name, sizeof(name), "%s%s", getenv("HOME"),
+                "/.zynaddsubfx-bank-cache.xml");
+        xml.loadXMLfile(name);
+    }
     if(xml.enterbranch("bank-cache")) {
         auto nodes = xml.getBranch();
 
@@ -155,6 +499,7 @@ static bvec loadCache(void)
             bind(pad, atoi);
             bind(sub, atoi);
             bind(time, atoi);
+            bind(size, atoll);
 #undef bind
             cache.push_back(be);
         }
@@ -162,11 +507,11 @@ static bvec loadCache(void)
     return cache;
 }
 
-static void saveCache(bvec vec)
+static void saveCache(const bvec &vec)
 {
     XMLwrapper xml;
     xml.beginbranch("bank-cache");
-    for(auto value:vec) {
+    for(auto &value:vec) {
         XmlNode binding("instrument-entry");
 #define bind(x) binding[#x] = to_s(value.x);
         bind(file);
@@ -180,68 +525,253 @@ static void saveCache(bvec vec)
         bind(pad);
         bind(sub);
         bind(time);
+        bind(size);
 #undef bind
         xml.add(binding);
     }
     xml.endbranch();
-    xml.saveXMLfile(getCacheName(), 0);
+    xml.saveBinaryFile(getCacheName());
 }
 
 void BankDb::scanBanks(void)
 {
+    cancelUpdate();
     fields.clear();
     bvec cache = loadCache();
     bmap cc;
     for(auto c:cache)
         cc[c.bank + c.file] = c;
 
-    bvec ncache;
-    for(auto bank:banks)
-    {
-        DIR *dir = opendir(bank.c_str());
+    //the results are kept per bank, so their order does not depend on
+    //the scheduling
+    std::vector<bvec> found(banks.size());
+#ifdef WIN32
+    //C++11 threads are broken on mingw cross compilation (see
+    //PADnoteParameters::sampleGenerator())
+    for(unsigned i = 0; i < banks.size(); ++i)
+        found[i] = scanBank(banks[i], cc);
+#else
+    std::atomic<unsigned> next(0);
+    auto worker = [&]() {
+        for(unsigned i; (i = next++) < banks.size();)
+            found[i] = scanBank(banks[i], cc);
+    };
+    const unsigned threads = std::min<size_t>(
+            std::max(1u, std::thread::hardware_concurrency()), banks.size());
+    std::vector<std::thread> pool;
+    for(unsigned i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for(auto &t:pool)
+        t.join();
+#endif
+
+    for(auto &bank:found)
+        fields.insert(fields.end(), bank.begin(), bank.end());
+    saveCache(fields);
+    reindex();
+
+    for(auto &root:roots)
+        watch(root);
+    for(auto &bank:banks)
+        watch(bank);
+}
+
+bvec BankDb::scanBank(std::string bank, const bmap &cache) const
+{
+    bvec entries;
+    DIR *dir = opendir(bank.c_str());
+    if(!dir)
+        return entries;
+
+    struct dirent *fn;
+    while((fn = readdir(dir))) {
+        const char *filename = fn->d_name;
+
+        //check for extension
+        if(!strstr(filename, INSTRUMENT_EXTENSION))
+            continue;
+
+        entries.push_back(processXiz(filename, bank, cache));
+    }
+
+    closedir(dir);
+    return entries;
+}
+
+void BankDb::watch(std::string dir)
+{
+#ifdef __linux__
+    if(notify < 0)
+        notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(notify < 0)
+        return;
+
+    const bool root = std::find(roots.begin(), roots.end(), dir) != roots.end();
+    const uint32_t mask = (root ? IN_CREATE | IN_MOVED_TO
+                                : IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM
+                                  | IN_DELETE)
+                          | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+    const int wd = inotify_add_watch(notify, dir.c_str(), mask);
+    if(wd >= 0)
+        watches[wd] = dir;
+#else
+    (void) dir;
+#endif
+}
+
+void BankDb::forget(std::string bank, std::string file)
+{
+    //without a file the whole directory is gone
+    fields.erase(std::remove_if(fields.begin(), fields.end(),
+                [&](const BankEntry &e) {
+                    return e.bank == bank && (file.empty() || e.file == file);
+                }), fields.end());
+}
 
-        if(!dir)
+//Apply changes to a copy of the entries and index them (worker thread)
+BankDb *BankDb::rebuild(bvec entries, cvec changes) const
+{
+    const bmap none;
+    BankDb *next = new BankDb;
+    next->fields = std::move(entries);
+    for(auto &c:changes) {
+        next->forget(c.bank, c.file);
+        if(!c.read)
             continue;
+        if(c.file.empty())
+            for(auto &e:scanBank(c.bank, none))
+                next->fields.push_back(e);
+        else
+            next->fields.push_back(processXiz(c.file, c.bank, none));
+    }
+    saveCache(next->fields);
+    next->reindex();
+    return next;
+}
 
+void BankDb::swapIndex(BankDb &db)
+{
+    fields.swap(db.fields);
+    words.swap(db.words);
+    postings.swap(db.postings);
+    grams.swap(db.grams);
+    for(int i = 0; i < 3; ++i)
+        engines[i].swap(db.engines[i]);
+    order.swap(db.order);
+    position.swap(db.position);
+}
 
-        struct dirent *fn;
+//Drop the changes not applied yet, waiting for a rebuild in progress
+void BankDb::cancelUpdate(void)
+{
+    if(worker.valid())
+        delete worker.get();
+    pending.clear();
+}
+
+bool BankDb::update(void)
+{
+    bool changed = false;
+#ifdef __linux__
+    using namespace std::chrono;
+    //take over the entries of the last rebuild
+    if(worker.valid()
+       && worker.wait_for(seconds(0)) == std::future_status::ready) {
+        BankDb *next = worker.get();
+        swapIndex(*next);
+        delete next;
+        changed = true;
+    }
 
-        while((fn = readdir(dir))) {
-            const char *filename = fn->d_name;
+    if(notify < 0)
+        return changed;
 
-            //check for extension
-            if(!strstr(filename, INSTRUMENT_EXTENSION))
+    const auto now = steady_clock::now();
+    auto change = [&](const string &bank, const string &file, bool read) {
+        if(pending.empty())
+            firstChange = now;
+        lastChange = now;
+        pending.push_back(Change{bank, file, read});
+    };
+
+    alignas(inotify_event) char buf[4096];
+    ssize_t len;
+    while((len = read(notify, buf, sizeof(buf))) > 0) {
+        for(char *p = buf; p < buf + len;) {
+            const inotify_event *ev = (const inotify_event *)p;
+            p += sizeof(inotify_event) + ev->len;
+
+            auto itr = watches.find(ev->wd);
+            if(itr == watches.end())
+                continue;
+            const string dir = itr->second;
+
+            if(ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                inotify_rm_watch(notify, ev->wd);
+                watches.erase(itr);
+                banks.erase(std::remove(banks.begin(), banks.end(), dir),
+                            banks.end());
+                roots.erase(std::remove(roots.begin(), roots.end(), dir),
+                            roots.end());
+                change(dir, "", false);
+                continue;
+            }
+            if(!ev->len)
+                continue;
+            const string name = ev->name;
+
+            //a new bank in one of the root directories
+            if(std::find(roots.begin(), roots.end(), dir) != roots.end()) {
+                if((ev->mask & IN_ISDIR) && name[0] != '.') {
+                    const string bank = dir + name + "/";
+                    addBankDir(bank);
+                    watch(bank);
+                    change(bank, "", true);
+                }
                 continue;
+            }
 
-            auto xiz = processXiz(filename, bank, cc);
-            fields.push_back(xiz);
-            ncache.push_back(xiz);
+            //a new, changed, renamed or removed instrument
+            if(!strstr(name.c_str(), INSTRUMENT_EXTENSION))
+                continue;
+            change(dir, name, ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO));
         }
+    }
 
-        closedir(dir);
-
+    //one rebuild at a time, the changes coming in meanwhile wait for it
+    if(!pending.empty() && !worker.valid()
+       && (now - lastChange >= milliseconds(UPDATE_DELAY_MS)
+           || now - firstChange >= milliseconds(UPDATE_MAX_DELAY_MS))) {
+        worker = std::async(std::launch::async, &BankDb::rebuild, this,
+                            fields, std::move(pending));
+        pending.clear();
     }
-    saveCache(ncache);
+#endif
+    return changed;
 }
 
 BankEntry BankDb::processXiz(std::string filename,
-        std::string bank, bmap &cache) const
+        std::string bank, const bmap &cache) const
 {
     string fname = bank+filename;
 
     //Grab a timestamp
     struct stat st;
     int time = 0;
+    long long size = 0;
 
     //gah windows, just implement the darn standard APIs
 #ifndef WIN32
     int ret  = lstat(fname.c_str(), &st);
-    if(ret != -1)
+    if(ret != -1) {
 # ifdef __APPLE__
         time = st.st_mtimespec.tv_sec;
 # else
         time = st.st_mtim.tv_sec;
 # endif
+        size = st.st_size;
+    }
 #else
     int ret = 0;
     time = rand();
@@ -249,9 +779,10 @@ BankEntry BankDb::processXiz(std::string filename,
     
 
     //quickly check if the file exists in the cache and if it is up-to-date
-    if(cache.find(fname) != cache.end() &&
-            cache[fname].time == time)
-        return cache[fname];
+    auto cached = cache.find(fname);
+    if(cached != cache.end() && cached->second.time == time
+            && cached->second.size == size)
+        return cached->second;
 
 
 
@@ -288,6 +819,7 @@ BankEntry BankDb::processXiz(std::string filename,
     entry.bank = bank;
     entry.id   = no;
     entry.time = time;
+    entry.size = size;
 
     if(no != 0) //the instrument position in the bank is found
         entry.name = name.substr(startname);
@@ -333,7 +865,7 @@ BankEntry BankDb::processXiz(std::string filename,
         }
         if(xml.enterbranch("INSTRUMENT_KIT")) {
             for(int i = 0; i < NUM_KIT_ITEMS; ++i) {
-                if(xml.enterbranch("INSTRUMENT_KIT_ITEM", i) == 0) {
+                if(xml.enterbranch("INSTRUMENT_KIT_ITEM", i)) {
                     entry.add |= xml.getparbool("add_enabled", false);
                     entry.sub |= xml.getparbool("sub_enabled", false);
                     entry.pad |= xml.getparbool("pad_enabled", false);
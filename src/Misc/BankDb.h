@@ -1,7 +1,10 @@
 #pragma once
+#include <chrono>
+#include <future>
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 namespace zyn {
 
@@ -19,6 +22,7 @@ struct BankEntry
     bool        pad;
     bool        sub;
     int         time;//last update
+    long long   size;//file size at the last update
     typedef std::vector<std::string> svec;
     svec tags(void) const;
     bool match(std::string) const;
@@ -31,12 +35,23 @@ class BankDb
     public:
         typedef std::vector<std::string>        svec;
         typedef std::vector<BankEntry>          bvec;
+        typedef std::vector<const BankEntry *>  rvec;
         typedef std::map<std::string,BankEntry> bmap;
+        typedef std::vector<unsigned>           ilist;
+
+        BankDb(void);
+        ~BankDb(void);
 
         //search for banks
         //uses a space separated list of keywords and
         //finds something that matches ALL keywords
-        bvec search(std::string) const;
+        //#add, #pad and #sub only keep instruments using that engine
+        //the results are ranked by where the keywords were found and stay
+        //valid until the next scan or update
+        //the time grows with the number of entries matched: for 100k
+        //entries selective keywords take up to a millisecond, but keywords
+        //matching tens of thousands of entries take a few milliseconds
+        rvec search(std::string) const;
 
         //fully qualified paths only
         void addBankDir(std::string);
@@ -47,13 +62,62 @@ class BankDb
         //List of all tags
         svec tags(void) const;
 
+        //Root directories are watched for new banks
+        void addRootDir(std::string);
+
         //scan banks
+        //Each bank is scanned by one of a pool of threads, instruments that
+        //are unchanged in the index file (same time and size) are not read
         void scanBanks(void);
 
+        //Apply the changes made to the watched directories since the last
+        //scan or update (inotify, linux only)
+        //the changes are collected until none came for a moment, then a
+        //worker thread reads the instruments and rebuilds the index, which
+        //a later call takes over
+        //returns true if any entry changed
+        bool update(void);
+
     private:
-        BankEntry processXiz(std::string, std::string, bmap&) const;
+        //A change to the watched directories, applied by the worker
+        struct Change {
+            std::string bank;
+            std::string file; //empty for the whole bank
+            bool        read; //read the file (or scan the bank) again
+        };
+        typedef std::vector<Change> cvec;
+
+        bvec scanBank(std::string, const bmap&) const;
+        BankEntry processXiz(std::string, std::string, const bmap&) const;
+        void watch(std::string);
+        void forget(std::string bank, std::string file);
+        void reindex(void);
+        BankDb *rebuild(bvec, cvec) const;
+        void swapIndex(BankDb &);
+        void cancelUpdate(void);
+        ilist wordsWith(const std::string &) const;
+        int rank(unsigned, const std::string &) const;
         bvec fields;
         svec banks;
+        svec roots;
+
+        //Search index over fields
+        svec words;                 //distinct words (lower case)
+        std::vector<ilist> postings; //entry << 3 | field of each word
+        std::unordered_map<unsigned, ilist> grams; //words containing each
+                                                   //1-3 byte sequence
+        ilist engines[3]; //entries using add, pad and sub
+        ilist order;      //entries sorted by bank and file
+        ilist position;   //place of each entry in order
+
+        int notify; //inotify descriptor, -1 if unused
+        std::map<int, std::string> watches; //watch descriptor to directory
+
+        //Changes waiting for the next rebuild, with the time of the first
+        //and the last of them
+        cvec pending;
+        std::chrono::steady_clock::time_point firstChange, lastChange;
+        std::future<BankDb *> worker; //rebuild in progress
 };
 
 }
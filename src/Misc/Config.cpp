@@ -50,6 +50,8 @@ static const rtosc::Ports ports = {
     rToggle(cfg.BankUIAutoClose, "Automatic Closing of BackUI After Patch Selection"),
     rParamI(cfg.GzipCompression, "Level of Gzip Compression For Save Files"),
     rParamI(cfg.Interpolation, "Level of Interpolation, Linear/Cubic"),
+    rParamI(cfg.ResampleQuality, "Quality of the conversion to the output "
+            "sample rate, Fast/Medium/Best"),
     {"cfg.presetsDirList", rDoc("list of preset search directories"), 0,
         [](const char *msg, rtosc::RtData &d)
         {
@@ -122,6 +124,8 @@ static const rtosc::Ports ports = {
     //rArrayS(cfg.presetsDirList,MAX_BANK_ROOT_DIRS),
     rToggle(cfg.CheckPADsynth, "Old Check For PADsynth functionality within a patch"),
     rToggle(cfg.IgnoreProgramChange, "Ignore MIDI Program Change Events"),
+    rParamI(cfg.PartCacheSize, "Number of neighbouring bank instruments kept "
+            "ready for program changes"),
     rParamI(cfg.UserInterfaceMode, "Beginner/Advanced Mode Select"),
     rParamI(cfg.VirKeybLayout, "Keyboard Layout For Virtual Piano Keyboard"),
     //rParamS(cfg.LinuxALSAaudioDev),
@@ -207,8 +211,10 @@ void Config::init()
     cfg.GzipCompression = 3;
 
     cfg.Interpolation = 0;
+    cfg.ResampleQuality = 2;
     cfg.CheckPADsynth = 1;
     cfg.IgnoreProgramChange = 0;
+    cfg.PartCacheSize = 4;
 
     cfg.UserInterfaceMode = 0;
     cfg.VirKeybLayout     = 1;
@@ -336,6 +342,11 @@ void Config::readConfig(const char *filename)
                                            0,
                                            1);
 
+        cfg.ResampleQuality = xmlcfg.getpar("resample_quality",
+                                            cfg.ResampleQuality,
+                                            0,
+                                            2);
+
         cfg.CheckPADsynth = xmlcfg.getpar("check_pad_synth",
                                           cfg.CheckPADsynth,
                                           0,
@@ -346,6 +357,11 @@ void Config::readConfig(const char *filename)
                                           0,
                                           1);
 
+        cfg.PartCacheSize = xmlcfg.getpar("part_cache_size",
+                                          cfg.PartCacheSize,
+                                          0,
+                                          64);
+
 
         cfg.UserInterfaceMode = xmlcfg.getpar("user_interface_mode",
                                               cfg.UserInterfaceMode,
@@ -415,8 +431,10 @@ void Config::saveConfig(const char *filename) const
 
     xmlcfg->addpar("gzip_compression", cfg.GzipCompression);
 
+    xmlcfg->addpar("resample_quality", cfg.ResampleQuality);
     xmlcfg->addpar("check_pad_synth", cfg.CheckPADsynth);
     xmlcfg->addpar("ignore_program_change", cfg.IgnoreProgramChange);
+    xmlcfg->addpar("part_cache_size", cfg.PartCacheSize);
 
     xmlcfg->addparstr("bank_current", cfg.currentBankDir);
 
@@ -46,11 +46,13 @@ class Config
             int   BankUIAutoClose;
             int   GzipCompression;
             int   Interpolation;
+            int   ResampleQuality;
             std::string bankRootDirList[MAX_BANK_ROOT_DIRS], currentBankDir;
             std::string presetsDirList[MAX_BANK_ROOT_DIRS];
             std::string favoriteList[MAX_BANK_ROOT_DIRS];
             int CheckPADsynth;
             int IgnoreProgramChange;
+            int PartCacheSize;
             int UserInterfaceMode;
             int VirKeybLayout;
             std::string LinuxALSAaudioDev;
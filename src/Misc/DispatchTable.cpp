@@ -0,0 +1,177 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  DispatchTable.cpp - Precompiled OSC address to port mapping
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+#include "DispatchTable.h"
+#include <cctype>
+#include <cstring>
+#include <rtosc/rtosc.h>
+
+namespace zyn {
+
+//Longer addresses are left to Ports::dispatch()
+#define MAX_PATH     256
+#define MAX_INDICES  8
+#define MAX_SEGMENTS 16
+
+static inline uint32_t fnv(uint32_t hash, char c)
+{
+    return (hash ^ (uint8_t)c) * 16777619u;
+}
+
+static uint32_t hashOf(const std::string &s)
+{
+    uint32_t hash = 2166136261u;
+    for(char c:s)
+        hash = fnv(hash, c);
+    return hash;
+}
+
+//Normalised address of a port name, empty for patterns the table can not
+//resolve by a hash
+static std::string normalise(const char *name)
+{
+    std::string res;
+    for(const char *c = name; *c && *c != ':'; ++c) {
+        if(strchr("*?[]{}", *c))
+            return "";
+        if(*c == '#' || isdigit((unsigned char)*c)) {
+            res += '#';
+            while(isdigit((unsigned char)c[1]))
+                ++c;
+        } else
+            res += *c;
+    }
+    return res;
+}
+
+void DispatchTable::insert(const std::string &path, const rtosc::Port *port,
+                           Resolver resolve, int indices, int depth)
+{
+    const uint32_t hash = hashOf(path);
+    for(auto &leaf:leaves)
+        if(leaf.hash == hash && leaf.path == path) {
+            //which one handles the message is up to Ports::dispatch()
+            leaf.port = NULL;
+            return;
+        }
+    leaves.push_back(Leaf{hash, path, port, resolve, indices, depth});
+}
+
+void DispatchTable::addContainer(const char *prefix,
+                                 const rtosc::Ports &ports, Resolver resolve)
+{
+    int indices = 0, depth = 0;
+    for(const char *c = prefix; *c; ++c) {
+        indices += *c == '#';
+        depth   += *c == '/';
+    }
+
+    for(const rtosc::Port &port:ports) {
+        const std::string name = normalise(port.name);
+        //sub trees are added as containers of their own
+        if(name.empty() || name.back() == '/' || !port.cb)
+            continue;
+        insert(prefix + name, &port, resolve, indices, depth);
+    }
+
+    //at most half of the slots are used
+    unsigned size = 16;
+    while(size < 2 * leaves.size())
+        size *= 2;
+    slots.assign(size, -1);
+    for(unsigned i = 0; i < leaves.size(); ++i) {
+        unsigned s = leaves[i].hash & (size - 1);
+        while(slots[s] != -1)
+            s = (s + 1) & (size - 1);
+        slots[s] = i;
+    }
+}
+
+const DispatchTable::Leaf *DispatchTable::find(const char *path,
+                                               uint32_t hash) const
+{
+    const unsigned mask = slots.size() - 1;
+    for(unsigned s = hash & mask; slots[s] != -1; s = (s + 1) & mask) {
+        const Leaf &leaf = leaves[slots[s]];
+        if(leaf.hash == hash && leaf.path == path)
+            return &leaf;
+    }
+    return NULL;
+}
+
+bool DispatchTable::dispatch(const char *msg, rtosc::RtData &d) const
+{
+    if(slots.empty() || *msg != '/')
+        return false;
+
+    //Normalise the address, keeping the indices and the segment starts
+    char        path[MAX_PATH];
+    int         idx[MAX_INDICES];
+    const char *segment[MAX_SEGMENTS];
+    int         len = 0, indices = 0, segments = 0;
+    uint32_t    hash = 2166136261u;
+    const char *c = msg;
+    while(*c) {
+        if(len + 1 >= MAX_PATH)
+            return false;
+        if(isdigit((unsigned char)*c)) {
+            if(indices == MAX_INDICES)
+                return false;
+            int value = 0;
+            for(; isdigit((unsigned char)*c); ++c)
+                if(value < 1000000)
+                    value = value * 10 + (*c - '0');
+            idx[indices++] = value;
+            path[len++]    = '#';
+            hash = fnv(hash, '#');
+            continue;
+        }
+        if(*c == '/') {
+            if(segments == MAX_SEGMENTS)
+                return false;
+            segment[segments++] = c + 1;
+        }
+        path[len++] = *c;
+        hash = fnv(hash, *c);
+        ++c;
+    }
+    path[len] = 0;
+    const size_t addrlen = c - msg;
+
+    const Leaf *leaf = find(path, hash);
+    if(!leaf || !leaf->port || addrlen >= d.loc_size)
+        return false;
+
+    //the port itself checks its range and argument types
+    void       *obj  = leaf->resolve(d.obj, idx);
+    const char *name = segment[leaf->depth - 1];
+    if(!obj || !rtosc_match(leaf->port->name, name, NULL))
+        return false;
+
+    //Same state as the leaf would see at the end of Ports::dispatch()
+    void *root = d.obj;
+    memcpy(d.loc, msg, addrlen + 1);
+    d.obj     = obj;
+    d.port    = leaf->port;
+    d.message = msg;
+    d.matches = 1;
+    for(int i = 0; i < leaf->indices; ++i)
+        d.push_index(idx[i]);
+    leaf->port->cb(name, d);
+    for(int i = 0; i < leaf->indices; ++i)
+        d.pop_index();
+    d.obj = root;
+    memset(d.loc, 0, addrlen);
+    return true;
+}
+
+}
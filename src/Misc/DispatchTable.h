@@ -0,0 +1,75 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  DispatchTable.h - Precompiled OSC address to port mapping
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+#ifndef DISPATCH_TABLE_H
+#define DISPATCH_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <rtosc/ports.h>
+#include "../globals.h"
+
+namespace zyn {
+
+/**Maps OSC addresses straight to the leaf port handling them
+ *
+ * Each run of digits in an address is replaced by '#', so
+ * "/part3/kit0/Pvolume" becomes "/part#/kit#/Pvolume", and the result is
+ * hashed. The table is filled once with the leaf ports of known objects
+ * (containers), each with a function finding the object from the indices
+ * of the address. A hit costs one pass over the address and one match of
+ * the leaf port, instead of a pattern match on every level of the tree.
+ *
+ * Addresses which are unknown, shared by several ports or which name an
+ * object that does not exist are left to rtosc::Ports::dispatch().*/
+class DispatchTable
+{
+    public:
+        /**Object of a container, NULL if it does not exist
+         * @param root object the messages are dispatched to
+         * @param idx  indices of the address, outermost first*/
+        typedef void *(*Resolver)(void *root, const int *idx);
+
+        /**Add the leaf ports of a container
+         * @param prefix normalised address of the container ("/part#/")*/
+        void addContainer(const char *prefix, const rtosc::Ports &ports,
+                          Resolver resolve);
+
+        /**Call the leaf port of msg with d.obj as the root object
+         * @return false if msg has to go through Ports::dispatch()*/
+        bool dispatch(const char *msg, rtosc::RtData &d) const REALTIME;
+
+        /**Number of addresses known*/
+        unsigned size() const {return leaves.size(); }
+
+    private:
+        struct Leaf {
+            uint32_t           hash;
+            std::string        path;    //normalised address
+            const rtosc::Port *port;    //NULL if ports share the address
+            Resolver           resolve;
+            int                indices; //indices used by resolve
+            int                depth;   //'/' in the container address
+        };
+
+        void insert(const std::string &path, const rtosc::Port *port,
+                    Resolver resolve, int indices, int depth);
+        const Leaf *find(const char *path, uint32_t hash) const;
+
+        std::vector<Leaf> leaves;
+        std::vector<int>  slots;    //open addressing over leaves, -1 free
+};
+
+}
+
+#endif
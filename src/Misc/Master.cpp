@@ -20,12 +20,17 @@
 #include "../Misc/Stereo.h"
 #include "../Misc/Util.h"
 #include "../Params/LFOParams.h"
+#include "../Params/ADnoteParameters.h"
+#include "../Params/PADnoteParameters.h"
+#include "../Params/SUBnoteParameters.h"
+#include "../Synth/OscilGen.h"
 #include "../Effects/EffectMgr.h"
 #include "../DSP/FFTwrapper.h"
 #include "../Misc/Allocator.h"
 #include "../Containers/ScratchString.h"
 #include "../Nio/Nio.h"
 #include "PresetExtractor.h"
+#include "DispatchTable.h"
 
 #include <rtosc/ports.h>
 #include <rtosc/port-sugar.h>
@@ -38,6 +43,11 @@
 #include <algorithm>
 #include <cmath>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <unistd.h>
 
 using namespace std;
@@ -370,6 +380,12 @@ static const Ports master_ports = {
                           Part7, Part8, Part9, Part10, Part11, Part12,
                           Part13, Part14, Part15, Part16) rDefault([Off ...]),
                  "Part to insert part onto"),
+    rArrayI(Ppartbus, NUM_MIDI_PARTS, rLinear(0, 21),//OUT_BUS_OWN
+            rDefault([21...]),
+            "Output bus of the part (0 is the main mix, 21 the main mix "
+            "and a bus of its own)"),
+    rArrayI(Psysefxbus, NUM_SYS_EFX, rLinear(0, 20), rDefault([0...]),
+            "Output bus of the system effect (0 is the main mix)"),
     {"Pkeyshift::i", rShort("key shift") rProp(parameter) rLinear(0,127)
         rDefault(64) rDoc("Global Key Shift"), 0, [](const char *m, RtData&d) {
         if(rtosc_narguments(m)==0) {
@@ -401,6 +417,14 @@ static const Ports master_ports = {
     {"reset-vu:", rDoc("Grab VU Data"), 0, [](const char *, RtData &d) {
        Master *m = (Master*)d.obj;
        m->vuresetpeaks();}},
+    {"osc-stats:", rDoc("Messages processed, dropped and deferred cycles "
+                        "of the last cycle followed by the totals"), 0,
+        [](const char *, RtData &d) {
+       Master *m = (Master*)d.obj;
+       d.reply("/osc-stats", "iiiiiii", m->oscCycle.processed,
+               m->oscCycle.dropped, m->oscCycle.deferred, m->oscTotal.cycles,
+               m->oscTotal.processed, m->oscTotal.dropped,
+               m->oscTotal.deferred);}},
     {"load-part:ib", rProp(internal) rDoc("Load Part From Middleware"), 0, [](const char *msg, RtData &d) {
        Master *m =  (Master*)d.obj;
        Part   *p = *(Part**)rtosc_argument(msg, 1).b.data;
@@ -436,6 +460,15 @@ static const Ports master_ports = {
         } else if(rtosc_narguments(m)==1 && rtosc_type(m,0)=='i') {
             ((Master*)d.obj)->setPvolume(limit<char>(rtosc_argument(m,0).i,0,127));
             d.broadcast(d.loc, "i", ((Master*)d.obj)->Pvolume);}}},
+    {"tempo::f", rShort("tempo") rUnit(bpm) rLinear(1, 999)
+        rDoc("Tempo used by synced effects when no host reports one"), 0,
+        [](const char *m, rtosc::RtData &d) {
+        Transport &t = ((Master*)d.obj)->transport;
+        if(rtosc_narguments(m)==0) {
+            d.reply(d.loc, "f", t.bpm());
+        } else {
+            t.setTempo(rtosc_argument(m,0).f);
+            d.broadcast(d.loc, "f", t.bpm());}}},
     {"Psysefxvol#" STRINGIFY(NUM_SYS_EFX) "/::i", 0, &sysefxPort,
         [](const char *msg, rtosc::RtData &d) {
             SNIP;
@@ -521,9 +554,27 @@ static const Ports master_ports = {
         SNIP
             preset_ports.dispatch(msg, data);
         rBOIL_END},
-    {"HDDRecorder/preparefile:s", rDoc("Init WAV file"), 0, [](const char *msg, RtData &d) {
+    {"HDDRecorder/setfiles:b", rProp(internal)
+        rDoc("Record to the WAV file opened for HDDRecorder/preparefile"), 0,
+        [](const char *msg, RtData &d) {
        Master *m = (Master*)d.obj;
-       m->HDDRecorder.preparefile(rtosc_argument(msg, 0).s, 1);}},
+       Recorder::Files *f = *(Recorder::Files**)rtosc_argument(msg, 0).b.data;
+       f = m->HDDRecorder.setfiles(f);
+       d.reply("/free", "sb", "Recorder::Files", sizeof(void*), &f);}},
+    {"HDDRecorder/format::i", rProp(parameter) rOptions(pcm16, pcm24, float32) rDefault(pcm16)
+        rDoc("Sample format of new recordings"), 0, [](const char *msg, RtData &d) {
+       Master *m = (Master*)d.obj;
+       if(rtosc_narguments(msg))
+           m->HDDRecorder.format = limit(rtosc_argument(msg, 0).i, 0, 2);
+       d.reply(d.loc, "i", m->HDDRecorder.format);}},
+    {"HDDRecorder/stems::i", rProp(parameter)
+        rOptions(none, pre-insertion, post-insertion) rDefault(none)
+        rDoc("Also record each part and system effect return to its own file"),
+        0, [](const char *msg, RtData &d) {
+       Master *m = (Master*)d.obj;
+       if(rtosc_narguments(msg))
+           m->HDDRecorder.stems = limit(rtosc_argument(msg, 0).i, 0, 2);
+       d.reply(d.loc, "i", m->HDDRecorder.stems);}},
     {"HDDRecorder/start:", rDoc("Start recording"), 0, [](const char *, RtData &d) {
        Master *m = (Master*)d.obj;
        m->HDDRecorder.start();}},
@@ -555,6 +606,82 @@ static const Ports master_ports = {
 
 const Ports &Master::ports = master_ports;
 
+/*
+ * Objects whose leaf ports are called without walking the port tree
+ *
+ * Each resolver repeats what the recursion ports leading to the object do,
+ * so they have to be kept in sync with the port tables.
+ */
+static Part *partOf(void *m, const int *idx)
+{
+    return idx[0] < NUM_MIDI_PARTS ? ((Master*)m)->part[idx[0]] : NULL;
+}
+
+static Part::Kit *kitOf(void *m, const int *idx)
+{
+    Part *p = partOf(m, idx);
+    return p && idx[1] < NUM_KIT_ITEMS ? &p->kit[idx[1]] : NULL;
+}
+
+static ADnoteParameters *adparsOf(void *m, const int *idx)
+{
+    Part::Kit *k = kitOf(m, idx);
+    return k ? k->adpars : NULL;
+}
+
+static DispatchTable makeDispatchTable()
+{
+    DispatchTable t;
+    t.addContainer("/", master_ports,
+            [](void *m, const int *) -> void * {return m;});
+    t.addContainer("/part#/", Part::ports,
+            [](void *m, const int *idx) -> void * {
+                return partOf(m, idx);});
+    t.addContainer("/part#/kit#/", Part::Kit::ports,
+            [](void *m, const int *idx) -> void * {
+                return kitOf(m, idx);});
+    t.addContainer("/part#/kit#/adpars/", ADnoteParameters::ports,
+            [](void *m, const int *idx) -> void * {
+                return adparsOf(m, idx);});
+    t.addContainer("/part#/kit#/adpars/GlobalPar/", ADnoteGlobalParam::ports,
+            [](void *m, const int *idx) -> void * {
+                ADnoteParameters *ad = adparsOf(m, idx);
+                return ad ? &ad->GlobalPar : NULL;});
+    t.addContainer("/part#/kit#/adpars/VoicePar#/", ADnoteVoiceParam::ports,
+            [](void *m, const int *idx) -> void * {
+                ADnoteParameters *ad = adparsOf(m, idx);
+                return ad && idx[2] < NUM_VOICES ? &ad->VoicePar[idx[2]]
+                                                 : NULL;});
+    t.addContainer("/part#/kit#/subpars/", SUBnoteParameters::ports,
+            [](void *m, const int *idx) -> void * {
+                Part::Kit *k = kitOf(m, idx);
+                return k ? k->subpars : NULL;});
+    t.addContainer("/part#/kit#/padpars/", PADnoteParameters::ports,
+            [](void *m, const int *idx) -> void * {
+                Part::Kit *k = kitOf(m, idx);
+                return k ? k->padpars : NULL;});
+    t.addContainer("/part#/partefx#/", EffectMgr::ports,
+            [](void *m, const int *idx) -> void * {
+                Part *p = partOf(m, idx);
+                return p && idx[1] < NUM_PART_EFX ? p->partefx[idx[1]]
+                                                  : NULL;});
+    t.addContainer("/sysefx#/", EffectMgr::ports,
+            [](void *m, const int *idx) -> void * {
+                return idx[0] < NUM_SYS_EFX ? ((Master*)m)->sysefx[idx[0]]
+                                            : NULL;});
+    t.addContainer("/insefx#/", EffectMgr::ports,
+            [](void *m, const int *idx) -> void * {
+                return idx[0] < NUM_INS_EFX ? ((Master*)m)->insefx[idx[0]]
+                                            : NULL;});
+    return t;
+}
+
+static const DispatchTable &dispatchTable()
+{
+    static const DispatchTable table = makeDispatchTable();
+    return table;
+}
+
 class DataObj:public rtosc::RtData
 {
     public:
@@ -708,7 +835,8 @@ void Master::loadAutomation(XMLwrapper &xml, rtosc::AutomationMgr &midi)
 }
 
 Master::Master(const SYNTH_T &synth_, Config* config)
-    :HDDRecorder(synth_), time(synth_), ctl(synth_, &time),
+    :HDDRecorder(synth_), transport(synth_.samplerate, synth_.buffersize),
+     time(synth_, &transport), ctl(synth_, &time),
     microtonal(config->cfg.GzipCompression), bank(config),
     automate(16,4,8),
     frozenState(false), pendingMemory(false),
@@ -723,17 +851,22 @@ Master::Master(const SYNTH_T &synth_, Config* config)
     //midi.frontend = [this](const char *msg) {bToU->raw_write(msg);};
     automate.backend  = [this](const char *msg) {applyOscEvent(msg);};
 
+    //Build the dispatch table before messages arrive in the realtime thread
+    dispatchTable();
+
     memory = new AllocatorClass();
     swaplr = 0;
     off  = 0;
     smps = 0;
     bufl = new float[synth.buffersize];
     bufr = new float[synth.buffersize];
+    setBuses(NULL, NULL, 0);
 
     last_xmz[0] = 0;
     fft = new FFTwrapper(synth.oscilsize);
 
     shutup = 0;
+    oscCycle = oscTotal = OscStats();
     for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
         vuoutpeakpart[npart] = 1e-9;
         fakepeakpart[npart]  = 0;
@@ -747,11 +880,13 @@ Master::Master(const SYNTH_T &synth_, Config* config)
 
     //Insertion Effects init
     for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
-        insefx[nefx] = new EffectMgr(*memory, synth, 1, &time);
+        insefx[nefx] = new EffectMgr(*memory, synth, 1, &time,
+                                     (ss+"/insefx"+nefx+"/").c_str);
 
     //System Effects init
     for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx)
-        sysefx[nefx] = new EffectMgr(*memory, synth, 0, &time);
+        sysefx[nefx] = new EffectMgr(*memory, synth, 0, &time,
+                                     (ss+"/sysefx"+nefx+"/").c_str);
 
     //Note Visualization
     for(int i=0; i<128; ++i)
@@ -799,7 +934,8 @@ bool Master::applyOscEvent(const char *msg, float *outl, float *outr,
         fprintf(stdout, "%c[%d;%d;%dm", 0x1B, 0, 7 + 30, 0 + 40);
     }
 
-    ports.dispatch(msg, d, true);
+    if(!dispatchTable().dispatch(msg, d))
+        ports.dispatch(msg, d, true);
 
     if(!d.matches) {
         //workaround for requesting voice status
@@ -864,9 +1000,15 @@ void Master::defaults()
         Pinsparts[nefx] = -1;
     }
 
+    //parts play in the main mix and, with a multichannel driver, in a bus
+    //of their own as well
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+        Ppartbus[npart] = OUT_BUS_OWN;
+
     //System Effects init
     for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx) {
         sysefx[nefx]->defaults();
+        Psysefxbus[nefx] = 0;
         for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
             setPsysefxvol(npart, nefx, 0);
 
@@ -881,14 +1023,14 @@ void Master::defaults()
 /*
  * Note On Messages (velocity=0 for NoteOff)
  */
-void Master::noteOn(char chan, char note, char velocity)
+void Master::noteOn(char chan, char note, char velocity, int offset)
 {
     if(velocity) {
         for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
             if(chan == part[npart]->Prcvchn) {
                 fakepeakpart[npart] = velocity * 2;
                 if(part[npart]->Penabled)
-                    part[npart]->NoteOn(note, velocity, keyshift);
+                    part[npart]->NoteOn(note, velocity, keyshift, offset);
             }
         }
         activeNotes[(int)note] = 1;
@@ -1106,6 +1248,23 @@ void dump_msg(const char* ptr, std::ostream& os = std::cerr)
 #endif
 int msg_id=0;
 
+//Share of the buffer period user events may take, the rest is left for the
+//synthesis
+#define OSC_BUDGET 0.25f
+
+//Structural changes prepared by the MiddleWare (parts, effects and synthesis
+//data swapped in), which are not held back by the time budget
+static bool isStructural(const char *msg)
+{
+    const char  *name = strrchr(msg, '/');
+    name = name ? name + 1 : msg;
+    const size_t len  = strlen(name);
+    return !strcmp(name, "load-part") || !strcmp(name, "load-master")
+           || !strcmp(name, "switch-master") || !strcmp(name, "efftype")
+           || !strncmp(name, "sample", 6)
+           || (len > 5 && !strcmp(name + len - 5, "-data"));
+}
+
 bool Master::runOSC(float *outl, float *outr, bool offline)
 {
     //Handle user events
@@ -1113,25 +1272,65 @@ bool Master::runOSC(float *outl, float *outr, bool offline)
     DataObj d{loc_buf, 1024, this, bToU};
     memset(loc_buf, 0, sizeof(loc_buf));
 
-    int events = 0;
-    for(; uToB && uToB->hasNext() && events < 100; ++msg_id, ++events)
+    //Online the events get a share of the buffer period and what does not
+    //fit waits for the next buffer, offline everything is handled
+    typedef std::chrono::steady_clock clock;
+    const clock::time_point deadline = clock::now()
+        + std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<float>(OSC_BUDGET * synth.dt()));
+
+    bool running = true;
+    oscCycle = OscStats();
+    for(; uToB && uToB->hasNext(); ++msg_id)
     {
+        if(!offline && oscCycle.processed && !isStructural(uToB->peak())
+           && clock::now() >= deadline) {
+            oscCycle.deferred = 1;
+            break;
+        }
         const char *msg = uToB->read();
-        if(! applyOscEvent(msg, outl, outr, offline, true, d, msg_id) )
-            return false;
+        d.forwarded = false;
+        running     = applyOscEvent(msg, outl, outr, offline, true, d, msg_id);
+        oscCycle.processed++;
+        if(!running)
+            break;
+        if(!d.matches && !d.forwarded)
+            oscCycle.dropped++;
     }
+    oscCycle.cycles     = 1;
+    oscTotal.cycles    += 1;
+    oscTotal.processed += oscCycle.processed;
+    oscTotal.dropped   += oscCycle.dropped;
+    oscTotal.deferred  += oscCycle.deferred;
+    if(!running)
+        return false;
 
     if(automate.damaged) {
         d.broadcast("/damage", "s", "/automate/");
         automate.damaged = 0;
     }
 
-    if(events>1 && false)
-        fprintf(stderr, "backend: %d events per cycle\n",events);
-
     return true;
 }
 
+void Master::setBuses(float *const *l, float *const *r, int n, int offset)
+{
+    busl[0] = busr[0] = NULL;
+    for(int i = 1; i < NUM_OUT_BUSES; ++i) {
+        const bool on = i < n && l[i] && r[i];
+        busl[i] = on ? l[i] + offset : NULL;
+        busr[i] = on ? r[i] + offset : NULL;
+    }
+}
+
+//Where a source routed to a bus is mixed to
+Stereo<float *> Master::busOut(int bus, float *outl, float *outr) const
+{
+    if(bus > 0 && bus < NUM_OUT_BUSES && busl[bus])
+        return Stereo<float *>(busl[bus], busr[bus]);
+    return Stereo<float *>(outl, outr);
+}
+
 /*
  * Master audio out (the final sound)
  */
@@ -1147,6 +1346,9 @@ bool Master::AudioOut(float *outr, float *outl)
         pendingMemory = true;
     }
 
+    //Apply a host transport report made since the last buffer
+    transport.locate(0);
+
     //work through events
     if(!runOSC(outl, outr, false))
         return false;
@@ -1159,18 +1361,31 @@ bool Master::AudioOut(float *outr, float *outl)
 
 
     //Swaps the Left channel with Right Channel
-    if(swaplr)
+    if(swaplr) {
         swap(outl, outr);
+        swap(busl, busr);
+    }
 
     //clean up the output samples (should not be needed?)
     memset(outl, 0, synth.bufferbytes);
     memset(outr, 0, synth.bufferbytes);
+    for(int i = 1; i < NUM_OUT_BUSES; ++i)
+        if(busl[i]) {
+            memset(busl[i], 0, synth.bufferbytes);
+            memset(busr[i], 0, synth.bufferbytes);
+        }
 
     //Compute part samples and store them part[npart]->partoutl,partoutr
     for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
         if(part[npart]->Penabled)
             part[npart]->ComputePartSmps();
 
+    if(HDDRecorder.stems == Recorder::PreInsertion)
+        for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+            if(part[npart]->Penabled)
+                HDDRecorder.capturePart(npart, part[npart]->partoutl,
+                                        part[npart]->partoutr);
+
     //Insertion effects
     for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
         if(Pinsparts[nefx] >= 0) {
@@ -1218,6 +1433,10 @@ bool Master::AudioOut(float *outr, float *outl)
                 part[npart]->partoutr[i] *= newvol.r;
             }
         }
+
+        if(HDDRecorder.stems == Recorder::PostInsertion)
+            HDDRecorder.capturePart(npart, part[npart]->partoutl,
+                                    part[npart]->partoutr);
     }
 
 
@@ -1262,21 +1481,33 @@ bool Master::AudioOut(float *outr, float *outl)
 
         sysefx[nefx]->out(tmpmixl, tmpmixr);
 
-        //Add the System Effect to sound output
+        //Add the System Effect to its bus
         const float outvol = sysefx[nefx]->sysefxgetvolume();
+        HDDRecorder.captureEfx(nefx, tmpmixl, tmpmixr, outvol);
+        Stereo<float *> out = busOut(Psysefxbus[nefx], outl, outr);
         for(int i = 0; i < synth.buffersize; ++i) {
-            outl[i] += tmpmixl[i] * outvol;
-            outr[i] += tmpmixr[i] * outvol;
+            out.l[i] += tmpmixl[i] * outvol;
+            out.r[i] += tmpmixr[i] * outvol;
         }
     }
 
-    //Mix all parts
+    //Mix all parts to their buses
     for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
-        if(part[npart]->Penabled)   //only mix active parts
-            for(int i = 0; i < synth.buffersize; ++i) { //the volume did not changed
-                outl[i] += part[npart]->partoutl[i];
-                outr[i] += part[npart]->partoutr[i];
+        if(part[npart]->Penabled) {   //only mix active parts
+            const bool own = Ppartbus[npart] == OUT_BUS_OWN;
+            Stereo<float *> out = busOut(own ? 0 : Ppartbus[npart],
+                                         outl, outr);
+            for(int i = 0; i < synth.buffersize; ++i) {
+                out.l[i] += part[npart]->partoutl[i];
+                out.r[i] += part[npart]->partoutr[i];
+            }
+            if(!own || !busl[1 + npart])
+                continue;
+            for(int i = 0; i < synth.buffersize; ++i) {
+                busl[1 + npart][i] += part[npart]->partoutl[i];
+                busr[1 + npart][i] += part[npart]->partoutr[i];
             }
+        }
 
     //Insertion effects for Master Out
     for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
@@ -1304,6 +1535,7 @@ bool Master::AudioOut(float *outr, float *outl)
 
     //update the global frame timer
     time++;
+    ++transport;
 
 #ifdef DEMO_VERSION
     double seconds = time.time()*synth.buffersize_f/synth.samplerate_f;
@@ -1320,6 +1552,9 @@ bool Master::AudioOut(float *outr, float *outl)
     //Update pulse
     last_ack = last_beat;
 
+    if(swaplr)
+        swap(busl, busr);
+
 
     return true;
 }
@@ -1332,6 +1567,7 @@ void Master::GetAudioOutSamples(size_t nsamples,
                                 float *outr)
 {
     off_t out_off = 0;
+    const size_t nsamples_in = nsamples;
 
     //Fail when resampling rather than doing a poor job
     if(synth.samplerate != samplerate) {
@@ -1346,6 +1582,10 @@ void Master::GetAudioOutSamples(size_t nsamples,
             memcpy(outr + out_off, bufr + off, sizeof(float) * smps);
             nsamples -= smps;
 
+            //the next buffer starts out_off + smps samples after the
+            //position the host reported for this call
+            transport.locate(out_off + smps);
+
             //generate samples
             if (! AudioOut(bufl, bufr))
                 return;
@@ -1362,6 +1602,15 @@ void Master::GetAudioOutSamples(size_t nsamples,
             nsamples = 0;
         }
     }
+
+    //no new buffer started, the host position moves on to the next call
+    transport.skip(nsamples_in);
+}
+
+int Master::callbackOffset() const
+{
+    //the next buffer starts after the smps samples that are left over
+    return synth.buffersize - (int)smps;
 }
 
 Master::~Master()
@@ -1448,6 +1697,71 @@ void Master::applyparameters(void)
         part[npart]->applyparameters();
 }
 
+void Master::applyparameters(std::function<bool()> do_abort,
+                             unsigned nthreads,
+                             std::function<void(int)> progress)
+{
+#ifdef WIN32
+    //C++11 threads are broken on mingw cross compilation (see
+    //PADnoteParameters::sampleGenerator())
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
+        part[npart]->applyparameters(do_abort);
+        if(progress)
+            progress(npart + 1);
+    }
+#else
+    const unsigned cores = max(1u, thread::hardware_concurrency());
+    if(!nthreads)
+        nthreads = cores;
+    nthreads = min(nthreads, (unsigned)NUM_MIDI_PARTS);
+
+    //The oscillators share the fft of the master, so they are prepared
+    //before generating the PADsynth samples (which only read them)
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+        for(int n = 0; n < NUM_KIT_ITEMS; ++n) {
+            auto &kit = part[npart]->kit[n];
+            if(kit.Ppadenabled && kit.padpars
+               && kit.padpars->oscilgen->needPrepare())
+                kit.padpars->oscilgen->prepare();
+        }
+
+    //every sample generator gets a share of the cores
+    const unsigned padthreads = max(1u, cores / nthreads);
+    std::atomic<int> next(0), done(0);
+    mutex m;
+    condition_variable cond;
+    auto worker = [&]() {
+        flush_denormals();
+        for(int npart; (npart = next++) < NUM_MIDI_PARTS;) {
+            part[npart]->applyparameters(do_abort, padthreads);
+            lock_guard<mutex> lock(m);
+            done++;
+            cond.notify_all();
+        }
+    };
+
+    vector<thread> pool;
+    for(unsigned i = 0; i < nthreads; ++i)
+        pool.emplace_back(worker);
+
+    unique_lock<mutex> lock(m);
+    int reported = 0;
+    while(reported < NUM_MIDI_PARTS) {
+        cond.wait_for(lock, chrono::milliseconds(50));
+        if(progress) {
+            lock.unlock();
+            progress(done);
+            lock.lock();
+        }
+        reported = done;
+    }
+    lock.unlock();
+
+    for(auto &t:pool)
+        t.join();
+#endif
+}
+
 void Master::initialize_rt(void)
 {
     for(int i=0; i<NUM_SYS_EFX; ++i)
@@ -1473,6 +1787,7 @@ void Master::add2XML(XMLwrapper& xml)
 
     for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
         xml.beginbranch("PART", npart);
+        xml.addpar("output_bus", Ppartbus[npart]);
         part[npart]->add2XML(xml);
         xml.endbranch();
     }
@@ -1480,6 +1795,7 @@ void Master::add2XML(XMLwrapper& xml)
     xml.beginbranch("SYSTEM_EFFECTS");
     for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx) {
         xml.beginbranch("SYSTEM_EFFECT", nefx);
+        xml.addpar("output_bus", Psysefxbus[nefx]);
         xml.beginbranch("EFFECT");
         sysefx[nefx]->add2XML(xml);
         xml.endbranch();
@@ -1586,6 +1902,8 @@ void Master::getfromXML(XMLwrapper& xml)
     for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
         if(xml.enterbranch("PART", npart) == 0)
             continue;
+        Ppartbus[npart] = xml.getpar("output_bus", Ppartbus[npart], 0,
+                                     OUT_BUS_OWN);
         part[npart]->getfromXML(xml);
         xml.exitbranch();
     }
@@ -1602,6 +1920,8 @@ void Master::getfromXML(XMLwrapper& xml)
         for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx) {
             if(xml.enterbranch("SYSTEM_EFFECT", nefx) == 0)
                 continue;
+            Psysefxbus[nefx] = xml.getpar("output_bus", Psysefxbus[nefx], 0,
+                                          NUM_OUT_BUSES - 1);
             if(xml.enterbranch("EFFECT")) {
                 sysefx[nefx]->getfromXML(xml);
                 xml.exitbranch();
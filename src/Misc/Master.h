@@ -18,10 +18,12 @@
 #include "Microtonal.h"
 #include <rtosc/automations.h>
 #include <rtosc/savefile.h>
+#include <functional>
 
 #include "Time.h"
 #include "Bank.h"
 #include "Recorder.h"
+#include "Stereo.h"
 
 #include "../Params/Controller.h"
 #include "../Synth/WatchPoint.h"
@@ -91,6 +93,14 @@ class Master
         /**Regenerate PADsynth and other non-RT parameters
          * It is NOT SAFE to call this from a RT context*/
         void applyparameters(void) NONREALTIME;
+        /**Regenerate the parameters of several parts at once
+         * @param do_abort checked while generating, to give up early
+         * @param nthreads parts processed at once (0 for one per core)
+         * @param progress called from the calling thread with the number
+         *        of finished parts while waiting for the others*/
+        void applyparameters(std::function<bool()> do_abort,
+                             unsigned nthreads,
+                             std::function<void(int)> progress) NONREALTIME;
 
         //This must be called prior-to/at-the-time-of RT insertion
         void initialize_rt(void) REALTIME;
@@ -104,7 +114,8 @@ class Master
         void putalldata(const char *data);
 
         //Midi IN
-        void noteOn(char chan, char note, char velocity);
+        //offset is the sample within the next buffer where the note starts
+        void noteOn(char chan, char note, char velocity, int offset = 0);
         void noteOff(char chan, char note);
         void polyphonicAftertouch(char chan, char note, char velocity);
         void setController(char chan, int type, int par);
@@ -116,17 +127,44 @@ class Master
 
         void vuUpdate(const float *outl, const float *outr);
 
-        //Process a set of OSC events in the bToU buffer
+        /**Process the OSC events in the uToB buffer
+         *
+         * Online the events may take a share of the buffer period, the
+         * rest waits for the next call. Structural changes (parts, effects
+         * and synthesis data swapped in) are handled regardless.
+         * @param offline handle all events*/
         bool runOSC(float *outl, float *outr, bool offline=false);
 
+        /**Counters of runOSC()*/
+        struct OscStats {
+            unsigned cycles;    //calls
+            unsigned processed; //messages handled
+            unsigned dropped;   //messages no port took
+            unsigned deferred;  //calls which left messages for the next
+        };
+        OscStats oscCycle; //the last call
+        OscStats oscTotal; //since the master was created
+
         /**Audio Output*/
         bool AudioOut(float *outl, float *outr) REALTIME;
+        /**Buffers of the output buses for the next AudioOut() calls.
+         * Bus 0, the main mix, always goes to outl/outr and sources routed
+         * to a bus without a buffer are mixed into it.
+         * @param n number of buses given (at most NUM_OUT_BUSES)
+         * @param offset position in the buffers of the next AudioOut()*/
+        void setBuses(float *const *l, float *const *r, int n,
+                      int offset = 0) REALTIME;
         /**Audio Output (for callback mode).
          * This allows the program to be controled by an external program*/
         void GetAudioOutSamples(size_t nsamples,
                                 unsigned samplerate,
                                 float *outl,
                                 float *outr) REALTIME;
+        /**Offset within the next buffer of an event happening at the
+         * current position of GetAudioOutSamples().
+         * Note ons are then heard exactly one buffer later, whatever the
+         * host block size is.*/
+        int callbackOffset() const REALTIME;
 
 
         void partonoff(int npart, int what);
@@ -164,6 +202,11 @@ class Master
         //part that's apply the insertion effect; -1 to disable
         short int Pinsparts[NUM_INS_EFX];
 
+        //output bus of each part and system effect (0 is the main mix,
+        //OUT_BUS_OWN adds a bus of the part's own to it)
+        unsigned char Ppartbus[NUM_MIDI_PARTS];
+        unsigned char Psysefxbus[NUM_SYS_EFX];
+
 
         //peaks for VU-meter
         void vuresetpeaks();
@@ -172,6 +215,7 @@ class Master
         float vuoutpeakpart[NUM_MIDI_PARTS];
         unsigned char fakepeakpart[NUM_MIDI_PARTS]; //this is used to compute the "peak" when the part is disabled
 
+        Transport transport; //musical clock, fed by the audio driver/host
         AbsTime  time;
         Controller ctl;
         bool       swaplr; //if L and R are swapped
@@ -216,6 +260,11 @@ class Master
         float  sysefxsend[NUM_SYS_EFX][NUM_SYS_EFX];
         int    keyshift;
 
+        //driver buffers of the output buses (NULL when not connected)
+        float *busl[NUM_OUT_BUSES];
+        float *busr[NUM_OUT_BUSES];
+        Stereo<float *> busOut(int bus, float *outl, float *outr) const;
+
         //information relevent to generating plugin audio samples
         float *bufl;
         float *bufr;
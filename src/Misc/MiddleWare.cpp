@@ -39,17 +39,24 @@
 #include "PresetExtractor.h"
 #include "../Containers/MultiPseudoStack.h"
 #include "../Params/PresetsStore.h"
+#include "../Effects/EffectMgr.h"
 #include "../Params/ADnoteParameters.h"
 #include "../Params/SUBnoteParameters.h"
 #include "../Params/PADnoteParameters.h"
 #include "../DSP/FFTwrapper.h"
 #include "../Synth/OscilGen.h"
+#include "../Synth/Resonance.h"
 #include "../Nio/Nio.h"
 
 #include <string>
 #include <future>
 #include <atomic>
 #include <list>
+#include <thread>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <condition_variable>
 
 #define errx(...) {}
 #define warnx(...) {}
@@ -166,12 +173,16 @@ void deallocate(const char *str, void *v)
         delete (Master*)v;
     else if(!strcmp(str, "fft_t"))
         delete[] (fft_t*)v;
+    else if(!strcmp(str, "Resonance::curve"))
+        delete[] (float*)v;
     else if(!strcmp(str, "KbmInfo"))
         delete (KbmInfo*)v;
     else if(!strcmp(str, "SclInfo"))
         delete (SclInfo*)v;
     else if(!strcmp(str, "Microtonal"))
         delete (Microtonal*)v;
+    else if(!strcmp(str, "Recorder::Files"))
+        delete (Recorder::Files*)v;
     else
         fprintf(stderr, "Unknown type '%s', leaking pointer %p!!\n", str, v);
 }
@@ -229,11 +240,24 @@ void preparePadSynth(string path, PADnoteParameters *p, rtosc::RtData &d)
  * - PADnoteParameter instances as applyparameters() cannot be done in        *
  *   realtime                                                                 *
  *                                                                            *
- * These instances are collected on every part change and kit change          *
+ * These instances are collected on every part change and kit change and     *
+ * looked up by part, kit and voice index                                     *
  ******************************************************************************/
 struct NonRtObjStore
 {
-    std::map<std::string, void*> objmap;
+    //The objects of each kit item, indexed by part and kit
+    struct KitObjects {
+        OscilGen          *oscil[NUM_VOICES];
+        OscilGen          *fmoscil[NUM_VOICES];
+        Resonance         *reson;
+        PADnoteParameters *pad;
+    };
+    KitObjects objs[NUM_MIDI_PARTS][NUM_KIT_ITEMS];
+
+    NonRtObjStore(void)
+    {
+        clear();
+    }
 
     void extractMaster(Master *master)
     {
@@ -253,87 +277,102 @@ struct NonRtObjStore
 
     void extractAD(ADnoteParameters *adpars, int i, int j)
     {
-        std::string base = "/part"+to_s(i)+"/kit"+to_s(j)+"/";
+        KitObjects &kit = objs[i][j];
         for(int k=0; k<NUM_VOICES; ++k) {
-            std::string nbase = base+"adpars/VoicePar"+to_s(k)+"/";
-            if(adpars) {
-                auto &nobj = adpars->VoicePar[k];
-                objmap[nbase+"OscilSmp/"]     = nobj.OscilSmp;
-                objmap[nbase+"FMSmp/"] = nobj.FMSmp;
-            } else {
-                objmap[nbase+"OscilSmp/"] = nullptr;
-                objmap[nbase+"FMSmp/"]    = nullptr;
-            }
+            kit.oscil[k]   = adpars ? adpars->VoicePar[k].OscilSmp : nullptr;
+            kit.fmoscil[k] = adpars ? adpars->VoicePar[k].FMSmp : nullptr;
         }
+        kit.reson = adpars ? adpars->GlobalPar.Reson : nullptr;
     }
 
     void extractPAD(PADnoteParameters *padpars, int i, int j)
     {
-        std::string base = "/part"+to_s(i)+"/kit"+to_s(j)+"/";
-        for(int k=0; k<NUM_VOICES; ++k) {
-            if(padpars) {
-                objmap[base+"padpars/"]       = padpars;
-                objmap[base+"padpars/oscilgen/"] = padpars->oscilgen;
-            } else {
-                objmap[base+"padpars/"]       = nullptr;
-                objmap[base+"padpars/oscilgen/"] = nullptr;
-            }
-        }
+        objs[i][j].pad = padpars;
     }
 
     void clear(void)
     {
-        objmap.clear();
-    }
-
-    bool has(std::string loc)
-    {
-        return objmap.find(loc) != objmap.end();
+        memset(objs, 0, sizeof(objs));
     }
 
-    void *get(std::string loc)
+    //Valid indices of an object path (within the snoop port patterns)
+    static bool valid(int part, int kit, int voice = 0)
     {
-        return objmap[loc];
+        return part >= 0 && part < NUM_MIDI_PARTS && kit >= 0
+               && kit < NUM_KIT_ITEMS && voice >= 0 && voice < NUM_VOICES;
     }
 
-    void handleOscil(const char *msg, rtosc::RtData &d) {
-        string obj_rl(d.message, msg);
-        void *osc = get(obj_rl);
+    //msg is the remainder of d.message after the path of the object
+    void handleOscil(const char *msg, rtosc::RtData &d, int part, int kit,
+                     int voice, bool fm) {
+        OscilGen *osc = valid(part, kit, voice) ?
+            (fm ? objs[part][kit].fmoscil : objs[part][kit].oscil)[voice]
+            : nullptr;
+        const size_t len = msg - d.message;
         if(osc)
         {
-            strcpy(d.loc, obj_rl.c_str());
+            memcpy(d.loc, d.message, len);
+            d.loc[len] = 0;
             d.obj = osc;
             OscilGen::non_realtime_ports.dispatch(msg, d);
         }
         else
-            fprintf(stderr, "Warning: trying to access oscil object \"%s\","
-                            "which does not exist\n", obj_rl.c_str());
+            fprintf(stderr, "Warning: trying to access oscil object \"%.*s\","
+                            "which does not exist\n", (int)len, d.message);
+    }
+    //The realtime side only reads the response curve, so a new one is sent
+    //after the parameters change
+    void handleReson(const char *msg, rtosc::RtData &d, int part, int kit) {
+        Resonance *res = valid(part, kit) ? objs[part][kit].reson : nullptr;
+        const size_t len = msg - d.message;
+        if(res)
+        {
+            memcpy(d.loc, d.message, len);
+            d.loc[len] = 0;
+            d.obj = res;
+            Resonance::non_realtime_ports.dispatch(msg, d);
+            if(float *curve = res->preparecurve()) {
+                char path[256];
+                snprintf(path, sizeof(path), "%.*scurve-data", (int)len,
+                         d.message);
+                d.chain(path, "b", sizeof(float*), &curve);
+            }
+        }
+        else
+            fprintf(stderr, "Warning: trying to access resonance object "
+                            "\"%.*s\", which does not exist\n",
+                    (int)len, d.message);
     }
-    void handlePad(const char *msg, rtosc::RtData &d) {
-        string obj_rl(d.message, msg);
-        void *pad = get(obj_rl);
+    void handlePad(const char *msg, rtosc::RtData &d, int part, int kit) {
+        PADnoteParameters *pad = valid(part, kit) ? objs[part][kit].pad
+                                                  : nullptr;
+        const size_t len = msg - d.message;
+        char needPrepare[256];
+        snprintf(needPrepare, sizeof(needPrepare), "%.*sneedPrepare",
+                 (int)len, d.message);
         if(!strcmp(msg, "prepare")) {
-            preparePadSynth(obj_rl, (PADnoteParameters*)pad, d);
+            preparePadSynth(string(d.message, msg), pad, d);
             d.matches++;
-            d.reply((obj_rl+"needPrepare").c_str(), "F");
+            d.reply(needPrepare, "F");
         } else {
             if(pad)
             {
-                strcpy(d.loc, obj_rl.c_str());
+                memcpy(d.loc, d.message, len);
+                d.loc[len] = 0;
                 d.obj = pad;
                 PADnoteParameters::non_realtime_ports.dispatch(msg, d);
                 if(rtosc_narguments(msg)) {
                     if(!strcmp(msg, "oscilgen/prepare"))
                         ; //ignore
                     else {
-                        d.reply((obj_rl+"needPrepare").c_str(), "T");
+                        d.reply(needPrepare, "T");
                     }
                 }
             }
             else
                 fprintf(stderr, "Warning: trying to access pad synth object "
-                                "\"%s\", which does not exist\n",
-                        obj_rl.c_str());
+                                "\"%.*s\", which does not exist\n",
+                        (int)len, d.message);
         }
     }
 };
@@ -375,6 +414,400 @@ struct ParamStore
     PADnoteParameters *pad[NUM_MIDI_PARTS][NUM_KIT_ITEMS];
 };
 
+/******************************************************************************
+ *                      Prepared Part Cache                                   *
+ *                                                                            *
+ * Program changes need a Part which has loaded its instrument and applied   *
+ * its parameters (PADsynth tables can take seconds). Parts for the likely    *
+ * next program changes are prepared here in the background:                  *
+ * - the neighbouring slots of the last bank program change (LRU, limited to *
+ *   cfg.PartCacheSize)                                                       *
+ * - the instruments of a set list (kept until the list is cleared)           *
+ *                                                                            *
+ * Entries are keyed by part, file and modification time and are handed out  *
+ * once, after which a set list entry is prepared again. A set list entry     *
+ * whose file changed is prepared again from the new file.                    *
+ * Parts are built one at a time, as they allocate from the RT pool of the    *
+ * master like loadPart() does, which takes precedence over the cache.        *
+ * A prepared Part holds its part effects (e.g. Echo and Reverb delay lines)  *
+ * in that pool, so at most cfg.PartCacheSize + maxSetList Parts are kept and *
+ * the pool grows as the master finds it low.                                 *
+ ******************************************************************************/
+struct PartCache
+{
+    typedef std::function<Part*(Master *, int, const std::string &,
+                                std::function<bool()>)> maker_t;
+
+    enum State {Queued, Building, Ready};
+    static const unsigned maxSetList = 32;
+    struct Entry
+    {
+        Master     *master;
+        int         npart;
+        std::string file;
+        time_t      mtime;
+        bool        pinned;  //part of the set list
+        bool        dropped; //to be discarded once built
+        State       state;
+        Part       *part;
+    };
+
+    PartCache(void)
+        :size(0), abort(false), quit(false)
+    {}
+
+    ~PartCache(void)
+    {
+        stop();
+    }
+
+    void start(maker_t make_)
+    {
+        make   = make_;
+        worker = std::thread([this]{run();});
+    }
+
+    void stop(void)
+    {
+        if(!worker.joinable())
+            return;
+        clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        cond.notify_all();
+        worker.join();
+    }
+
+    static time_t modified(const std::string &file)
+    {
+        struct stat st;
+        if(file.empty() || stat(file.c_str(), &st))
+            return 0;
+        return st.st_mtime;
+    }
+
+    //Prepare an instrument for a part
+    void prefetch(Master *master, int npart, const std::string &file,
+                  bool pinned = false)
+    {
+        const time_t mtime = modified(file);
+        if(!mtime || !worker.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto e = find(npart, file);
+            if(pinned && (e == entries.end() || !e->pinned)
+               && pinnedCount() >= maxSetList) {
+                fprintf(stderr, "Warning: the set list is limited to %u "
+                        "instruments, <%s> is not prepared\n", maxSetList,
+                        file.c_str());
+                return;
+            }
+            if(e != entries.end() && e->mtime == mtime) {
+                e->pinned |= pinned;
+                entries.splice(entries.begin(), entries, e);
+            } else {
+                if(e != entries.end())
+                    drop(e);
+                entries.push_front(Entry{master, npart, file, mtime, pinned,
+                                         false, Queued, NULL});
+            }
+            trim();
+        }
+        cond.notify_all();
+    }
+
+    //Hand out a prepared Part, waiting for one being built
+    //@return NULL if there is none
+    Part *take(int npart, const std::string &file, std::function<void()> idle)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto e = find(npart, file);
+        if(e == entries.end())
+            return NULL;
+        const time_t mtime = modified(file);
+        if(e->mtime != mtime) {
+            //a set list entry is prepared again from the new file
+            Master *master = e->master;
+            const bool pinned = e->pinned;
+            drop(e);
+            if(pinned && mtime) {
+                entries.push_back(Entry{master, npart, file, mtime, true,
+                                        false, Queued, NULL});
+                cond.notify_all();
+            }
+            return NULL;
+        }
+        if(e->state == Queued) {
+            //the caller loads it, a set list entry stays queued for later
+            if(!e->pinned)
+                drop(e);
+            return NULL;
+        }
+        while(e->state == Building) {
+            if(idle) {
+                lock.unlock();
+                idle();
+                lock.lock();
+            }
+            cond.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        if(e->state != Ready)
+            return NULL;
+
+        Part *p = e->part;
+        if(e->pinned)
+            entries.push_back(Entry{e->master, npart, file, e->mtime, true,
+                                    false, Queued, NULL});
+        entries.erase(e);
+        cond.notify_all();
+        return p;
+    }
+
+    //Is a Part prepared for the current version of a file
+    bool ready(int npart, const std::string &file)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto e = find(npart, file);
+        return e != entries.end() && e->state == Ready
+            && e->mtime == modified(file);
+    }
+
+    //Drop all entries made for a previous master, preparing the set list
+    //again for the new one
+    void reset(Master *master)
+    {
+        std::vector<Entry> setlist;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto &e:entries)
+                if(e.pinned && !e.dropped)
+                    setlist.push_back(e);
+        }
+        clear();
+        for(auto &e:setlist)
+            prefetch(master, e.npart, e.file, true);
+    }
+
+    //Drop all entries (and the set list)
+    void clear(void)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for(auto e = entries.begin(); e != entries.end();)
+            drop(e++);
+        //Parts are destroyed with the master they were built for
+        while(!entries.empty())
+            cond.wait(lock);
+    }
+
+    void setSize(unsigned size_)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size = size_;
+        trim();
+    }
+
+    //Called before a Part is built elsewhere
+    //(the Part being built here is aborted and prepared again later)
+    std::unique_lock<std::mutex> exclusive(void)
+    {
+        abort = true;
+        std::unique_lock<std::mutex> lock(building);
+        abort = false;
+        return lock;
+    }
+
+    private:
+    std::list<Entry>::iterator find(int npart, const std::string &file)
+    {
+        for(auto e = entries.begin(); e != entries.end(); ++e)
+            if(e->npart == npart && e->file == file && !e->dropped)
+                return e;
+        return entries.end();
+    }
+
+    unsigned pinnedCount(void) const
+    {
+        unsigned n = 0;
+        for(auto &e:entries)
+            n += e.pinned && !e.dropped;
+        return n;
+    }
+
+    void drop(std::list<Entry>::iterator e)
+    {
+        if(e->state == Building) {
+            e->dropped = true;
+            abort      = true;
+            return;
+        }
+        delete e->part;
+        entries.erase(e);
+    }
+
+    //Keep the newest neighbours
+    void trim(void)
+    {
+        unsigned n = 0;
+        for(auto e = entries.begin(); e != entries.end();) {
+            auto next = std::next(e);
+            if(!e->pinned && !e->dropped && ++n > size)
+                drop(e);
+            e = next;
+        }
+    }
+
+    void run(void)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(!quit) {
+            auto e = entries.begin();
+            while(e != entries.end() && e->state != Queued)
+                ++e;
+            if(e == entries.end()) {
+                cond.wait(lock);
+                continue;
+            }
+
+            e->state = Building;
+            Master *master = e->master;
+            const int npart = e->npart;
+            const std::string file = e->file;
+            lock.unlock();
+
+            Part *p;
+            bool  aborted;
+            {
+                std::lock_guard<std::mutex> build(building);
+                p = make(master, npart, file, [this]{return abort.load();});
+                aborted = abort.exchange(false);
+            }
+
+            lock.lock();
+            if(e->dropped) {
+                delete p;
+                entries.erase(e);
+            } else if(aborted) {
+                delete p;
+                e->state = Queued;
+            } else {
+                e->part  = p;
+                e->state = Ready;
+            }
+            cond.notify_all();
+        }
+    }
+
+    maker_t                 make;
+    std::list<Entry>        entries; //most recently requested first
+    unsigned                size;
+    std::atomic<bool>       abort;
+    bool                    quit;
+    std::mutex              mutex;
+    std::mutex              building;
+    std::condition_variable cond;
+    std::thread             worker;
+};
+
+/******************************************************************************
+ *                      Parameter Change Coalescing                           *
+ *                                                                            *
+ * A knob or an automation sweep sends a value per step, while only the last  *
+ * value of a parameter matters once the realtime side gets to it. When       *
+ * enabled, changes with one scalar argument which are known to pass the      *
+ * MiddleWare untouched are held back, and a later value for the same address *
+ * and type replaces the held one in place. The held changes are written to   *
+ * uToB in the order they were first held:                                    *
+ * - once the window has passed since the first one was held                  *
+ * - before any other message, so that the order relative to it is kept       *
+ * - before the MiddleWare freezes the realtime side to read its state        *
+ ******************************************************************************/
+struct Coalescer
+{
+    Coalescer(void)
+        :window(0), link(NULL), snooping(false)
+    {}
+
+    //Changes which may be held back
+    static bool coalescable(const char *msg)
+    {
+        const char *args = rtosc_argument_string(msg);
+        return args[0] && !args[1] && strchr("ifdhcTF", args[0]);
+    }
+
+    //Hold msg back if it is known to pass the MiddleWare untouched
+    bool hold(const char *msg)
+    {
+        if(!untouched.count(keyOf(msg)))
+            return false;
+        put(msg);
+        return true;
+    }
+
+    //Hold msg back, it passed the MiddleWare untouched
+    void learn(const char *msg)
+    {
+        if(untouched.size() >= 4096)
+            untouched.clear();
+        untouched.insert(keyOf(msg));
+        put(msg);
+    }
+
+    void flush(void)
+    {
+        for(auto &msg:held)
+            link->raw_write(msg.data());
+        held.clear();
+        index.clear();
+    }
+
+    void tick(void)
+    {
+        if(!held.empty() && clock::now() - since >= window)
+            flush();
+    }
+
+    typedef std::chrono::steady_clock clock;
+    clock::duration window; //zero when disabled
+    rtosc::ThreadLink *link;
+    bool snooping;          //in a snooping port of the MiddleWare
+
+    private:
+        static std::string keyOf(const char *msg)
+        {
+            return std::string(msg) + ':' + rtosc_argument_string(msg);
+        }
+
+        void put(const char *msg)
+        {
+            const size_t len = rtosc_message_length(msg, -1);
+            auto itr = index.find(msg);
+            if(itr != index.end()) {
+                std::string &prev = held[itr->second];
+                if(!strcmp(rtosc_argument_string(prev.data()),
+                           rtosc_argument_string(msg))) {
+                    prev.assign(msg, len);
+                    return;
+                }
+                //a value of another type goes after the held one
+                flush();
+            }
+            if(held.empty())
+                since = clock::now();
+            index[msg] = held.size();
+            held.push_back(std::string(msg, len));
+            if(held.size() >= 256 || clock::now() - since >= window)
+                flush();
+        }
+
+        std::vector<std::string>                held;      //messages
+        std::unordered_map<std::string, size_t> index;     //address -> held
+        std::unordered_set<std::string>         untouched; //address:types
+        clock::time_point                       since;     //first held
+};
+
 //XXX perhaps move this to Nio
 //(there needs to be some standard Nio stub file for this sort of stuff)
 namespace Nio
@@ -403,6 +836,16 @@ namespace Nio
                     d.reply(d.loc, "s", Nio::getSink().c_str());
                 else
                     Nio::setSink(rtosc_argument(msg,0).s);}},
+        {"midi-overflows:", 0, 0, [](const char *, rtosc::RtData &d) {
+                d.reply(d.loc, "i", Nio::midiOverflows());}},
+        {"midi-late:", 0, 0, [](const char *, rtosc::RtData &d) {
+                d.reply(d.loc, "i", Nio::midiLate());}},
+        {"null-stats:", 0, 0, [](const char *, rtosc::RtData &d) {
+                int64_t periods;
+                int     xruns;
+                float   lateMean, lateMax;
+                Nio::nullStats(periods, xruns, lateMean, lateMax);
+                d.reply(d.loc, "hiff", periods, xruns, lateMean, lateMax);}},
     };
 }
 
@@ -466,6 +909,32 @@ public:
             bank.loadbank(bank.banks[par].dir);
     }
 
+    //Build a Part with a loaded instrument and applied parameters
+    Part *makePart(Master *master, int npart, const char *filename,
+                   std::function<bool()> do_abort)
+    {
+        Part *p = new Part(*master->memory, synth,
+                           master->time,
+                           config->cfg.GzipCompression,
+                           config->cfg.Interpolation,
+                           &master->microtonal, master->fft, &master->watcher,
+                           ("/part"+to_s(npart)+"/").c_str());
+        if(p->loadXMLinstrument(filename))
+            fprintf(stderr, "Warning: failed to load part<%s>!\n", filename);
+
+        p->applyparameters(do_abort);
+        return p;
+    }
+
+    //Prepare the instruments next to a bank slot for a program change
+    void preloadNeighbours(int npart, int slot)
+    {
+        Bank &bank = master->bank;
+        for(int s : {slot + 1, slot - 1})
+            if(s >= 0 && s < BANK_SIZE && !bank.ins[s].filename.empty())
+                partCache.prefetch(master, npart, bank.ins[s].filename);
+    }
+
     void loadPart(int npart, const char *filename, Master *master)
     {
         actual_load[npart]++;
@@ -474,25 +943,25 @@ public:
             return;
         assert(actual_load[npart] <= pending_load[npart]);
 
+        //a prepared Part only needs to be handed to the backend
+        Part *p = partCache.take(npart, filename, [this]{
+                if(idle)
+                    idle(idle_ptr);});
+        if(p) {
+            transmitPart(npart, p);
+            return;
+        }
+
         //load part in async fashion when possible
 #ifndef WIN32
         auto alloc = std::async(std::launch::async,
                 [master,filename,this,npart](){
-                Part *p = new Part(*master->memory, synth,
-                                   master->time,
-                                   config->cfg.GzipCompression,
-                                   config->cfg.Interpolation,
-                                   &master->microtonal, master->fft, &master->watcher,
-                                   ("/part"+to_s(npart)+"/").c_str());
-                if(p->loadXMLinstrument(filename))
-                    fprintf(stderr, "Warning: failed to load part<%s>!\n", filename);
-
                 auto isLateLoad = [this,npart]{
                 return actual_load[npart] != pending_load[npart];
                 };
 
-                p->applyparameters(isLateLoad);
-                return p;});
+                auto lock = partCache.exclusive();
+                return makePart(master, npart, filename, isLateLoad);});
 
         //Load the part
         if(idle) {
@@ -501,9 +970,10 @@ public:
             }
         }
 
-        Part *p = alloc.get();
+        p = alloc.get();
 #else
-        Part *p = new Part(*master->memory, synth, master->time,
+        auto lock = partCache.exclusive();
+        p = new Part(*master->memory, synth, master->time,
                 config->cfg.GzipCompression,
                 config->cfg.Interpolation,
                 &master->microtonal, master->fft);
@@ -518,6 +988,11 @@ public:
         p->applyparameters(isLateLoad);
 #endif
 
+        transmitPart(npart, p);
+    }
+
+    void transmitPart(int npart, Part *p)
+    {
         obj_store.extractPart(p, npart);
         kits.extractPart(p, npart);
 
@@ -552,6 +1027,12 @@ public:
     //structures at once...
     int loadMaster(const char *filename, bool osc_format = false)
     {
+        //a newer load (e.g. requested while waiting) cancels this one
+        const int id = ++master_load;
+        auto isLateLoad = [this,id]{
+            return master_load != id;
+        };
+
         Master *m = new Master(synth, config);
         m->uToB = uToB;
         m->bToU = bToU;
@@ -572,7 +1053,19 @@ public:
                     return -1;
                 }
             }
-            m->applyparameters();
+
+            //the parts are prepared in parallel
+            m->applyparameters(isLateLoad, 0, [this](int done) {
+                    char buf[64];
+                    rtosc_message(buf, sizeof(buf), "/load-progress", "ii",
+                                  done, NUM_MIDI_PARTS);
+                    broadcastToRemote(buf);
+                    if(idle)
+                        idle(idle_ptr);});
+            if(isLateLoad()) {
+                delete m;
+                return -1;
+            }
         }
 
         //Update resource locator table
@@ -661,6 +1154,7 @@ public:
 
     void updateResources(Master *m)
     {
+        partCache.reset(m);
         obj_store.clear();
         obj_store.extractMaster(m);
         for(int i=0; i<NUM_MIDI_PARTS; ++i)
@@ -692,13 +1186,19 @@ public:
             multi_thread_source.free(m);
         }
 
+        coalescer.tick();
+
         autoSave.tick();
 
+        master->bank.updatesearchdb();
+
         heartBeat(master);
 
         //XXX This might have problems with a master swap operation
-        if(offline)
+        if(offline) {
+            coalescer.flush();
             master->runOSC(0,0,true);
+        }
 
     }
 
@@ -759,6 +1259,12 @@ public:
     std::atomic_int pending_load[NUM_MIDI_PARTS];
     std::atomic_int actual_load[NUM_MIDI_PARTS];
 
+    //Parts prepared for program changes
+    PartCache partCache;
+
+    //Number of the latest loadMaster()
+    std::atomic_int master_load;
+
     //Undo/Redo
     rtosc::UndoHistory undo;
 
@@ -783,6 +1289,9 @@ public:
     PresetsStore presetsstore;
 
     CallbackRepeater autoSave;
+
+    //Parameter changes held back on their way to uToB
+    Coalescer coalescer;
 };
 
 /*****************************************************************************
@@ -1224,6 +1733,7 @@ void save_cb(const char *msg, RtData &d)
  * BASE/part#/kititem#
  * BASE/part#/kit#/adpars/voice#/oscil/\*
  * BASE/part#/kit#/adpars/voice#/mod-oscil/\*
+ * BASE/part#/kit#/adpars/GlobalPar/Reson/\*
  * BASE/part#/kit#/padpars/prepare
  * BASE/part#/kit#/padpars/oscil/\*
  */
@@ -1232,18 +1742,32 @@ static rtosc::Ports middwareSnoopPorts = {
         "/kit#" STRINGIFY(NUM_KIT_ITEMS) "/adpars/VoicePar#"
             STRINGIFY(NUM_VOICES) "/OscilSmp/", 0, &OscilGen::non_realtime_ports,
         rBegin;
-        impl.obj_store.handleOscil(chomp(chomp(chomp(chomp(chomp(msg))))), d);
+        impl.obj_store.handleOscil(chomp(chomp(chomp(chomp(chomp(msg))))), d,
+                                   extractInt(msg), extractInt(chomp(msg)),
+                                   extractInt(chomp(chomp(chomp(msg)))),
+                                   false);
         rEnd},
     {"part#" STRINGIFY(NUM_MIDI_PARTS)
         "/kit#" STRINGIFY(NUM_KIT_ITEMS)
             "/adpars/VoicePar#" STRINGIFY(NUM_VOICES) "/FMSmp/", 0, &OscilGen::non_realtime_ports,
         rBegin
-        impl.obj_store.handleOscil(chomp(chomp(chomp(chomp(chomp(msg))))), d);
+        impl.obj_store.handleOscil(chomp(chomp(chomp(chomp(chomp(msg))))), d,
+                                   extractInt(msg), extractInt(chomp(msg)),
+                                   extractInt(chomp(chomp(chomp(msg)))),
+                                   true);
+        rEnd},
+    {"part#" STRINGIFY(NUM_MIDI_PARTS)
+        "/kit#" STRINGIFY(NUM_KIT_ITEMS) "/adpars/GlobalPar/Reson/", 0,
+            &Resonance::non_realtime_ports,
+        rBegin
+        impl.obj_store.handleReson(chomp(chomp(chomp(chomp(chomp(msg))))), d,
+                                   extractInt(msg), extractInt(chomp(msg)));
         rEnd},
     {"part#" STRINGIFY(NUM_MIDI_PARTS)
         "/kit#" STRINGIFY(NUM_KIT_ITEMS) "/padpars/", 0, &PADnoteParameters::non_realtime_ports,
         rBegin
-        impl.obj_store.handlePad(chomp(chomp(chomp(msg))), d);
+        impl.obj_store.handlePad(chomp(chomp(chomp(msg))), d,
+                                 extractInt(msg), extractInt(chomp(msg)));
         rEnd},
     {"bank/", 0, &bankPorts,
         rBegin;
@@ -1451,8 +1975,42 @@ static rtosc::Ports middwareSnoopPorts = {
             impl.pending_load[0]++;
             impl.loadPart(0, impl.master->bank.ins[slot].filename.c_str(), impl.master);
             impl.uToB->write("/part0/Pname", "s", impl.master->bank.ins[slot].name.c_str());
+            impl.preloadNeighbours(0, slot);
         }
         rEnd},
+    {"preload-part:is", 0, 0,
+        rBegin;
+        //add an instrument to the set list of a part
+        impl.partCache.prefetch(impl.master, rtosc_argument(msg,0).i,
+                                rtosc_argument(msg,1).s, true);
+        rEnd},
+    {"HDDRecorder/preparefile:s", 0, 0,
+        rBegin;
+        //opening the files and allocating their ring is left out of the
+        //realtime thread, which only swaps them in
+        Master *m = impl.master;
+        //stems are written for the parts and effects in use
+        bool parts[NUM_MIDI_PARTS], sysefx[NUM_SYS_EFX];
+        for(int i = 0; i < NUM_MIDI_PARTS; ++i)
+            parts[i] = m->part[i]->Penabled;
+        for(int i = 0; i < NUM_SYS_EFX; ++i)
+            sysefx[i] = m->sysefx[i]->geteffect() != 0;
+        Recorder::Files *f = m->HDDRecorder.openfiles(
+                rtosc_argument(msg, 0).s, 1, parts, sysefx);
+        impl.uToB->write("/HDDRecorder/setfiles", "b", sizeof(f), &f);
+        rEnd},
+    {"preload-ready:is", 0, 0,
+        rBegin;
+        //is the instrument prepared for the part
+        const int   npart = rtosc_argument(msg,0).i;
+        const char *file  = rtosc_argument(msg,1).s;
+        const bool  ready = impl.partCache.ready(npart, file);
+        d.reply("/preload-ready", ready ? "isT" : "isF", npart, file);
+        rEnd},
+    {"preload-clear:", 0, 0,
+        rBegin;
+        impl.partCache.clear();
+        rEnd},
     {"part#16/clear:", 0, 0,
         rBegin;
         int id = extractInt(msg);
@@ -1547,6 +2105,7 @@ static rtosc::Ports middlewareReplyPorts = {
         const int program = rtosc_argument(msg, 1).i + 128*bank.bank_lsb;
         impl.loadPart(part, impl.master->bank.ins[program].filename.c_str(), impl.master);
         impl.uToB->write(("/part"+to_s(part)+"/Pname").c_str(), "s", impl.master->bank.ins[program].name.c_str());
+        impl.preloadNeighbours(part, program);
         rEnd},
     {"setbank:c", 0, 0,
         rBegin;
@@ -1583,6 +2142,7 @@ MiddleWareImpl::MiddleWareImpl(MiddleWare *mw, SYNTH_T synth_,
 {
     bToU = new rtosc::ThreadLink(4096*2*16,1024/16);
     uToB = new rtosc::ThreadLink(4096*2*16,1024/16);
+    coalescer.link = uToB;
     //midi_mapper.base_ports = &Master::ports;
     //midi_mapper.rt_cb      = [this](const char *msg){handleMsg(msg);};
     if(preferrred_port != -1)
@@ -1611,7 +2171,13 @@ MiddleWareImpl::MiddleWareImpl(MiddleWare *mw, SYNTH_T synth_,
     //Grab objects of interest from master
     updateResources(master);
 
+    partCache.setSize(config->cfg.PartCacheSize);
+    partCache.start([this](Master *m, int npart, const std::string &file,
+                           std::function<bool()> do_abort) {
+            return makePart(m, npart, file.c_str(), do_abort);});
+
     //Null out Load IDs
+    master_load = 0;
     for(int i=0; i < NUM_MIDI_PARTS; ++i) {
         pending_load[i] = 0;
         actual_load[i] = 0;
@@ -1639,6 +2205,8 @@ MiddleWareImpl::MiddleWareImpl(MiddleWare *mw, SYNTH_T synth_,
 
 MiddleWareImpl::~MiddleWareImpl(void)
 {
+    //prepared Parts belong to the master
+    partCache.stop();
 
     if(server)
         lo_server_free(server);
@@ -1676,6 +2244,7 @@ MiddleWareImpl::~MiddleWareImpl(void)
 void MiddleWareImpl::doReadOnlyOp(std::function<void()> read_only_fn)
 {
     assert(uToB);
+    coalescer.flush();
     uToB->write("/freeze_state","");
 
     std::list<const char *> fico;
@@ -1789,6 +2358,7 @@ void MiddleWareImpl::doReadOnlyOpPlugin(std::function<void()> read_only_fn)
 bool MiddleWareImpl::doReadOnlyOpNormal(std::function<void()> read_only_fn, bool canfail)
 {
     assert(uToB);
+    coalescer.flush();
     uToB->write("/freeze_state","");
 
     std::list<const char *> fico;
@@ -2009,11 +2579,24 @@ void MiddleWareImpl::handleMsg(const char *msg)
         return;
     }
 
+    //Changes known to pass untouched are held back, anything else goes
+    //after what is held (as do messages sent while snooping)
+    const bool coalesce = coalescer.window.count() && !coalescer.snooping
+                          && Coalescer::coalescable(msg);
+    if(coalesce && coalescer.hold(msg))
+        return;
+    coalescer.flush();
+
     MwDataObj d(this);
+    const bool snooping = coalescer.snooping;
+    coalescer.snooping  = true;
     middwareSnoopPorts.dispatch(msg, d, true);
+    coalescer.snooping  = snooping;
 
     //A message unmodified by snooping
-    if(d.matches == 0 || d.forwarded) {
+    if(coalesce && d.matches == 0)
+        coalescer.learn(msg);
+    else if(d.matches == 0 || d.forwarded) {
         //if(strcmp("/get-vu", msg)) {
         //    printf("Message Continuing on<%s:%s>...\n", msg, rtosc_argument_string(msg));
         //}
@@ -2076,6 +2659,12 @@ void MiddleWare::enableAutoSave(int interval_sec)
     impl->autoSave.dt = interval_sec;
 }
 
+void MiddleWare::enableCoalescing(int window_ms)
+{
+    impl->coalescer.flush();
+    impl->coalescer.window = std::chrono::milliseconds(window_ms > 0 ? window_ms : 0);
+}
+
 int MiddleWare::checkAutoSave(void)
 {
     //save spec zynaddsubfx-PID-autosave.xmz
@@ -36,6 +36,10 @@ class MiddleWare
         //Enable AutoSave Functionality
         void enableAutoSave(int interval_sec=60);
 
+        //Hold back parameter changes for up to window_ms, passing only the
+        //last value of each to the realtime side (0 disables)
+        void enableCoalescing(int window_ms=5);
+
         //Check for old automatic saves which should only exist if multiple
         //instances are in use OR when there was a crash
         //
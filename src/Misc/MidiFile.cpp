@@ -0,0 +1,220 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MidiFile.cpp - Standard MIDI File reader
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include "MidiFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdint.h>
+
+namespace zyn {
+
+using std::vector;
+
+//A channel message or tempo change at an absolute tick
+struct SmfEvent {
+    uint64_t      tick;
+    bool          isTempo;
+    uint32_t      tempo;   //us per quarter note
+    unsigned char msg[3];
+};
+
+//Big endian reads bounded by the end of the buffer
+class SmfReader
+{
+    public:
+        SmfReader(const unsigned char *data, size_t len)
+            :pos(data), end(data + len), failed(false) {}
+
+        bool eof() const {return pos >= end; }
+        bool bad() const {return failed; }
+        size_t left() const {return end - pos; }
+
+        unsigned byte() {
+            if(pos >= end) {
+                failed = true;
+                return 0;
+            }
+            return *pos++;
+        }
+
+        uint32_t fixed(int bytes) {
+            uint32_t v = 0;
+            while(bytes--)
+                v = (v << 8) | byte();
+            return v;
+        }
+
+        uint32_t varlen() {
+            uint32_t v = 0;
+            for(int i = 0; i < 4; ++i) {
+                const unsigned b = byte();
+                v = (v << 7) | (b & 0x7f);
+                if(!(b & 0x80))
+                    return v;
+            }
+            failed = true;
+            return v;
+        }
+
+        void skip(size_t n) {
+            if(n > left()) {
+                failed = true;
+                n = left();
+            }
+            pos += n;
+        }
+
+        const unsigned char *here() const {return pos; }
+
+    private:
+        const unsigned char *pos, *end;
+        bool failed;
+};
+
+//Bytes following a status byte
+static int datalen(unsigned status)
+{
+    switch(status & 0xf0) {
+        case 0xc0:
+        case 0xd0:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+static bool readTrack(SmfReader r, vector<SmfEvent> &out)
+{
+    uint64_t tick    = 0;
+    unsigned running = 0;
+    while(!r.eof() && !r.bad()) {
+        tick += r.varlen();
+        unsigned status = r.byte();
+        //meta events and system exclusive messages cancel running status
+        if(status == 0xff) { //meta event
+            running = 0;
+            const unsigned type = r.byte();
+            const uint32_t len  = r.varlen();
+            if(type == 0x51 && len == 3) {
+                SmfEvent ev = {tick, true, r.fixed(3), {0, 0, 0}};
+                //a tempo of 0 is invalid and ignored
+                if(ev.tempo)
+                    out.push_back(ev);
+            }
+            else if(type == 0x2f) //end of track
+                break;
+            else
+                r.skip(len);
+            continue;
+        }
+        if(status == 0xf0 || status == 0xf7) { //system exclusive
+            running = 0;
+            r.skip(r.varlen());
+            continue;
+        }
+
+        SmfEvent ev = {tick, false, 0, {0, 0, 0}};
+        if(status & 0x80) {
+            running   = status;
+            ev.msg[1] = r.byte();
+        } else {           //running status
+            if(!running)
+                return false;
+            ev.msg[1] = status;
+            status    = running;
+        }
+        ev.msg[0] = status;
+        if(datalen(status) == 2)
+            ev.msg[2] = r.byte();
+        out.push_back(ev);
+    }
+    return !r.bad();
+}
+
+int MidiFile::load(const std::string &filename)
+{
+    evs.clear();
+
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if(!file)
+        return -1;
+    const vector<unsigned char> data((std::istreambuf_iterator<char>(file)),
+                                     std::istreambuf_iterator<char>());
+
+    SmfReader r(data.data(), data.size());
+    if(r.left() < 14 || memcmp(r.here(), "MThd", 4))
+        return -1;
+    r.skip(4);
+    const uint32_t hlen     = r.fixed(4);
+    const unsigned format   = r.fixed(2);
+    const unsigned ntracks  = r.fixed(2);
+    const unsigned division = r.fixed(2);
+    r.skip(hlen - 6);
+    if(r.bad() || format > 1 || !division)
+        return -1;
+
+    vector<SmfEvent> ticks;
+    for(unsigned t = 0; t < ntracks && !r.eof();) {
+        if(r.left() < 8)
+            return -1;
+        const bool     track = !memcmp(r.here(), "MTrk", 4);
+        r.skip(4);
+        const uint32_t len   = r.fixed(4);
+        if(len > r.left())
+            return -1;
+        //unknown chunks are skipped
+        if(track) {
+            if(!readTrack(SmfReader(r.here(), len), ticks))
+                return -1;
+            ++t;
+        }
+        r.skip(len);
+    }
+
+    //tracks are merged, keeping the file order of simultaneous events
+    std::stable_sort(ticks.begin(), ticks.end(),
+                     [](const SmfEvent &a, const SmfEvent &b) {
+                         return a.tick < b.tick;
+                     });
+
+    //SMPTE divisions have a fixed tick length, otherwise the ticks are
+    //fractions of a quarter note and follow the tempo map
+    const bool smpte = division & 0x8000;
+    double tickLen   = smpte ?
+        1.0 / ((-(signed char)(division >> 8)) * (division & 0xff)) :
+        0.5 / division; //120 bpm until the first tempo change
+    double   time = 0.0;
+    uint64_t last = 0;
+    for(const SmfEvent &ev : ticks) {
+        time += (ev.tick - last) * tickLen;
+        last  = ev.tick;
+        if(ev.isTempo) {
+            if(!smpte)
+                tickLen = ev.tempo * 1e-6 / division;
+            continue;
+        }
+        Event e;
+        e.time = time;
+        memcpy(e.msg, ev.msg, 3);
+        evs.push_back(e);
+    }
+
+    return 0;
+}
+
+double MidiFile::length() const
+{
+    return evs.empty() ? 0.0 : evs.back().time;
+}
+
+}
@@ -0,0 +1,46 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MidiFile.h - Standard MIDI File reader
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#ifndef MIDIFILE_H
+#define MIDIFILE_H
+#include <string>
+#include <vector>
+
+namespace zyn {
+
+/**Reads the channel messages of a Standard MIDI File (format 0 or 1)
+ *
+ * The tempo map is applied while loading, so events are timed in
+ * seconds. Meta events and system exclusive messages are skipped.*/
+class MidiFile
+{
+    public:
+        struct Event {
+            double        time;    //seconds from the start of the file
+            unsigned char msg[3];  //status byte and data bytes
+        };
+
+        /**@returns 0 on success, -1 on a missing or malformed file*/
+        int load(const std::string &filename);
+
+        /**Events of all tracks sorted by time*/
+        const std::vector<Event> &events() const {return evs; }
+
+        /**Time of the last event in seconds*/
+        double length() const;
+
+    private:
+        std::vector<Event> evs;
+};
+
+}
+
+#endif
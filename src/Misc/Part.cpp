@@ -243,6 +243,8 @@ Part::Part(Allocator &alloc, const SYNTH_T &synth_, const AbsTime &time_,
     else
         memset(prefix, 0, sizeof(prefix));
 
+    prng_state = prng_seed(prefix);
+
     monomemClear();
 
     for(int n = 0; n < NUM_KIT_ITEMS; ++n) {
@@ -256,8 +258,10 @@ Part::Part(Allocator &alloc, const SYNTH_T &synth_, const AbsTime &time_,
     kit[0].adpars  = new ADnoteParameters(synth, fft, &time);
 
     //Part's Insertion Effects init
+    ScratchString pre = prefix;
     for(int nefx = 0; nefx < NUM_PART_EFX; ++nefx) {
-        partefx[nefx]    = new EffectMgr(memory, synth, 1, &time);
+        partefx[nefx]    = new EffectMgr(memory, synth, 1, &time,
+                                         (pre+"partefx"+nefx+"/").c_str);
         Pefxbypass[nefx] = false;
     }
     assert(partefx[0]);
@@ -376,26 +380,23 @@ void Part::defaultsinstrument()
 /*
  * Cleanup the part
  */
-void Part::cleanup(bool final_)
+void Part::cleanup(void)
 {
     notePool.killAllNotes();
-    for(int i = 0; i < synth.buffersize; ++i) {
-        partoutl[i] = final_ ? 0.0f : synth.denormalkillbuf[i];
-        partoutr[i] = final_ ? 0.0f : synth.denormalkillbuf[i];
-    }
+    memset(partoutl, 0, synth.bufferbytes);
+    memset(partoutr, 0, synth.bufferbytes);
     ctl.resetall();
     for(int nefx = 0; nefx < NUM_PART_EFX; ++nefx)
         partefx[nefx]->cleanup();
-    for(int n = 0; n < NUM_PART_EFX + 1; ++n)
-        for(int i = 0; i < synth.buffersize; ++i) {
-            partfxinputl[n][i] = final_ ? 0.0f : synth.denormalkillbuf[i];
-            partfxinputr[n][i] = final_ ? 0.0f : synth.denormalkillbuf[i];
-        }
+    for(int n = 0; n < NUM_PART_EFX + 1; ++n) {
+        memset(partfxinputl[n], 0, synth.bufferbytes);
+        memset(partfxinputr[n], 0, synth.bufferbytes);
+    }
 }
 
 Part::~Part()
 {
-    cleanup(true);
+    cleanup();
     for(int n = 0; n < NUM_KIT_ITEMS; ++n) {
         delete kit[n].adpars;
         delete kit[n].subpars;
@@ -452,7 +453,8 @@ static int kit_usage(const Part::Kit *kits, int note, int mode)
  */
 bool Part::NoteOn(unsigned char note,
                   unsigned char velocity,
-                  int masterkeyshift)
+                  int masterkeyshift,
+                  int offset)
 {
     //Verify Basic Mode and sanity
     const bool isRunningNote   = notePool.existsRunningNote();
@@ -507,7 +509,8 @@ bool Part::NoteOn(unsigned char note,
 
     //Adjust Existing Notes
     if(doingLegato) {
-        LegatoParams pars = {notebasefreq, vel, portamento, note, true, prng()};
+        LegatoParams pars = {notebasefreq, vel, portamento, note, true,
+                             prng(prng_state)};
         notePool.applyLegato(pars);
         return true;
     }
@@ -523,7 +526,7 @@ bool Part::NoteOn(unsigned char note,
             continue;
 
         SynthParams pars{memory, ctl, synth, time, notebasefreq, vel,
-            portamento, note, false, prng()};
+            portamento, note, false, prng(prng_state), offset};
         const int sendto = Pkitmode ? item.sendto() : 0;
 
         try {
@@ -803,14 +806,22 @@ void Part::ComputePartSmps()
             float tmpoutr[synth.buffersize];
             float tmpoutl[synth.buffersize];
             auto &note = *s.note;
-            note.noteout(&tmpoutl[0], &tmpoutr[0]);
+            //a note with a start offset is kept for one more buffer after
+            //finishing, to play the end of its last buffer
+            const bool tail = note.finished();
+            if(tail) {
+                memset(tmpoutl, 0, synth.bufferbytes);
+                memset(tmpoutr, 0, synth.bufferbytes);
+            } else
+                note.noteout(&tmpoutl[0], &tmpoutr[0]);
+            note.applyoffset(&tmpoutl[0], &tmpoutr[0]);
 
             for(int i = 0; i < synth.buffersize; ++i) { //add the note to part(mix)
                 partfxinputl[d.sendto][i] += tmpoutl[i];
                 partfxinputr[d.sendto][i] += tmpoutr[i];
             }
 
-            if(note.finished())
+            if(tail || (note.finished() && !note.getoffset()))
                 notePool.kill(s);
         }
     }
@@ -1033,11 +1044,12 @@ void Part::applyparameters(void)
     applyparameters([]{return false;});
 }
 
-void Part::applyparameters(std::function<bool()> do_abort)
+void Part::applyparameters(std::function<bool()> do_abort,
+                           unsigned max_threads)
 {
     for(int n = 0; n < NUM_KIT_ITEMS; ++n)
         if(kit[n].Ppadenabled && kit[n].padpars)
-            kit[n].padpars->applyparameters(do_abort);
+            kit[n].padpars->applyparameters(do_abort, max_threads);
 }
 
 void Part::initialize_rt(void)
@@ -17,6 +17,7 @@
 #define MAX_INFO_TEXT_SIZE 1000
 
 #include "../globals.h"
+#include "Util.h"
 #include "../Params/Controller.h"
 #include "../Containers/NotePool.h"
 
@@ -43,9 +44,11 @@ class Part
         // Midi commands implemented
 
         //returns true when note is successfully applied
+        //offset is the sample within the next buffer where the note starts
         bool NoteOn(unsigned char note,
                     unsigned char velocity,
-                    int masterkeyshift) REALTIME;
+                    int masterkeyshift,
+                    int offset = 0) REALTIME;
         void NoteOff(unsigned char note) REALTIME;
         void PolyphonicAftertouch(unsigned char note,
                                   unsigned char velocity,
@@ -71,7 +74,8 @@ class Part
         void defaultsinstrument();
 
         void applyparameters(void) NONREALTIME;
-        void applyparameters(std::function<bool()> do_abort) NONREALTIME;
+        void applyparameters(std::function<bool()> do_abort,
+                             unsigned max_threads = 0) NONREALTIME;
 
         void initialize_rt(void) REALTIME;
         void kill_rt(void) REALTIME;
@@ -79,7 +83,7 @@ class Part
         void getfromXML(XMLwrapper& xml);
         void getfromXMLinstrument(XMLwrapper& xml);
 
-        void cleanup(bool final = false);
+        void cleanup(void);
 
         //the part's kit
         struct Kit {
@@ -198,6 +202,7 @@ class Part
         FFTwrapper *fft;
         WatchManager *wm;
         char prefix[64];
+        prng_t prng_state; //seeds of the notes
         Allocator  &memory;
         const SYNTH_T &synth;
         const AbsTime &time;
@@ -12,6 +12,9 @@
 */
 
 #include <sys/stat.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
 #include "Recorder.h"
 #include "WavFile.h"
 #include "../globals.h"
@@ -20,8 +23,12 @@
 namespace zyn {
 
 Recorder::Recorder(const SYNTH_T &synth_)
-    :status(0), notetrigger(0),synth(synth_)
-{}
+    :status(0), format(WavFile::PCM16), stems(NoStems), notetrigger(0),
+     synth(synth_)
+{
+    memset(partTrack, 0, sizeof(partTrack));
+    memset(efxTrack, 0, sizeof(efxTrack));
+}
 
 Recorder::~Recorder()
 {
@@ -29,21 +36,80 @@ Recorder::~Recorder()
         stop();
 }
 
-int Recorder::preparefile(std::string filename_, int overwrite)
+//name.wav -> name-part01.wav
+static std::string stemname(std::string filename, const char *kind, int n)
+{
+    const size_t ext = filename.rfind(".wav");
+    if(ext != std::string::npos && ext + 4 == filename.size())
+        filename.erase(ext);
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "-%s%0*d.wav", kind,
+             strcmp(kind, "part") ? 1 : 2, n);
+    return filename + suffix;
+}
+
+Recorder::Files::~Files()
+{
+    Nio::waveClose(tracks);
+}
+
+int Recorder::preparefile(std::string filename_, int overwrite,
+                          const bool *parts, const bool *sysefx)
+{
+    Files *f = openfiles(filename_, overwrite, parts, sysefx);
+    if(!f)
+        return 1;
+    delete setfiles(f);
+    return 0;
+}
+
+Recorder::Files *Recorder::openfiles(std::string filename_, int overwrite,
+                                     const bool *parts,
+                                     const bool *sysefx) const
 {
     if(!overwrite) {
         struct stat fileinfo;
         int statr;
         statr = stat(filename_.c_str(), &fileinfo);
         if(statr == 0)   //file exists
-            return 1;
+            return NULL;
     }
 
-    Nio::waveNew(new WavFile(filename_, synth.samplerate, 2));
+    Files *f = new Files;
+    const WavFile::Format fmt = (WavFile::Format)format;
+    std::vector<WavFile *> files;
+    files.push_back(new WavFile(filename_, synth.samplerate, 2, fmt));
+
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
+        f->partTrack[npart] = 0;
+        if(stems != NoStems && parts && parts[npart]) {
+            f->partTrack[npart] = files.size();
+            files.push_back(new WavFile(stemname(filename_, "part", npart + 1),
+                                        synth.samplerate, 2, fmt));
+        }
+    }
+    for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx) {
+        f->efxTrack[nefx] = 0;
+        if(stems != NoStems && sysefx && sysefx[nefx]) {
+            f->efxTrack[nefx] = files.size();
+            files.push_back(new WavFile(stemname(filename_, "sysefx", nefx + 1),
+                                        synth.samplerate, 2, fmt));
+        }
+    }
+
+    f->tracks = Nio::waveOpen(files);
+    return f;
+}
+
+Recorder::Files *Recorder::setfiles(Files *files)
+{
+    memcpy(partTrack, files->partTrack, sizeof(partTrack));
+    memcpy(efxTrack, files->efxTrack, sizeof(efxTrack));
+    files->tracks = Nio::waveSwap(files->tracks);
 
     status = 1; //ready
 
-    return 0;
+    return files;
 }
 
 void Recorder::start()
@@ -82,5 +148,18 @@ void Recorder::triggernow()
     }
 }
 
+void Recorder::capturePart(int npart, const float *l, const float *r)
+{
+    if(partTrack[npart])
+        Nio::waveCapture(partTrack[npart], l, r, 1.0f);
+}
+
+void Recorder::captureEfx(int nefx, const float *l, const float *r,
+                          float gain)
+{
+    if(efxTrack[nefx])
+        Nio::waveCapture(efxTrack[nefx], l, r, gain);
+}
+
 //TODO move recorder inside nio system
 }
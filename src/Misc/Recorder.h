@@ -14,34 +14,81 @@
 #ifndef RECORDER_H
 #define RECORDER_H
 #include <string>
+#include "../globals.h"
 
 namespace zyn {
 
 struct SYNTH_T;
+struct WavTracks;
 /**Records sound to a file*/
 class Recorder
 {
     public:
 
+        /**What is recorded next to the master mix*/
+        enum Stems {
+            NoStems,       //the master mix only
+            PreInsertion,  //parts before their insertion effects
+            PostInsertion  //parts as they are mixed into the master bus
+        };
+
+        /**The files of a recording and the tracks of the parts and
+         * system effects in them (0 when not recorded)*/
+        struct Files {
+            Files() :tracks(NULL) {}
+            ~Files();
+            WavTracks *tracks;
+            int partTrack[NUM_MIDI_PARTS];
+            int efxTrack[NUM_SYS_EFX];
+        };
+
         Recorder(const SYNTH_T &synth);
         ~Recorder();
         /**Prepare the given file.
+         * With stems, the parts and system effects flagged in parts/sysefx
+         * are written next to it as <name>-partNN.wav and
+         * <name>-sysefxN.wav
          * @returns 1 if the file exists */
-        int preparefile(std::string filename_, int overwrite);
+        int preparefile(std::string filename_, int overwrite,
+                        const bool *parts = NULL, const bool *sysefx = NULL);
+        /**Open the files of preparefile() without using them yet
+         * (not realtime safe)
+         * @returns NULL if the file exists */
+        Files *openfiles(std::string filename_, int overwrite,
+                         const bool *parts = NULL,
+                         const bool *sysefx = NULL) const;
+        /**Record to files from openfiles()
+         * @returns the same object holding the previous files, which is
+         *          to be deleted outside of the realtime thread*/
+        Files *setfiles(Files *files);
         void start();
         void stop();
         void pause();
         int recording();
         void triggernow();
 
+        /**Record one buffer of a part or of a system effect return*/
+        void capturePart(int npart, const float *l, const float *r);
+        void captureEfx(int nefx, const float *l, const float *r,
+                        float gain);
+
         /** Status:
          *  0 - not ready(no file selected),
          *  1 - ready
          *  2 - recording */
         int status;
 
+        /**Sample format of new files (a WavFile::Format)*/
+        int format;
+
+        /**Stems recorded with new files*/
+        int stems;
+
     private:
         int notetrigger;
+        //Track of each part and system effect (0 when not recorded)
+        int partTrack[NUM_MIDI_PARTS];
+        int efxTrack[NUM_SYS_EFX];
         const SYNTH_T &synth;
 };
 
@@ -15,21 +15,119 @@
 
 namespace zyn {
 
+//Musical clock (tempo and position in beats)
+//
+//The audio driver or plugin wrapper reports the host transport with
+//setHost() before rendering. The position is then advanced one buffer at a
+//time, so without a host the clock free-runs at the last known tempo.
+class Transport
+{
+    public:
+        Transport(float samplerate_, int buffersize_)
+            :tempo(120.0f), position(0.0), rolling(false), synced(false),
+            pending(false), hostTempo(120.0f), hostPosition(0.0),
+            hostRolling(false), samplerate(samplerate_),
+            buffersize(buffersize_){};
+
+        //Report the host state for the next output sample
+        void setHost(float bpm, double beat, bool playing)
+        {
+            hostTempo    = clampTempo(bpm);
+            hostPosition = beat;
+            hostRolling  = playing;
+            pending      = true;
+        }
+        //Set the tempo without a host (standalone use)
+        void setTempo(float bpm) {tempo = clampTempo(bpm);}
+
+        //Apply a pending host report to the buffer that is about to be
+        //rendered, which starts `offset` samples after the reported position
+        void locate(int offset)
+        {
+            if(!pending)
+                return;
+            tempo    = hostTempo;
+            position = hostPosition + offset * beatsPerSample();
+            rolling  = hostRolling;
+            synced   = true;
+            pending  = false;
+        }
+        //`samples` were played without starting a new buffer, so a pending
+        //host report now refers to a position that far in the past
+        void skip(int samples)
+        {
+            if(pending)
+                hostPosition += samples * hostTempo / (60.0 * samplerate);
+        }
+        //Advance by one buffer
+        void operator++() {position += buffersize * beatsPerSample();};
+
+        float  bpm() const {return tempo;}
+        //Position of the first sample of the current buffer
+        double beat() const {return position;}
+        //Position of a given sample of the current buffer
+        double beatAt(int sample) const {return position + sample * beatsPerSample();}
+        double beatsPerSample() const {return tempo / (60.0 * samplerate);}
+        float  secondsPerBeat() const {return 60.0f / tempo;}
+        bool   playing() const {return rolling;}
+        bool   hostSync() const {return synced;}
+
+        //Length in beats of a tempo division parameter
+        //(0 is reserved for free running and returns 0)
+        static float division(unsigned char Psync)
+        {
+            static const float beats[] = {
+                0.0f,
+                0.25f, 1.0f/3.0f, 0.5f, 2.0f/3.0f, 0.75f, //1/16 .. 1/8.
+                1.0f, 4.0f/3.0f, 1.5f, 2.0f, 3.0f,         //1/4  .. 1/2.
+                4.0f, 8.0f, 16.0f                          //1, 2, 4 bars
+            };
+            const unsigned n = sizeof(beats) / sizeof(beats[0]);
+            return beats[Psync < n ? Psync : n - 1];
+        }
+    private:
+        //Keep the tempo within the range of /tempo (1..999 bpm)
+        static float clampTempo(float bpm)
+        {
+            if(!(bpm >= 1.0f))
+                return 1.0f;
+            return bpm < 999.0f ? bpm : 999.0f;
+        }
+
+        float  tempo;
+        double position;
+        bool   rolling;
+        bool   synced;
+
+        //last report from the host, applied by locate()
+        bool   pending;
+        float  hostTempo;
+        double hostPosition;
+        bool   hostRolling;
+
+        float samplerate;
+        int   buffersize;
+};
+
 class AbsTime
 {
     public:
-        AbsTime(const SYNTH_T &synth)
+        AbsTime(const SYNTH_T &synth, const Transport *transport_ = nullptr)
             :frames(0),
-            s(synth){};
+            s(synth),
+            t(transport_){};
         void operator++(){++frames;};
         void operator++(int){frames++;};
         int64_t time() const {return frames;};
         float dt() const { return s.dt(); }
         float framesPerSec() const { return 1/s.dt();}
         int   samplesPerFrame() const {return s.buffersize;}
+        //Musical clock of the owning Master (may be NULL)
+        const Transport *transport() const {return t;}
     private:
         int64_t frames;
         const SYNTH_T &s;
+        const Transport *t;
 };
 
 //Marker for an event relative to some position of the absolute timer
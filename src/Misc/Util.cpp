@@ -14,6 +14,7 @@
 #include "globals.h"
 #include "Util.h"
 #include <vector>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
@@ -28,6 +29,9 @@
 #ifdef HAVE_SCHEDULER
 #include <sched.h>
 #endif
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#endif
 
 #define errx(...) {}
 #ifndef errx
@@ -40,7 +44,29 @@ namespace zyn {
 
 bool isPlugin = false;
 
-prng_t prng_state = 0x1234;
+static std::atomic<prng_t> thread_seed(0x1234);
+
+static prng_t prng_thread_seed(void)
+{
+    static std::atomic<prng_t> threads(0);
+    return thread_seed + 0x9e3779b9 * threads++;
+}
+
+thread_local prng_t prng_state = prng_thread_seed();
+
+void sprng(prng_t p)
+{
+    thread_seed = p;
+    prng_state  = p;
+}
+
+prng_t prng_seed(const char *location)
+{
+    prng_t p = 0x1234;
+    for(const char *c = location; c && *c; ++c)
+        p = p * 31 + *c;
+    return p;
+}
 
 /*
  * Transform the velocity according the scaling parameter (velocity sensing)
@@ -135,6 +161,64 @@ void set_realtime()
 #endif
 }
 
+//Floating point control register of the current thread and the bits that
+//make it flush denormals
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+static const unsigned long denormal_bits = 0x8040; //FTZ | DAZ
+static unsigned long get_fpmode()
+{
+    return _mm_getcsr();
+}
+static void set_fpmode(unsigned long mode)
+{
+    _mm_setcsr(mode);
+}
+#elif defined(__aarch64__)
+static const unsigned long denormal_bits = 1ul << 24; //FZ
+static unsigned long get_fpmode()
+{
+    unsigned long mode;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(mode));
+    return mode;
+}
+static void set_fpmode(unsigned long mode)
+{
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(mode));
+}
+#elif defined(__arm__) && defined(__ARM_FP)
+static const unsigned long denormal_bits = 1ul << 24; //FZ
+static unsigned long get_fpmode()
+{
+    unsigned long mode;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r"(mode));
+    return mode;
+}
+static void set_fpmode(unsigned long mode)
+{
+    __asm__ __volatile__("vmsr fpscr, %0" : : "r"(mode));
+}
+#else
+static const unsigned long denormal_bits = 0;
+static unsigned long get_fpmode() {return 0;}
+static void set_fpmode(unsigned long) {}
+#endif
+
+void flush_denormals()
+{
+    set_fpmode(get_fpmode() | denormal_bits);
+}
+
+DenormalGuard::DenormalGuard()
+    :saved(get_fpmode())
+{
+    set_fpmode(saved | denormal_bits);
+}
+
+DenormalGuard::~DenormalGuard()
+{
+    set_fpmode(saved);
+}
+
 
 
 #ifdef WIN32
@@ -214,9 +298,29 @@ void invSignal(float *sig, size_t len)
         sig[i] *= -1.0f;
 }
 
-float SYNTH_T::numRandom()
+void prng_fill(prng_t &p, float *smps, int n)
 {
-    return RND;
+    if(n <= 0)
+        return;
+    //x[i + 4] = a^4 x[i] + c (a^3 + a^2 + a + 1) for x[i + 1] = a x[i] + c
+    const prng_t a  = 1103515245, c = 12345;
+    const prng_t a4 = a * a * a * a;
+    const prng_t c4 = c * (a * a * a + a * a + a + 1);
+    prng_t lane[4];
+    lane[0] = prng_r(p);
+    for(int j = 1; j < 4; ++j)
+        lane[j] = lane[j - 1] * a + c;
+
+    int i = 0;
+    for(; i + 4 < n; i += 4)
+        for(int j = 0; j < 4; ++j) {
+            smps[i + j] = (lane[j] & 0x7fffffff) / (INT32_MAX * 1.0f);
+            lane[j]     = lane[j] * a4 + c4;
+        }
+    int j = 0;
+    for(; i < n; ++i, ++j)
+        smps[i] = (lane[j] & 0x7fffffff) / (INT32_MAX * 1.0f);
+    p = lane[j - 1];
 }
 
 float interpolate(const float *data, size_t len, float pos)
@@ -58,6 +58,25 @@ extern float getdetune(unsigned char type,
  * pthread_attr_t*/
 void set_realtime();
 
+/**Flush denormal floats to zero in the current thread
+ *
+ * Decaying feedback loops (reverb combs, filters, envelopes tails) would
+ * otherwise end up computing with denormals, which is many times slower on
+ * most CPUs. Every thread that renders audio calls this (FTZ/DAZ with SSE,
+ * FZ on ARM, no-op elsewhere).*/
+void flush_denormals();
+
+/**Flushes denormals for the lifetime of the object and restores the
+ * previous mode afterwards, for threads that belong to a plugin host*/
+class DenormalGuard
+{
+    public:
+        DenormalGuard();
+        ~DenormalGuard();
+    private:
+        unsigned long saved;
+};
+
 /**Os independent sleep in microsecond*/
 void os_usleep(long length);
 
@@ -120,7 +139,19 @@ T array_max(const T *data, size_t len)
 //Random number generator
 
 typedef uint32_t prng_t;
-extern prng_t prng_state;
+//State of prng()/RND. Each thread has its own, which only seeds the
+//randomizing of parameters by the user; anything that renders audio owns its
+//generator state instead, so that output does not depend on what other
+//instances (or other Masters) did before.
+//A thread's state starts from the last seed given to sprng() on any thread,
+//mixed with the number of threads seeded before, so that threads started
+//after the program seeded the generator (such as the audio thread) neither
+//repeat each other nor the same sequence on every run.
+extern thread_local prng_t prng_state;
+
+#ifndef INT32_MAX
+#define INT32_MAX      (2147483647)
+#endif
 
 // Portable Pseudo-Random Number Generator
 inline prng_t prng_r(prng_t &p)
@@ -133,17 +164,33 @@ inline prng_t prng(void)
     return prng_r(prng_state) & 0x7fffffff;
 }
 
-inline void sprng(prng_t p)
+//Seed the state of the calling thread and of the threads started later
+void sprng(prng_t p);
+
+//Same as prng(), but with the state owned by the caller
+inline prng_t prng(prng_t &p)
 {
-    prng_state = p;
+    return prng_r(p) & 0x7fffffff;
 }
 
+//The random generator (0.0f..1.0f) with the state owned by the caller
+inline float prng_float(prng_t &p)
+{
+    return prng(p) / (INT32_MAX * 1.0f);
+}
+
+//Seed for the generator of the object at location (such as "/part0/"), so
+//that equal objects do not sound the same, while an object always sounds the
+//same after being loaded
+prng_t prng_seed(const char *location);
+
+//Fill smps with the next n values of prng_float(p)
+//(four interleaved generators are stepped at once, so the loop vectorizes)
+void prng_fill(prng_t &p, float *smps, int n);
+
 /*
  * The random generator (0.0f..1.0f)
  */
-#ifndef INT32_MAX
-#define INT32_MAX      (2147483647)
-#endif
 #define RND (prng() / (INT32_MAX * 1.0f))
 
 //Linear Interpolation
@@ -15,23 +15,67 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <cmath>
 #include <iostream>
 #include "WavFile.h"
 using namespace std;
 
 namespace zyn {
 
-WavFile::WavFile(string filename, int samplerate, int channels)
+//The space reserved for the RF64 'ds64' chunk (written as 'JUNK' while the
+//file stays below 4GB)
+#define DS64_SIZE 28
+
+//Size and alignment of the stdio buffer, so that the disk sees few large
+//page aligned writes even with many tracks open
+#define IOBUF_SIZE  (1 << 20)
+#define IOBUF_ALIGN 4096
+
+typedef std::vector<unsigned char> bytes;
+
+static void put(bytes &b, const char *id)
+{
+    b.insert(b.end(), id, id + 4);
+}
+
+static void put16(bytes &b, uint16_t v)
+{
+    b.push_back((unsigned char)v);
+    b.push_back((unsigned char)(v >> 8));
+}
+
+static void put32(bytes &b, uint32_t v)
+{
+    put16(b, v & 0xffff);
+    put16(b, v >> 16);
+}
+
+static void put64(bytes &b, uint64_t v)
+{
+    put32(b, v & 0xffffffff);
+    put32(b, v >> 32);
+}
+
+static float clip(float x)
+{
+    return x > 1.0f ? 1.0f : (x < -1.0f ? -1.0f : x);
+}
+
+WavFile::WavFile(string filename, int samplerate, int channels, Format format)
     :sampleswritten(0), samplerate(samplerate), channels(channels),
-      file(fopen(filename.c_str(), "w"))
+      format(format), file(fopen(filename.c_str(), "wb"))
 
 {
     if(file) {
+        iobuf.resize(IOBUF_SIZE + IOBUF_ALIGN);
+        char *buf = iobuf.data();
+        buf += (IOBUF_ALIGN - (uintptr_t)buf % IOBUF_ALIGN) % IOBUF_ALIGN;
+        setvbuf(file, buf, _IOFBF, IOBUF_SIZE);
+
         cout << "INFO: Making space for wave file header" << endl;
-        //making space for the header written at destruction
-        char tmp[44];
-        memset(tmp, 0, 44 * sizeof(char));
-        fwrite(tmp, 1, 44, file);
+        //a valid (empty) header, rewritten with the final sizes at
+        //destruction
+        writeHeader();
     }
 }
 
@@ -40,56 +84,153 @@ WavFile::~WavFile()
     if(file) {
         cout << "INFO: Writing wave file header" << endl;
 
-        unsigned int chunksize;
-        rewind(file);
+        //chunks are word aligned
+        if((sampleswritten * blockAlign()) & 1)
+            fputc(0, file);
 
-        fwrite("RIFF", 4, 1, file);
-        chunksize = sampleswritten * 4 + 36;
-        fwrite(&chunksize, 4, 1, file);
-
-        fwrite("WAVEfmt ", 8, 1, file);
-        chunksize = 16;
-        fwrite(&chunksize, 4, 1, file);
-        unsigned short int formattag = 1;     //uncompresed wave
-        fwrite(&formattag, 2, 1, file);
-        unsigned short int nchannels = channels;     //stereo
-        fwrite(&nchannels, 2, 1, file);
-        unsigned int samplerate_ = samplerate;         //samplerate
-        fwrite(&samplerate_, 4, 1, file);
-        unsigned int bytespersec = samplerate * 2 * channels;         //bytes/sec
-        fwrite(&bytespersec, 4, 1, file);
-        unsigned short int blockalign = 2 * channels;    //2 channels * 16 bits/8
-        fwrite(&blockalign, 2, 1, file);
-        unsigned short int bitspersample = 16;
-        fwrite(&bitspersample, 2, 1, file);
-
-        fwrite("data", 4, 1, file);
-        chunksize = sampleswritten * blockalign;
-        fwrite(&chunksize, 4, 1, file);
+        rewind(file);
+        writeHeader();
 
         fclose(file);
         file = NULL;
     }
 }
 
+int WavFile::blockAlign() const
+{
+    switch(format) {
+        case PCM24:
+            return 3 * channels;
+        case Float32:
+            return 4 * channels;
+        default:
+            return 2 * channels;
+    }
+}
+
+int WavFile::headerSize() const
+{
+    //RIFF + ds64/JUNK + fmt [+ fact] + data
+    return 12 + 8 + DS64_SIZE + (format == Float32 ? 8 + 18 + 12 : 8 + 16) + 8;
+}
+
+/*
+ * Files whose RIFF size does not fit into 32 bits are written as RF64
+ * (EBU Tech 3306): the 32 bit sizes are set to -1 and the real ones are
+ * stored in the ds64 chunk, which otherwise is a JUNK placeholder.
+ */
+vector<unsigned char> WavFile::header(uint64_t frames) const
+{
+    const uint64_t datasize = frames * blockAlign();
+    const uint64_t riffsize = headerSize() - 8 + datasize + (datasize & 1);
+    const bool     rf64     = riffsize > 0xffffffffull;
+    bytes b;
+
+    put(b, rf64 ? "RF64" : "RIFF");
+    put32(b, rf64 ? 0xffffffff : riffsize);
+    put(b, "WAVE");
+
+    put(b, rf64 ? "ds64" : "JUNK");
+    put32(b, DS64_SIZE);
+    put64(b, rf64 ? riffsize : 0);
+    put64(b, rf64 ? datasize : 0);
+    put64(b, rf64 ? frames : 0);
+    put32(b, 0); //no table entries
+
+    const uint16_t blockalign = blockAlign();
+    put(b, "fmt ");
+    put32(b, format == Float32 ? 18 : 16);
+    put16(b, format == Float32 ? 3 : 1); //IEEE float or PCM
+    put16(b, channels);
+    put32(b, samplerate);
+    put32(b, samplerate * blockalign); //bytes/sec
+    put16(b, blockalign);
+    put16(b, 8 * blockalign / channels); //bits/sample
+    if(format == Float32) {
+        put16(b, 0); //no extension
+
+        put(b, "fact");
+        put32(b, 4);
+        put32(b, rf64 ? 0xffffffff : frames);
+    }
+
+    put(b, "data");
+    put32(b, rf64 ? 0xffffffff : datasize);
+    return b;
+}
+
+void WavFile::writeHeader()
+{
+    const bytes b = header(sampleswritten);
+    fwrite(b.data(), 1, b.size(), file);
+}
+
 bool WavFile::good() const
 {
-    return file;
+    return file && !ferror(file);
+}
+
+void WavFile::writeSamples(int nsmps, const float *smps)
+{
+    if(!file)
+        return;
+
+    const int n = nsmps * channels;
+    if(format == Float32)
+        fwrite(smps, sizeof(float), n, file);
+    else {
+        const int width = format == PCM24 ? 3 : 2;
+        encoded.resize(n * width);
+        unsigned char *out = encoded.data();
+        for(int i = 0; i < n; ++i) {
+            const int32_t v = format == PCM24 ?
+                lrintf(clip(smps[i]) * 8388607.0f) :
+                lrintf(clip(smps[i]) * 32767.0f);
+            for(int b = 0; b < width; ++b)
+                *out++ = (unsigned char)(v >> (8 * b));
+        }
+        fwrite(encoded.data(), 1, encoded.size(), file);
+    }
+    sampleswritten += nsmps;
+}
+
+void WavFile::writeStereoSamples(int nsmps, const float *smps)
+{
+    writeSamples(nsmps, smps);
+}
+
+void WavFile::writeMonoSamples(int nsmps, const float *smps)
+{
+    writeSamples(nsmps, smps);
 }
 
 void WavFile::writeStereoSamples(int nsmps, short int *smps)
 {
-    if(file) {
+    if(!file)
+        return;
+    if(format == PCM16) {
         fwrite(smps, nsmps, 4, file);
         sampleswritten += nsmps;
+    } else {
+        vector<float> tmp(2 * nsmps);
+        for(int i = 0; i < 2 * nsmps; ++i)
+            tmp[i] = smps[i] / 32768.0f;
+        writeSamples(nsmps, tmp.data());
     }
 }
 
 void WavFile::writeMonoSamples(int nsmps, short int *smps)
 {
-    if(file) {
+    if(!file)
+        return;
+    if(format == PCM16) {
         fwrite(smps, nsmps, 2, file);
         sampleswritten += nsmps;
+    } else {
+        vector<float> tmp(nsmps);
+        for(int i = 0; i < nsmps; ++i)
+            tmp[i] = smps[i] / 32768.0f;
+        writeSamples(nsmps, tmp.data());
     }
 }
 
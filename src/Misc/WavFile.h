@@ -15,13 +15,24 @@
 #ifndef WAVFILE_H
 #define WAVFILE_H
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
 
 namespace zyn {
 
 class WavFile
 {
     public:
-        WavFile(std::string filename, int samplerate, int channels);
+        /**Sample encodings of the data chunk*/
+        enum Format {
+            PCM16   = 0,
+            PCM24   = 1,
+            Float32 = 2
+        };
+
+        WavFile(std::string filename, int samplerate, int channels,
+                Format format = PCM16);
         ~WavFile();
 
         bool good() const;
@@ -29,11 +40,28 @@ class WavFile
         void writeMonoSamples(int nsmps, short int *smps);
         void writeStereoSamples(int nsmps, short int *smps);
 
+        /**Write interleaved float frames in the file's format
+         * (samples are clipped to [-1,1] for the PCM formats)*/
+        void writeMonoSamples(int nsmps, const float *smps);
+        void writeStereoSamples(int nsmps, const float *smps);
+
+        /**Header of the file once it holds the given number of frames
+         * (RF64 when the sizes do not fit into 32 bits)*/
+        std::vector<unsigned char> header(uint64_t frames) const;
+
     private:
-        int   sampleswritten;
-        int   samplerate;
-        int   channels;
-        FILE *file;
+        void writeSamples(int nsmps, const float *smps);
+        void writeHeader();
+        int  headerSize() const;
+        int  blockAlign() const;
+
+        uint64_t sampleswritten;
+        int      samplerate;
+        int      channels;
+        Format   format;
+        FILE    *file;
+        std::vector<unsigned char> encoded;
+        std::vector<char> iobuf;
 };
 
 }
@@ -20,7 +20,8 @@
 #include <cstdarg>
 #include <zlib.h>
 #include <iostream>
-#include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "globals.h"
 #include "Util.h"
@@ -130,6 +131,7 @@ XMLwrapper::XMLwrapper()
 void
 XMLwrapper::cleanup(void)
 {
+    invalidate();
     if(tree)
         mxmlDelete(tree);
 
@@ -187,6 +189,195 @@ bool XMLwrapper::hasPadSynth() const
 
 /* SAVE XML members */
 
+/* Binary format, see saveBinaryFile() */
+
+#define BINARY_MAGIC   "ZYNB"
+#define BINARY_VERSION 1
+#define BINARY_HEADER  5   //words
+#define BINARY_NONE    0xFFFFFFFFu
+
+enum BinaryNodeType {
+    BINARY_ELEMENT = 0,
+    BINARY_TEXT    = 1
+};
+
+enum BinaryNodeField {
+    NODE_TYPE, NODE_STRING, NODE_PARENT, NODE_CHILD, NODE_NEXT,
+    NODE_ATTR, NODE_NATTRS, NODE_FIELDS
+};
+
+struct BinaryWriter {
+    vector<uint32_t> nodes;
+    vector<uint32_t> attrs;
+    string           strings;
+    unordered_map<string, uint32_t> offsets;
+
+    uint32_t str(const char *s)
+    {
+        if(s == NULL)
+            return BINARY_NONE;
+        auto itr = offsets.find(s);
+        if(itr != offsets.end())
+            return itr->second;
+        const uint32_t offset = strings.size();
+        strings.append(s, strlen(s) + 1);
+        offsets[s] = offset;
+        return offset;
+    }
+
+    //Append a node and its subtree in document order, returning its index
+    uint32_t add(const mxml_node_t *n, uint32_t parent)
+    {
+        const uint32_t id = nodes.size() / NODE_FIELDS;
+        nodes.resize(nodes.size() + NODE_FIELDS, BINARY_NONE);
+        uint32_t *rec = &nodes[id * NODE_FIELDS];
+        rec[NODE_PARENT] = parent;
+        rec[NODE_NATTRS] = 0;
+        if(n->type == MXML_ELEMENT) {
+            rec[NODE_TYPE]   = BINARY_ELEMENT;
+            rec[NODE_STRING] = str(n->value.element.name);
+            rec[NODE_ATTR]   = attrs.size() / 2;
+            rec[NODE_NATTRS] = n->value.element.num_attrs;
+            for(int i = 0; i < n->value.element.num_attrs; ++i) {
+                const mxml_attr_t &attr = n->value.element.attrs[i];
+                attrs.push_back(str(attr.name));
+                attrs.push_back(str(attr.value));
+            }
+        }
+        else {
+            rec[NODE_TYPE]   = BINARY_TEXT;
+            rec[NODE_STRING] = str(n->type == MXML_TEXT ?
+                                   n->value.text.string : n->value.opaque);
+        }
+
+        uint32_t prev = BINARY_NONE;
+        for(const mxml_node_t *c = n->child; c; c = c->next) {
+            if(c->type != MXML_ELEMENT && c->type != MXML_TEXT
+               && c->type != MXML_OPAQUE)
+                continue;
+            const uint32_t child = add(c, id);
+            if(prev == BINARY_NONE)
+                nodes[id * NODE_FIELDS + NODE_CHILD] = child;
+            else
+                nodes[prev * NODE_FIELDS + NODE_NEXT] = child;
+            prev = child;
+        }
+        return id;
+    }
+};
+
+static void putWord(string &out, uint32_t w)
+{
+    const char b[4] = {(char)(w & 0xff), (char)((w >> 8) & 0xff),
+                       (char)((w >> 16) & 0xff), (char)(w >> 24)};
+    out.append(b, 4);
+}
+
+static uint32_t getWord(const unsigned char *in)
+{
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static bool isBinaryFile(const string &filename)
+{
+    char   magic[4];
+    FILE  *file = fopen(filename.c_str(), "rb");
+    if(file == NULL)
+        return false;
+    const bool binary = fread(magic, 1, 4, file) == 4
+                        && !memcmp(magic, BINARY_MAGIC, 4);
+    fclose(file);
+    return binary;
+}
+
+//Rebuild the mxml tree, checking every reference against the tables
+static mxml_node_t *buildBinaryTree(const unsigned char *data, size_t size)
+{
+    if(size < BINARY_HEADER * 4 || memcmp(data, BINARY_MAGIC, 4)
+       || getWord(data + 4) != BINARY_VERSION)
+        return NULL;
+    const uint64_t nnodes   = getWord(data + 8);
+    const uint64_t nattrs   = getWord(data + 12);
+    const uint64_t nstrings = getWord(data + 16);
+    if(nnodes == 0 || nstrings == 0
+       || size != BINARY_HEADER * 4 + nnodes * NODE_FIELDS * 4
+                  + nattrs * 8 + nstrings)
+        return NULL;
+
+    const unsigned char *nodes   = data + BINARY_HEADER * 4;
+    const unsigned char *attrs   = nodes + nnodes * NODE_FIELDS * 4;
+    const char          *strings = (const char *)(attrs + nattrs * 8);
+    if(strings[nstrings - 1] != 0)
+        return NULL;
+
+    vector<mxml_node_t *> built(nnodes);
+    for(uint32_t i = 0; i < nnodes; ++i) {
+        const unsigned char *rec = nodes + i * NODE_FIELDS * 4;
+        const uint32_t type   = getWord(rec + NODE_TYPE * 4);
+        const uint32_t name   = getWord(rec + NODE_STRING * 4);
+        const uint32_t parent = getWord(rec + NODE_PARENT * 4);
+        const uint64_t attr   = getWord(rec + NODE_ATTR * 4);
+        const uint64_t count  = getWord(rec + NODE_NATTRS * 4);
+
+        //only the first node is a root and parents always come first
+        bool valid = name < nstrings
+                     && (i == 0 ? parent == BINARY_NONE : parent < i);
+        if(valid && i != 0)
+            valid = built[parent]->type == MXML_ELEMENT;
+        if(valid && type == BINARY_ELEMENT && count)
+            valid = attr + count <= nattrs;
+        if(!valid || (type != BINARY_ELEMENT && type != BINARY_TEXT)) {
+            if(built[0])
+                mxmlDelete(built[0]);
+            return NULL;
+        }
+
+        mxml_node_t *p = i ? built[parent] : MXML_NO_PARENT;
+        if(type == BINARY_TEXT) {
+            built[i] = mxmlNewOpaque(p, strings + name);
+            continue;
+        }
+        built[i] = mxmlNewElement(p, strings + name);
+        for(uint32_t j = 0; j < count; ++j) {
+            const uint32_t an = getWord(attrs + (attr + j) * 8);
+            const uint32_t av = getWord(attrs + (attr + j) * 8 + 4);
+            if(an >= nstrings || (av != BINARY_NONE && av >= nstrings)) {
+                mxmlDelete(built[0]);
+                return NULL;
+            }
+            mxmlElementSetAttr(built[i], strings + an,
+                               av == BINARY_NONE ? NULL : strings + av);
+        }
+    }
+    return built[0];
+}
+
+int XMLwrapper::saveBinaryFile(const string &filename) const
+{
+    BinaryWriter w;
+    w.add(tree, BINARY_NONE);
+
+    string out;
+    out.reserve(BINARY_HEADER * 4 + (w.nodes.size() + w.attrs.size()) * 4
+                + w.strings.size());
+    out.append(BINARY_MAGIC, 4);
+    putWord(out, BINARY_VERSION);
+    putWord(out, w.nodes.size() / NODE_FIELDS);
+    putWord(out, w.attrs.size() / 2);
+    putWord(out, w.strings.size());
+    for(uint32_t word:w.nodes)
+        putWord(out, word);
+    for(uint32_t word:w.attrs)
+        putWord(out, word);
+    out += w.strings;
+
+    FILE *file = fopen(filename.c_str(), "wb");
+    if(file == NULL)
+        return -1;
+    const bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    return (fclose(file) == 0 && ok) ? 0 : -1;
+}
+
 int XMLwrapper::saveXMLfile(const string &filename, int compression) const
 {
     char *xmldata = getXMLdata();
@@ -268,6 +459,7 @@ void XMLwrapper::addparbool(const string &name, int val)
 
 void XMLwrapper::addparstr(const string &name, const string &val)
 {
+    invalidate();
     mxml_node_t *element = mxmlNewElement(node, "string");
     mxmlElementSetAttr(element, "name", name.c_str());
     mxmlNewText(element, 0, val.c_str());
@@ -312,14 +504,21 @@ int XMLwrapper::loadXMLfile(const string &filename)
 {
     cleanup();
 
-    const char *xmldata = doloadfile(filename);
-    if(xmldata == NULL)
-        return -1;  //the file could not be loaded or uncompressed
+    if(isBinaryFile(filename)) {
+        if(doloadbinary(filename, tree))
+            return -1;  //the file could not be read
+        root = tree;
+    }
+    else {
+        const char *xmldata = doloadfile(filename);
+        if(xmldata == NULL)
+            return -1;  //the file could not be loaded or uncompressed
 
-    root = tree = mxmlLoadString(NULL, trimLeadingWhite(
-                                     xmldata), MXML_OPAQUE_CALLBACK);
+        root = tree = mxmlLoadString(NULL, trimLeadingWhite(
+                                         xmldata), MXML_OPAQUE_CALLBACK);
 
-    delete[] xmldata;
+        delete[] xmldata;
+    }
 
     if(tree == NULL)
         return -2;  //this is not XML
@@ -348,32 +547,58 @@ int XMLwrapper::loadXMLfile(const string &filename)
 
 char *XMLwrapper::doloadfile(const string &filename) const
 {
-    char  *xmldata = NULL;
-    gzFile gzfile  = gzopen(filename.c_str(), "rb");
-
-    if(gzfile != NULL) { //The possibly compressed file opened
-        stringstream strBuf;             //reading stream
-        const int    bufSize = 500;      //fetch size
-        char fetchBuf[bufSize + 1];      //fetch buffer
-        int  read = 0;                   //chars read in last fetch
-
-        fetchBuf[bufSize] = 0; //force null termination
-
-        while(bufSize == (read = gzread(gzfile, fetchBuf, bufSize)))
-            strBuf << fetchBuf;
+    gzFile gzfile = gzopen(filename.c_str(), "rb");
+    if(gzfile == NULL)
+        return NULL;
+    gzbuffer(gzfile, 64 * 1024);
+
+    //Decompress straight into the result, which grows geometrically
+    size_t size     = 0;
+    size_t capacity = 64 * 1024;
+    char  *xmldata  = new char[capacity + 1];
+    int    read;
+    while((read = gzread(gzfile, xmldata + size, capacity - size)) > 0) {
+        size += read;
+        if(size == capacity) {
+            char *tmp = new char[2 * capacity + 1];
+            memcpy(tmp, xmldata, size);
+            delete[] xmldata;
+            xmldata   = tmp;
+            capacity *= 2;
+        }
+    }
+    gzclose(gzfile);
 
-        fetchBuf[read] = 0; //Truncate last partial read
-        strBuf << fetchBuf;
+    if(read < 0) { //corrupt data
+        delete[] xmldata;
+        return NULL;
+    }
+    xmldata[size] = 0;
+    return xmldata;
+}
 
-        gzclose(gzfile);
+int XMLwrapper::doloadbinary(const string &filename,
+                             mxml_node_t *&result) const
+{
+    result = NULL;
+    FILE *file = fopen(filename.c_str(), "rb");
+    if(file == NULL)
+        return -1;
 
-        //Place data in output format
-        string tmp = strBuf.str();
-        xmldata = new char[tmp.size() + 1];
-        strncpy(xmldata, tmp.c_str(), tmp.size() + 1);
-    }
+    //the whole file is read at once, there is nothing to decompress
+    long size = -1;
+    if(!fseek(file, 0, SEEK_END))
+        size = ftell(file);
+    rewind(file);
+    vector<unsigned char> data(size > 0 ? size : 0);
+    const bool ok = size >= 0
+                    && fread(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    if(!ok)
+        return -1;
 
-    return xmldata;
+    result = buildBinaryTree(data.data(), data.size());
+    return 0;
 }
 
 bool XMLwrapper::putXMLdata(const char *xmldata)
@@ -412,9 +637,7 @@ int XMLwrapper::enterbranch(const string &name)
 {
     if(verbose)
         cout << "enterbranch() " << name << endl;
-    mxml_node_t *tmp = mxmlFindElement(node, node,
-                                       name.c_str(), NULL, NULL,
-                                       MXML_DESCEND_FIRST);
+    mxml_node_t *tmp = findchild(name.c_str(), 0, NULL);
     if(tmp == NULL)
         return 0;
 
@@ -426,9 +649,8 @@ int XMLwrapper::enterbranch(const string &name, int id)
 {
     if(verbose)
         cout << "enterbranch(" << id << ") " << name << endl;
-    mxml_node_t *tmp = mxmlFindElement(node, node,
-                                       name.c_str(), "id", stringFrom<int>(
-                                           id).c_str(), MXML_DESCEND_FIRST);
+    mxml_node_t *tmp = findchild(name.c_str(), 'i',
+                                 stringFrom<int>(id).c_str());
     if(tmp == NULL)
         return 0;
 
@@ -465,12 +687,7 @@ int XMLwrapper::getbranchid(int min, int max) const
 int XMLwrapper::getpar(const string &name, int defaultpar, int min,
                        int max) const
 {
-    const mxml_node_t *tmp = mxmlFindElement(node,
-                                             node,
-                                             "par",
-                                             "name",
-                                             name.c_str(),
-                                             MXML_DESCEND_FIRST);
+    const mxml_node_t *tmp = findchild("par", 'n', name.c_str());
 
     if(tmp == NULL)
         return defaultpar;
@@ -496,12 +713,7 @@ int XMLwrapper::getpar127(const string &name, int defaultpar) const
 
 int XMLwrapper::getparbool(const string &name, int defaultpar) const
 {
-    const mxml_node_t *tmp = mxmlFindElement(node,
-                                             node,
-                                             "par_bool",
-                                             "name",
-                                             name.c_str(),
-                                             MXML_DESCEND_FIRST);
+    const mxml_node_t *tmp = findchild("par_bool", 'n', name.c_str());
 
     if(tmp == NULL)
         return defaultpar;
@@ -519,12 +731,7 @@ int XMLwrapper::getparbool(const string &name, int defaultpar) const
 void XMLwrapper::getparstr(const string &name, char *par, int maxstrlen) const
 {
     ZERO(par, maxstrlen);
-    const mxml_node_t *tmp = mxmlFindElement(node,
-                                             node,
-                                             "string",
-                                             "name",
-                                             name.c_str(),
-                                             MXML_DESCEND_FIRST);
+    const mxml_node_t *tmp = findchild("string", 'n', name.c_str());
 
     if(tmp == NULL)
         return;
@@ -544,12 +751,7 @@ void XMLwrapper::getparstr(const string &name, char *par, int maxstrlen) const
 string XMLwrapper::getparstr(const string &name,
                              const std::string &defaultpar) const
 {
-    const mxml_node_t *tmp = mxmlFindElement(node,
-                                             node,
-                                             "string",
-                                             "name",
-                                             name.c_str(),
-                                             MXML_DESCEND_FIRST);
+    const mxml_node_t *tmp = findchild("string", 'n', name.c_str());
 
     if((tmp == NULL) || (tmp->child == NULL))
         return defaultpar;
@@ -567,12 +769,7 @@ string XMLwrapper::getparstr(const string &name,
 
 float XMLwrapper::getparreal(const char *name, float defaultpar) const
 {
-    const mxml_node_t *tmp = mxmlFindElement(node,
-                                             node,
-                                             "par_real",
-                                             "name",
-                                             name,
-                                             MXML_DESCEND_FIRST);
+    const mxml_node_t *tmp = findchild("par_real", 'n', name);
     if(tmp == NULL)
         return defaultpar;
 
@@ -608,11 +805,46 @@ float XMLwrapper::getparreal(const char *name,
 
 /** Private members **/
 
+mxml_node_t *XMLwrapper::findchild(const char *element, char attr,
+                                   const char *value) const
+{
+    //nothing is loaded, as mxmlFindElement() there is no match
+    if(node == NULL)
+        return NULL;
+
+    //index the branch the first time it is searched
+    auto itr = branchIndex.emplace(node, BranchIndex());
+    BranchIndex &index = itr.first->second;
+    if(itr.second) {
+        for(mxml_node_t *child = node->child; child; child = child->next) {
+            if(child->type != MXML_ELEMENT)
+                continue;
+            //like mxmlFindElement(), the first match wins
+            const char *name = child->value.element.name;
+            index.emplace(name, child);
+            if(const char *n = mxmlElementGetAttr(child, "name"))
+                index.emplace(string(name) + '\1' + 'n' + n, child);
+            if(const char *i = mxmlElementGetAttr(child, "id"))
+                index.emplace(string(name) + '\1' + 'i' + i, child);
+        }
+    }
+
+    indexKey.assign(element);
+    if(attr) {
+        indexKey += '\1';
+        indexKey += attr;
+        indexKey += value;
+    }
+    auto match = index.find(indexKey);
+    return match == index.end() ? NULL : match->second;
+}
+
 mxml_node_t *XMLwrapper::addparams(const char *name, unsigned int params,
                                    ...) const
 {
     /**@todo make this function send out a good error message if something goes
      * wrong**/
+    invalidate();
     mxml_node_t *element = mxmlNewElement(node, name);
 
     if(params) {
@@ -661,6 +893,7 @@ bool XmlNode::has(std::string name_)
 
 void XMLwrapper::add(const XmlNode &node_)
 {
+    invalidate();
     mxml_node_t *element = mxmlNewElement(node, node_.name.c_str());
     for(auto attr:node_.attrs)
         mxmlElementSetAttr(element, attr.name.c_str(),
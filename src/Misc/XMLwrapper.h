@@ -15,6 +15,7 @@
 
 #include <mxml.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "zyn-version.h"
 
@@ -62,6 +63,29 @@ class XMLwrapper
          */
         int saveXMLfile(const std::string &filename, int compression) const;
 
+        /**
+         * Saves the tree to a file in the binary format.
+         *
+         * The binary format holds exactly the tree that would be written as
+         * XML, so it converts to XML and back without loss. All values are
+         * little endian 32 bit words:
+         *
+         *   header     "ZYNB", format version, node count, attribute count,
+         *              string table size in bytes
+         *   nodes      type, string, parent, first child, next sibling,
+         *              first attribute, attribute count
+         *   attributes name string, value string
+         *   strings    NUL terminated, each distinct string stored once
+         *
+         * Nodes are stored in document order and refer to each other and to
+         * the tables by index, strings by their byte offset. Missing links
+         * are 0xFFFFFFFF. The file is not compressed, so it may be read in
+         * a single pass (or mapped) without any text parsing.
+         * @param filename the name of the destination file.
+         * @returns 0 if ok or -1 if the file cannot be saved.
+         */
+        int saveBinaryFile(const std::string &filename) const;
+
         /**
          * Return XML tree as a string.
          * Note: The string must be freed with free() to deallocate
@@ -121,6 +145,7 @@ class XMLwrapper
 
         /**
          * Loads file into XMLwrapper.
+         * Both XML (optionally gzipped) and binary files are accepted.
          * @param filename file to be loaded
          * @returns 0 if ok or -1 if the file cannot be loaded
          */
@@ -260,11 +285,47 @@ class XMLwrapper
          */
         char *doloadfile(const std::string &filename) const;
 
+        /**
+         * Builds the tree stored in a binary file.
+         * @param filename the file
+         * @param result the loaded tree, NULL if the data is not valid
+         * @return 0 if ok or -1 if the file cannot be read
+         */
+        int doloadbinary(const std::string &filename,
+                         mxml_node_t *&result) const;
+
         /**
          * Cleanup XML tree before loading new one.
          */
         void cleanup(void);
 
+        /**
+         * Find the first child element of the current branch.
+         *
+         * The children of a branch are indexed by element name and by the
+         * value of their "name" or "id" attribute on the first lookup, so
+         * reading a branch costs one pass over it instead of one per
+         * parameter.
+         * @param element name of the element
+         * @param attr 0 to match the element only, 'n' to also match the
+         *        "name" attribute, 'i' to match the "id" attribute
+         * @param value value of the attribute
+         */
+        mxml_node_t *findchild(const char *element, char attr,
+                               const char *value) const;
+
+        /**Forget the indexes, after the tree changed*/
+        void invalidate(void) const
+        {
+            if(!branchIndex.empty())
+                branchIndex.clear();
+        }
+
+        typedef std::unordered_map<std::string, mxml_node_t *> BranchIndex;
+        mutable std::unordered_map<const mxml_node_t *, BranchIndex>
+                            branchIndex;
+        mutable std::string indexKey; /**<lookup key, kept to reuse storage*/
+
         mxml_node_t *tree; /**<all xml data*/
         mxml_node_t *root; /**<xml data used by zynaddsubfx*/
         mxml_node_t *node; /**<current subtree in parsing or writing */
@@ -121,6 +121,7 @@ void *AlsaEngine::MidiThread(void)
         ev.num     = 0;
         ev.value   = 0;
         ev.type    = 0;
+        ev.time    = InMgr::getInstance().periodOffset();
 
         if(!event)
             continue;
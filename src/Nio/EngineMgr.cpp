@@ -19,6 +19,7 @@
 #include "AudioOut.h"
 #include "MidiIn.h"
 #include "NulEngine.h"
+#include "OfflineEngine.h"
 using namespace std;
 
 #if OSS
@@ -52,6 +53,7 @@ EngineMgr::EngineMgr(const SYNTH_T *synth, const oss_devs_t& oss_devs)
 
     //conditional compiling mess (but contained)
     engines.push_back(defaultEng);
+    engines.push_back(new OfflineEngine(*synth));
 #if OSS
     engines.push_back(new OssEngine(*synth, oss_devs));
     engines.push_back(new OssMultiEngine(*synth, oss_devs));
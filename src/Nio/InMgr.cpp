@@ -16,6 +16,7 @@
 #include "../Misc/Part.h"
 #include "../Misc/MiddleWare.h"
 #include <rtosc/thread-link.h>
+#include <chrono>
 #include <iostream>
 using namespace std;
 
@@ -58,10 +59,11 @@ InMgr &InMgr::getInstance()
 }
 
 InMgr::InMgr()
-    :queue(100), master(NULL)
+    :writePos(0), readPos(0), dropped(0), lateEvents(0),
+    periodFrame(0), nextFrame(0),
+    periodStart(0), periodFrames(0), periodRate(0), master(NULL)
 {
     current = NULL;
-    work.init(PTHREAD_PROCESS_PRIVATE, 0);
 }
 
 InMgr::~InMgr()
@@ -71,30 +73,40 @@ InMgr::~InMgr()
 
 void InMgr::putEvent(MidiEvent ev)
 {
-    if(queue.push(ev)) //check for error
-        cerr << "ERROR: Midi Ringbuffer is FULL" << endl;
-    else
-        work.post();
+    const uint32_t w = writePos.load(std::memory_order_relaxed);
+    if(w - readPos.load(std::memory_order_acquire) >= MIDI_QUEUE_SIZE) {
+        dropped++;
+        return;
+    }
+    //offsets are relative to the next period to be flushed
+    Slot &slot = queue[w & (MIDI_QUEUE_SIZE - 1)];
+    slot.frame = nextFrame.load(std::memory_order_acquire) + ev.time;
+    slot.ev    = ev;
+    writePos.store(w + 1, std::memory_order_release);
 }
 
 void InMgr::flush(unsigned frameStart, unsigned frameStop)
 {
-    MidiEvent ev;
-    while(!work.trywait()) {
-        queue.peak(ev);
-        if(ev.time < (int)frameStart || ev.time > (int)frameStop) {
-            //Back out of transaction
-            work.post();
-            //printf("%d vs [%d..%d]\n",ev.time, frameStart, frameStop);
+    const int64_t start = periodFrame + frameStart;
+    const int64_t stop  = periodFrame + frameStop;
+    const uint32_t w = writePos.load(std::memory_order_acquire);
+    uint32_t r = readPos.load(std::memory_order_relaxed);
+    //everything before frameStop is taken at once, the slots are only
+    //handed back to the producer at the end
+    for(; r != w; ++r) {
+        const Slot &slot = queue[r & (MIDI_QUEUE_SIZE - 1)];
+        if(slot.frame >= stop)
             break;
-        }
-        queue.pop(ev);
-        //cout << ev << endl;
+        if(slot.frame < periodFrame)
+            lateEvents++;
+
+        const MidiEvent &ev = slot.ev;
+        const int offset = slot.frame > start ? slot.frame - start : 0;
 
         switch(ev.type) {
             case M_NOTE:
                 if(ev.value)
-                    master->noteOn(ev.channel, ev.num, ev.value);
+                    master->noteOn(ev.channel, ev.num, ev.value, offset);
                 else
                     master->noteOff(ev.channel, ev.num);
                 break;
@@ -126,12 +138,51 @@ void InMgr::flush(unsigned frameStart, unsigned frameStop)
                 break;
         }
     }
+    readPos.store(r, std::memory_order_release);
+}
+
+static int64_t now_ns(void)
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(
+            steady_clock::now().time_since_epoch()).count();
+}
+
+void InMgr::startPeriod(unsigned frames, unsigned samplerate)
+{
+    periodFrame = nextFrame.load(std::memory_order_relaxed);
+    nextFrame.store(periodFrame + frames, std::memory_order_release);
+    periodFrames = frames;
+    periodRate   = samplerate;
+    periodStart  = now_ns();
+}
+
+int InMgr::periodOffset() const
+{
+    const unsigned frames = periodFrames;
+    if(!frames)
+        return 0;
+    const int64_t elapsed = now_ns() - periodStart;
+    const int64_t offset  = elapsed * periodRate / 1000000000;
+    if(offset < 0)
+        return 0;
+    return offset < frames ? offset : frames - 1;
 }
 
 bool InMgr::empty(void) const
 {
-    int semvalue = work.getvalue();
-    return semvalue <= 0;
+    return readPos.load(std::memory_order_acquire)
+           == writePos.load(std::memory_order_acquire);
+}
+
+unsigned InMgr::overflows(void) const
+{
+    return dropped;
+}
+
+unsigned InMgr::late(void) const
+{
+    return lateEvents;
 }
 
 bool InMgr::setSource(string name)
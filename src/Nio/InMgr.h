@@ -12,9 +12,9 @@
 #ifndef INMGR_H
 #define INMGR_H
 
+#include <atomic>
+#include <stdint.h>
 #include <string>
-#include "ZynSema.h"
-#include "SafeQueue.h"
 
 namespace zyn {
 
@@ -32,9 +32,12 @@ struct MidiEvent {
     int type;    //type=1 for note, type=2 for controller
     int num;     //note, controller or program number
     int value;   //velocity or controller value
-    int time;    //time offset of event (used only in jack->jack case at the moment)
+    int time;    //sample offset of the event in the audio period
 };
 
+//Size of the event queue (a power of two)
+#define MIDI_QUEUE_SIZE 4096
+
 //super simple class to manage the inputs
 class InMgr
 {
@@ -42,13 +45,35 @@ class InMgr
         static InMgr &getInstance();
         ~InMgr();
 
+        /**Queue an event from the MIDI driver
+         *
+         * Wait free, but there must only be one producer (the current
+         * source). When the queue is full the event is dropped and
+         * counted.*/
         void putEvent(MidiEvent ev);
 
-        /**Flush the Midi Queue*/
+        /**Flush the Midi Queue
+         *
+         * Applies the events before frameStop, note ons start at their
+         * offset from frameStart (events before frameStart are late and
+         * start at once)*/
         void flush(unsigned frameStart, unsigned frameStop);
 
+        /**Mark the start of an audio period*/
+        void startPeriod(unsigned frames, unsigned samplerate);
+
+        /**Offset for an event arriving now from a driver without its own
+         * timestamps. The event is played at the same position of the next
+         * period, which trades one period of latency for zero jitter.*/
+        int periodOffset() const;
+
         bool empty() const;
 
+        /**Events dropped since the queue was full*/
+        unsigned overflows() const;
+        /**Events applied after the buffer they were meant for*/
+        unsigned late() const;
+
         bool setSource(std::string name);
 
         std::string getSource() const;
@@ -59,10 +84,27 @@ class InMgr
     private:
         InMgr();
         class MidiIn *getIn(std::string name);
-        SafeQueue<MidiEvent> queue;
-        mutable ZynSema work;
+
+        //Single producer, single consumer ring of events, each stamped with
+        //the absolute frame it is to be played at
+        struct Slot {
+            int64_t   frame;
+            MidiEvent ev;
+        };
+        Slot queue[MIDI_QUEUE_SIZE];
+        std::atomic<uint32_t> writePos, readPos;
+        std::atomic<unsigned> dropped, lateEvents;
+        //Frames since the start, at the current and the next period
+        int64_t              periodFrame;
+        std::atomic<int64_t> nextFrame;
+
         class MidiIn * current;
 
+        //Start (in ns) and length of the current audio period
+        std::atomic<int64_t>  periodStart;
+        std::atomic<unsigned> periodFrames;
+        std::atomic<unsigned> periodRate;
+
         /**the link to the rest of zyn*/
         class Master *master;
 };
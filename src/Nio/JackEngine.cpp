@@ -14,6 +14,7 @@
 #include <iostream>
 
 #include <jack/midiport.h>
+#include <jack/transport.h>
 #ifdef JACK_HAS_METADATA_API
 # include <jack/metadata.h>
 #endif // JACK_HAS_METADATA_API
@@ -180,6 +181,11 @@ bool JackEngine::openAudio()
         if(!connectJack())
             return false;
 
+    //The process callback ticks OutMgr once both ports exist, so the
+    //conversion is prepared before they are registered
+    audio.jackSamplerate = jack_get_sample_rate(jackClient);
+    audio.jackNframes    = jack_get_buffer_size(jackClient);
+    OutMgr::getInstance().setOutputRate(this, audio.jackSamplerate);
 
     const char *portnames[] = { "out_1", "out_2" };
     for(int port = 0; port < 2; ++port)
@@ -191,9 +197,6 @@ bool JackEngine::openAudio()
             | JackPortIsTerminal,
             0);
     if((NULL != audio.ports[0]) && (NULL != audio.ports[1])) {
-        audio.jackSamplerate = jack_get_sample_rate(jackClient);
-        audio.jackNframes    = jack_get_buffer_size(jackClient);
-        samplerate = audio.jackSamplerate;
         bufferSize = audio.jackNframes;
 
 
@@ -339,6 +342,17 @@ bool JackEngine::processAudio(jack_nframes_t nframes)
         }
     }
 
+    //follow the jack transport when a timebase master provides BBT info
+    jack_position_t pos;
+    const jack_transport_state_t state =
+        jack_transport_query(jackClient, &pos);
+    if(pos.valid & JackPositionBBT) {
+        const double beat = (pos.bar - 1) * (double)pos.beats_per_bar
+                            + (pos.beat - 1) + pos.tick / pos.ticks_per_beat;
+        OutMgr::getInstance().setTransport(pos.beats_per_minute, beat,
+                                           state == JackTransportRolling);
+    }
+
     Stereo<float *> smp = getNext();
 
     //Assumes size of smp.l == nframes
@@ -391,7 +405,10 @@ void JackEngine::handleMidi(unsigned long frames)
         midi_data  = jack_midi_event.buffer;
         type       = midi_data[0] & 0xF0;
         ev.channel = midi_data[0] & 0x0F;
-        ev.time    = midi.jack_sync ? jack_midi_event.time : 0;
+        //with jack audio the events are in the period being rendered,
+        //otherwise they are placed by their arrival in the audio period
+        ev.time    = midi.jack_sync ? (int)jack_midi_event.time
+                     : InMgr::getInstance().periodOffset();
 
         switch(type) {
             case 0x80: /* note-off */
@@ -19,22 +19,21 @@
 #include <cassert>
 
 #include "Nio.h"
+#include "OutMgr.h"
 #include "../Misc/Util.h"
-#include "../Misc/Master.h"
-#include "../Misc/Part.h"
-#include "../Misc/MiddleWare.h"
 
 #include "JackMultiEngine.h"
 
-extern zyn::MiddleWare *middleware;
-
 namespace zyn {
 
 using std::string;
 
+//a port pair for each output bus
+#define NUM_PORTS (NUM_OUT_BUSES * 2)
+
 struct jack_multi
 {
-    jack_port_t *ports[NUM_MIDI_PARTS * 2 + 2];
+    jack_port_t *ports[NUM_PORTS];
     jack_client_t *client;
     bool running;
 };
@@ -98,12 +97,16 @@ bool JackMultiEngine::Start(void)
     impl->ports[0] = JACK_REGISTER("out-L");
     impl->ports[1] = JACK_REGISTER("out-R");
 
-    //Create all part's outputs
-    for(int i = 0; i < NUM_MIDI_PARTS * 2; i += 2) {
-        snprintf(portName, 19, "part%d/out-L", i / 2);
-        impl->ports[2 + i] = JACK_REGISTER(portName);
-        snprintf(portName, 19, "part%d/out-R", i / 2);
-        impl->ports[3 + i] = JACK_REGISTER(portName);
+    //Create the outputs of the other buses, named after the source meant
+    //for them (bus N + 1 for part N, where it plays by default)
+    for(int bus = 1; bus < NUM_OUT_BUSES; ++bus) {
+        const char *src = bus <= NUM_MIDI_PARTS ? "part" : "sysefx";
+        const int   n   = bus <= NUM_MIDI_PARTS ? bus - 1
+                                                : bus - 1 - NUM_MIDI_PARTS;
+        snprintf(portName, 19, "%s%d/out-L", src, n);
+        impl->ports[2 * bus] = JACK_REGISTER(portName);
+        snprintf(portName, 19, "%s%d/out-R", src, n);
+        impl->ports[2 * bus + 1] = JACK_REGISTER(portName);
     }
 
     //verify that all sample rate and buffer_size are the same in jack.
@@ -131,36 +134,34 @@ int JackMultiEngine::_processCallback(jack_nframes_t nframes, void *arg)
 int JackMultiEngine::processAudio(jack_nframes_t nframes)
 {
     //Gather all buffers
-    float *buffers[NUM_MIDI_PARTS * 2 + 2];
+    float *busl[NUM_OUT_BUSES], *busr[NUM_OUT_BUSES];
 
-    for(int i = 0; i < NUM_MIDI_PARTS * 2 + 2; ++i) {
+    for(int bus = 0; bus < NUM_OUT_BUSES; ++bus) {
         //Abort if ports are only partially initialized
-        if(!impl->ports[i])
+        if(!impl->ports[2 * bus] || !impl->ports[2 * bus + 1])
             return false;
 
-        buffers[i] =
-            (float *)jack_port_get_buffer(impl->ports[i], nframes);
-        assert(buffers[i]);
+        busl[bus] =
+            (float *)jack_port_get_buffer(impl->ports[2 * bus], nframes);
+        busr[bus] =
+            (float *)jack_port_get_buffer(impl->ports[2 * bus + 1], nframes);
+        assert(busl[bus] && busr[bus]);
     }
 
-    //Get the wet samples from OutMgr
+    //The buses are written straight to the port buffers
+    OutMgr::getInstance().setBuses(busl, busr, NUM_OUT_BUSES);
+
+    //Get the main mix from OutMgr
     Stereo<float *> smp = getNext();
-    memcpy(buffers[0], smp.l, synth.bufferbytes);
-    memcpy(buffers[1], smp.r, synth.bufferbytes);
-
-    //Gather other samples from individual parts
-    Master &master = *middleware->spawnMaster();
-    for(int i = 0; i < NUM_MIDI_PARTS; ++i) {
-        memcpy(buffers[2*i + 2], master.part[i]->partoutl, synth.bufferbytes);
-        memcpy(buffers[2*i + 3], master.part[i]->partoutr, synth.bufferbytes);
-    }
+    memcpy(busl[0], smp.l, nframes * sizeof(float));
+    memcpy(busr[0], smp.r, nframes * sizeof(float));
 
     return false;
 }
 
 void JackMultiEngine::Stop()
 {
-    for(int i = 0; i < NUM_MIDI_PARTS * 2 + 2; ++i) {
+    for(int i = 0; i < NUM_PORTS; ++i) {
         jack_port_t *port = impl->ports[i];
         impl->ports[i] = NULL;
         if(port)
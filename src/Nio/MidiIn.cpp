@@ -19,9 +19,11 @@ namespace zyn {
 
 void MidiIn::midiProcess(unsigned char head,
                          unsigned char num,
-                         unsigned char value)
+                         unsigned char value,
+                         int time)
 {
     MidiEvent     ev;
+    ev.time = time;
     unsigned char chan = head & 0x0f;
     switch(head & 0xf0) {
         case 0x80: //Note Off
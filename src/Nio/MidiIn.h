@@ -28,9 +28,12 @@ class MidiIn:public virtual Engine
         virtual void setMidiEn(bool nval) = 0;
         /**Returns if driver is initialized*/
         virtual bool getMidiEn() const = 0;
+        /**Queue a raw channel message
+         * @param time sample offset within the next audio period*/
         static void midiProcess(unsigned char head,
                                 unsigned char num,
-                                unsigned char value);
+                                unsigned char value,
+                                int time = 0);
 };
 
 }
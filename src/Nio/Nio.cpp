@@ -16,6 +16,8 @@
 #include "MidiIn.h"
 #include "AudioOut.h"
 #include "WavEngine.h"
+#include "OfflineEngine.h"
+#include "NulEngine.h"
 #include "../Misc/Config.h"
 #include <cstring>
 #include <iostream>
@@ -42,6 +44,7 @@ string     postfix;
 
 bool   Nio::autoConnect     = false;
 bool   Nio::pidInClientName = false;
+int    Nio::resampleQuality = 2;
 string Nio::defaultSource   = IN_DEFAULT;
 string Nio::defaultSink     = OUT_DEFAULT;
 
@@ -82,6 +85,49 @@ void Nio::setDefaultSink(string name)
     defaultSink = name;
 }
 
+void Nio::setRender(string midifile, string wavfile, int format, int rate)
+{
+    OfflineEngine::midiFile = midifile;
+    OfflineEngine::wavFile  = wavfile;
+    OfflineEngine::format   = format;
+    OfflineEngine::rate     = rate;
+    setDefaultSource("OFFLINE");
+    setDefaultSink("OFFLINE");
+}
+
+bool Nio::renderDone(void)
+{
+    OfflineEngine *offline =
+        eng ? dynamic_cast<OfflineEngine *>(eng->getEng("OFFLINE")) : NULL;
+    return offline && offline->finished();
+}
+
+bool Nio::renderFailed(void)
+{
+    OfflineEngine *offline =
+        eng ? dynamic_cast<OfflineEngine *>(eng->getEng("OFFLINE")) : NULL;
+    return offline && offline->failed();
+}
+
+void Nio::setNullClock(int period, bool realtime)
+{
+    NulEngine::period   = period;
+    NulEngine::realtime = realtime;
+}
+
+void Nio::nullStats(int64_t &periods, int &xruns, float &lateMean,
+                    float &lateMax)
+{
+    NulEngine *null =
+        eng ? dynamic_cast<NulEngine *>(eng->getEng("NULL")) : NULL;
+    const NulEngine::Stats s =
+        null ? null->stats() : NulEngine::Stats{0, 0, 0.0f, 0.0f};
+    periods  = s.periods;
+    xruns    = s.xruns;
+    lateMean = s.lateMean;
+    lateMax  = s.lateMax;
+}
+
 bool Nio::setSource(string name)
 {
     return in->setSource(name);
@@ -132,6 +178,16 @@ string Nio::getSink()
     return out->getSink();
 }
 
+unsigned Nio::midiOverflows(void)
+{
+    return in ? in->overflows() : 0;
+}
+
+unsigned Nio::midiLate(void)
+{
+    return in ? in->late() : 0;
+}
+
 #if JACK
 #include <jack/jack.h>
 void Nio::preferredSampleRate(unsigned &rate)
@@ -172,6 +228,30 @@ void Nio::waveNew(class WavFile *wave)
     out->wave->newFile(wave);
 }
 
+WavTracks *Nio::waveOpen(const std::vector<WavFile *> &files)
+{
+    return out->wave->newTracks(files);
+}
+
+void Nio::waveClose(WavTracks *tracks)
+{
+    if(out)
+        out->wave->closeTracks(tracks);
+    else
+        delete tracks;
+}
+
+WavTracks *Nio::waveSwap(WavTracks *tracks)
+{
+    return out->wave->swapTracks(tracks);
+}
+
+void Nio::waveCapture(int track, const float *l, const float *r, float gain)
+{
+    if(out)
+        out->wave->capture(track, l, r, gain);
+}
+
 void Nio::waveStart(void)
 {
     out->wave->Start();
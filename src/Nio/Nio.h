@@ -13,10 +13,13 @@
 #define NIO_H
 #include <string>
 #include <set>
+#include <stdint.h>
+#include <vector>
 
 namespace zyn {
 
 class WavFile;
+struct WavTracks;
 class Master;
 struct SYNTH_T;
 class oss_devs_t;
@@ -45,6 +48,10 @@ namespace Nio
     std::string getSource(void);
     std::string getSink(void);
 
+    //MIDI events dropped on a full queue / applied after their period
+    unsigned midiOverflows(void);
+    unsigned midiLate(void);
+
     //Get the preferred sample rate from jack (if running)
     void preferredSampleRate(unsigned &rate);
 
@@ -53,11 +60,35 @@ namespace Nio
 
     //Wave writing
     void waveNew(class WavFile *wave);
+    //Multitrack recordings: the tracks are set up and freed outside of
+    //the RT context and swapped in from it (returning the previous ones)
+    WavTracks *waveOpen(const std::vector<WavFile *> &files);
+    void waveClose(WavTracks *tracks);
+    WavTracks *waveSwap(WavTracks *tracks);
+    //Stems of multitrack recordings (ONLY FROM RT CONTEXT)
+    void waveCapture(int track, const float *l, const float *r, float gain);
     void waveStart(void);
     void waveStop(void);
     void waveEnd(void);
 
+    //Offline rendering of a MIDI file with the OFFLINE engine
+    //(call before init, format is a WavFile::Format)
+    //(rate of the file, 0 for the synth's)
+    void setRender(std::string midifile, std::string wavfile, int format,
+                   int rate = 0);
+    bool renderDone(void);
+    bool renderFailed(void);
+
+    //Period (0 for the buffer size) and SCHED_FIFO of the NULL engine
+    //(call before init)
+    void setNullClock(int period, bool realtime);
+    //Periods played, xruns and the mean/max wake up latency (us)
+    void nullStats(int64_t &periods, int &xruns, float &lateMean,
+                   float &lateMax);
+
     extern bool autoConnect;
+    //Quality of the conversion to the output rate (a Resampler::Quality)
+    extern int  resampleQuality;
     extern bool pidInClientName;
     extern std::string defaultSource;
     extern std::string defaultSink;
@@ -1,7 +1,7 @@
 /*
   ZynAddSubFX - a software synthesizer
 
-  OSSaudiooutput.C - Audio output for Open Sound System
+  NulEngine.cpp - Dummy In/Out driver
   Copyright (C) 2002-2005 Nasca Octavian Paul
   Author: Nasca Octavian Paul
 
@@ -15,17 +15,31 @@
 #include "../globals.h"
 #include "../Misc/Util.h"
 
+#include <cerrno>
 #include <iostream>
+#include <time.h>
+#include <sched.h>
 using namespace std;
 
+#if defined(__linux__) || defined(__FreeBSD__)
+#define HAVE_CLOCK_NANOSLEEP 1
+#else
+#include <chrono>
+#include <thread>
+#endif
+
 namespace zyn {
 
+int  NulEngine::period   = 0;
+bool NulEngine::realtime = false;
+
 NulEngine::NulEngine(const SYNTH_T &synth_)
-    :AudioOut(synth_), pThread(NULL)
+    :AudioOut(synth_), pThread(NULL),
+    periods(0), lateSum(0), lateMax(0), xruns(0)
 {
     name = "NULL";
-    playing_until.tv_sec  = 0;
-    playing_until.tv_usec = 0;
+    if(period > 0)
+        bufferSize = period;
 }
 
 void *NulEngine::_AudioThread(void *arg)
@@ -33,37 +47,85 @@ void *NulEngine::_AudioThread(void *arg)
     return (static_cast<NulEngine *>(arg))->AudioThread();
 }
 
+#ifdef HAVE_CLOCK_NANOSLEEP
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until_ns(int64_t deadline)
+{
+    struct timespec ts;
+    ts.tv_sec  = deadline / 1000000000LL;
+    ts.tv_nsec = deadline % 1000000000LL;
+    //restart after signals, the deadline stays the same
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+#else
+static int64_t now_ns(void)
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(
+            steady_clock::now().time_since_epoch()).count();
+}
+
+static void sleep_until_ns(int64_t deadline)
+{
+    using namespace std::chrono;
+    this_thread::sleep_until(steady_clock::time_point(nanoseconds(deadline)));
+}
+#endif
+
 void *NulEngine::AudioThread()
 {
+#ifndef WIN32
+    if(realtime) {
+        sched_param param;
+        param.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+        if(pthread_setschedparam(pthread_self(), SCHED_FIFO, &param))
+            cerr << "WARNING - the NULL engine could not get realtime "
+                    "priority" << endl;
+    }
+#endif
+
+    const int64_t period_ns = bufferSize * 1000000000LL / samplerate;
+    //The deadlines are computed from the frame count rather than summed
+    //up, so the rounding of the period does not drift
+    int64_t start  = now_ns();
+    int64_t frames = 0;
     while(pThread) {
         getNext();
+        frames += bufferSize;
+        const int64_t deadline = start + frames * 1000000000LL / samplerate;
 
-        struct timeval now;
-        int remaining = 0;
-        gettimeofday(&now, NULL);
-        if((playing_until.tv_usec == 0) && (playing_until.tv_sec == 0)) {
-            playing_until.tv_usec = now.tv_usec;
-            playing_until.tv_sec  = now.tv_sec;
+        if(now_ns() > deadline + period_ns) {
+            xruns++;
+            start  = now_ns();
+            frames = 0;
+            continue;
         }
-        else {
-            remaining = (playing_until.tv_usec - now.tv_usec)
-                        + (playing_until.tv_sec - now.tv_sec) * 1000000;
-            if(remaining > 10000) //Don't sleep() less than 10ms.
-                //This will add latency...
-                os_usleep(remaining  - 10000);
-            if(remaining < 0)
-                cerr << "WARNING - too late" << endl;
+
+        sleep_until_ns(deadline);
+        const int64_t late = now_ns() - deadline;
+        if(late > 0) {
+            lateSum += late;
+            if(late > lateMax)
+                lateMax = late;
         }
-        playing_until.tv_usec += synth.buffersize * 1000000
-                                 / synth.samplerate;
-        if(remaining < 0)
-            playing_until.tv_usec -= remaining;
-        playing_until.tv_sec  += playing_until.tv_usec / 1000000;
-        playing_until.tv_usec %= 1000000;
+        periods++;
     }
     return NULL;
 }
 
+NulEngine::Stats NulEngine::stats() const
+{
+    const int64_t n = periods;
+    return Stats{n, xruns, n ? lateSum / n / 1e3f : 0.0f, lateMax / 1e3f};
+}
+
 NulEngine::~NulEngine()
 {}
 
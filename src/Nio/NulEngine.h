@@ -14,7 +14,8 @@
 #ifndef NUL_ENGINE_H
 #define NUL_ENGINE_H
 
-#include <sys/time.h>
+#include <atomic>
+#include <stdint.h>
 #include <pthread.h>
 #include "../globals.h"
 #include "AudioOut.h"
@@ -22,6 +23,12 @@
 
 namespace zyn {
 
+/**Output without a sound card, paced by the monotonic clock
+ *
+ * Each period is rendered and then the thread sleeps until the absolute
+ * time at which the period ends, so timing errors do not accumulate.
+ * An instance that falls more than a period behind counts an xrun and
+ * restarts its clock instead of rendering a burst to catch up.*/
 class NulEngine:public AudioOut, MidiIn
 {
     public:
@@ -37,13 +44,27 @@ class NulEngine:public AudioOut, MidiIn
         void setMidiEn(bool) {}
         bool getMidiEn() const {return true; }
 
+        struct Stats {
+            int64_t periods;
+            int     xruns;
+            float   lateMean, lateMax; //wake up after the deadline (us)
+        };
+        Stats stats() const;
+
+        //Frames per period (0 for the buffer size) and SCHED_FIFO,
+        //set before the engine is created
+        static int  period;
+        static bool realtime;
+
     protected:
         void *AudioThread();
         static void *_AudioThread(void *arg);
 
     private:
-        struct timeval playing_until;
         pthread_t     *pThread;
+
+        std::atomic<int64_t> periods, lateSum, lateMax; //late in ns
+        std::atomic<int>     xruns;
 };
 
 }
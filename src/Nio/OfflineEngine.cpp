@@ -0,0 +1,195 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  OfflineEngine.cpp - Faster than realtime rendering of MIDI files
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+#include "OfflineEngine.h"
+#include "../Misc/MidiFile.h"
+#include "../Misc/WavFile.h"
+#include "../Misc/Util.h"
+#include "../DSP/Resampler.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+using namespace std;
+
+namespace zyn {
+
+//Events queued per buffer (the InMgr queue holds 100)
+#define MAX_BUFFER_EVENTS 64
+//Rendering stops after this much silence following the last event
+#define SILENCE_SECONDS 1
+#define SILENCE_LEVEL   1e-5f
+//or at the latest after this much time following the last event
+#define MAX_TAIL_SECONDS 60
+
+string OfflineEngine::midiFile;
+string OfflineEngine::wavFile;
+int    OfflineEngine::format = WavFile::PCM16;
+int    OfflineEngine::rate   = 0;
+
+OfflineEngine::OfflineEngine(const SYNTH_T &synth_)
+    :AudioOut(synth_), pThread(NULL), done(false), error(false)
+{
+    name = "OFFLINE";
+}
+
+OfflineEngine::~OfflineEngine()
+{}
+
+void *OfflineEngine::_AudioThread(void *arg)
+{
+    return (static_cast<OfflineEngine *>(arg))->AudioThread();
+}
+
+void *OfflineEngine::AudioThread()
+{
+    error = !render();
+    done  = true;
+    return NULL;
+}
+
+bool OfflineEngine::render()
+{
+    MidiFile midi;
+    if(midi.load(midiFile)) {
+        cerr << "ERROR: Could not read MIDI file " << midiFile << endl;
+        return false;
+    }
+    const int fileRate = rate > 0 ? rate : synth.samplerate;
+    WavFile wav(wavFile, fileRate, 2, (WavFile::Format)format);
+    if(!wav.good()) {
+        cerr << "ERROR: Could not write " << wavFile << endl;
+        return false;
+    }
+
+    const vector<MidiFile::Event> &events = midi.events();
+    const int    bs        = synth.buffersize;
+    const double rate      = synth.samplerate;
+    const double lastFrame = midi.length() * rate;
+
+    //conversion to the rate of the file
+    Resampler *resl = NULL, *resr = NULL;
+    int maxOut = bs;
+    if(fileRate != (int)synth.samplerate) {
+        resl   = new Resampler(synth.samplerate, fileRate, bs);
+        resr   = new Resampler(synth.samplerate, fileRate, bs);
+        maxOut = resl->maxOut(bs);
+    }
+    float *frames = new float[2 * maxOut];
+    float *outl   = new float[maxOut];
+    float *outr   = new float[maxOut];
+
+    cout << "Rendering " << midiFile << " (" << midi.length() << "s) to "
+         << wavFile << endl;
+    const auto start = chrono::steady_clock::now();
+
+    size_t   next   = 0;
+    uint64_t pos    = 0;
+    int      silent = 0;
+    while(pThread) {
+        //events of this buffer are played at their offsets in it, late
+        //ones (over MAX_BUFFER_EVENTS) at its start
+        for(int n = 0; n < MAX_BUFFER_EVENTS && next < events.size(); ++n) {
+            const double frame = events[next].time * rate;
+            if(frame >= pos + bs)
+                break;
+            const unsigned char *msg = events[next++].msg;
+            const int64_t offset = llrint(frame) - (int64_t)pos;
+            midiProcess(msg[0], msg[1], msg[2],
+                        (int)limit<int64_t>(offset, 0, bs - 1));
+        }
+
+        const Stereo<float *> smps = getNext();
+        float peak = 0.0f;
+        for(int i = 0; i < bs; ++i)
+            peak = max(peak, max(fabsf(smps.l[i]), fabsf(smps.r[i])));
+
+        int n = bs;
+        const float *l = smps.l, *r = smps.r;
+        if(resl) {
+            n = resl->process(smps.l, bs, outl);
+            resr->process(smps.r, bs, outr);
+            l = outl;
+            r = outr;
+        }
+        for(int i = 0; i < n; ++i) {
+            frames[2 * i]     = l[i];
+            frames[2 * i + 1] = r[i];
+        }
+        wav.writeStereoSamples(n, frames);
+        pos += bs;
+
+        if(next < events.size() || pos < lastFrame)
+            continue;
+        silent = peak < SILENCE_LEVEL ? silent + bs : 0;
+        if(silent >= SILENCE_SECONDS * rate
+           || pos >= lastFrame + MAX_TAIL_SECONDS * rate)
+            break;
+    }
+    delete [] frames;
+    delete [] outl;
+    delete [] outr;
+    delete resl;
+    delete resr;
+
+    const double wall = chrono::duration<double>(
+            chrono::steady_clock::now() - start).count();
+    cout << "Rendered " << pos / rate << "s of audio in " << wall << "s ("
+         << (wall > 0 ? pos / rate / wall : 0) << "x realtime)" << endl;
+
+    if(!wav.good()) {
+        cerr << "ERROR: Could not write " << wavFile << endl;
+        return false;
+    }
+    return true;
+}
+
+bool OfflineEngine::Start()
+{
+    setAudioEn(true);
+    return getAudioEn();
+}
+
+void OfflineEngine::Stop()
+{
+    setAudioEn(false);
+}
+
+void OfflineEngine::setAudioEn(bool nval)
+{
+    if(nval) {
+        if(!getAudioEn()) {
+            pthread_t     *thread = new pthread_t;
+            pthread_attr_t attr;
+            pthread_attr_init(&attr);
+            pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+            done    = false;
+            error   = false;
+            pThread = thread;
+            pthread_create(pThread, &attr, _AudioThread, this);
+        }
+    }
+    else
+    if(getAudioEn()) {
+        pthread_t *thread = pThread;
+        pThread = NULL;
+        pthread_join(*thread, NULL);
+        delete thread;
+    }
+}
+
+bool OfflineEngine::getAudioEn() const
+{
+    return pThread;
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  OfflineEngine.h - Faster than realtime rendering of MIDI files
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+#ifndef OFFLINE_ENGINE_H
+#define OFFLINE_ENGINE_H
+
+#include <atomic>
+#include <string>
+#include <pthread.h>
+#include "../globals.h"
+#include "AudioOut.h"
+#include "MidiIn.h"
+
+namespace zyn {
+
+/**Renders the file given to Nio::setRender() to a wave file
+ *
+ * The audio thread plays the MIDI file through InMgr with sample offsets
+ * and renders buffer after buffer without waiting for a clock. It stops
+ * once the output is silent after the last event.*/
+class OfflineEngine:public AudioOut, MidiIn
+{
+    public:
+        OfflineEngine(const SYNTH_T &synth_);
+        ~OfflineEngine();
+
+        bool Start();
+        void Stop();
+
+        void setAudioEn(bool nval);
+        bool getAudioEn() const;
+
+        void setMidiEn(bool) {}
+        bool getMidiEn() const {return true; }
+
+        /**True once the whole file has been rendered (or failed to)*/
+        bool finished() const {return done; }
+        /**True if the MIDI file could not be read or the output could
+         * not be written*/
+        bool failed() const {return error; }
+
+        //What to render, set before the engine starts
+        static std::string midiFile;
+        static std::string wavFile;
+        static int         format;  //a WavFile::Format
+        static int         rate;    //of the file, 0 for the synth's
+
+    protected:
+        void *AudioThread();
+        static void *_AudioThread(void *arg);
+
+    private:
+        /**@returns false on errors*/
+        bool render();
+
+        pthread_t        *pThread;
+        std::atomic<bool> done;
+        std::atomic<bool> error;
+};
+
+}
+
+#endif
@@ -23,9 +23,8 @@
 #include <signal.h>
 
 #include "Nio.h"
-#include "../Misc/Master.h"
-#include "../Misc/Part.h"
-#include "../Misc/MiddleWare.h"
+#include "OutMgr.h"
+#include "../Misc/Config.h"
 #include "../Misc/Util.h"
 
 #include "OssMultiEngine.h"
@@ -33,8 +32,6 @@
 
 using namespace std;
 
-extern zyn::MiddleWare *middleware;
-
 namespace zyn {
 
 OssMultiEngine :: OssMultiEngine(const SYNTH_T &synth,
@@ -42,6 +39,8 @@ OssMultiEngine :: OssMultiEngine(const SYNTH_T &synth,
     :AudioOut(synth),
     linux_oss_wave_out_dev(oss_devs.linux_wave_out)
 {
+    int x;
+
     /* setup variables */
     name = "OSS-MULTI";
     audioThread = 0;
@@ -61,6 +60,13 @@ OssMultiEngine :: OssMultiEngine(const SYNTH_T &synth,
     unsigned peaksize = NUM_MIDI_PARTS * sizeof(float);
     peaks = new float[peaksize / sizeof(float)];
     memset(peaks, 0, peaksize);
+
+    /* channel pair N plays output bus N + 1 */
+    busl[0] = busr[0] = NULL;
+    for (x = 1; x <= NUM_MIDI_PARTS; x++) {
+        busl[x] = new float[synth.buffersize];
+        busr[x] = new float[synth.buffersize];
+    }
 }
 
 OssMultiEngine :: ~OssMultiEngine()
@@ -68,6 +74,10 @@ OssMultiEngine :: ~OssMultiEngine()
     Stop();
     delete [] smps.ps32;
     delete [] peaks;
+    for (int x = 1; x <= NUM_MIDI_PARTS; x++) {
+        delete [] busl[x];
+        delete [] busr[x];
+    }
 }
 
     bool
@@ -225,25 +235,27 @@ OssMultiEngine :: audioThreadCb()
         int x;
         int y;
 
-        /* get next buffer */
+        /* get next buffer, with the buses of the "channels / 2" first
+         * channel pairs (the others fall back to the main mix) */
+        OutMgr::getInstance().setBuses(busl, busr, 1 + channels / 2);
         getNext();
 
-        /* extract audio from the "channels / 2" first parts */
         for (x = 0; x != channels; x += 2) {
-            Part *part = middleware->spawnMaster()->part[x / 2];
+            const float *outl = busl[1 + x / 2];
+            const float *outr = busr[1 + x / 2];
 
             if (is32bit) {
                 for (y = 0; y != synth.buffersize; y++) {
-                    float l = part->partoutl[y];
-                    float r = part->partoutr[y];
+                    float l = outl[y];
+                    float r = outr[y];
                     stereoCompressor(synth.samplerate, peaks[x/2], l, r);
                     smps.ps32[y * channels + x] = (int)(l * 2147483647.0f);
                     smps.ps32[y * channels + x + 1] = (int)(r * 2147483647.0f);
                 }
             } else {
                 for (y = 0; y != synth.buffersize; y++) {
-                    float l = part->partoutl[y];
-                    float r = part->partoutr[y];
+                    float l = outl[y];
+                    float r = outr[y];
                     stereoCompressor(synth.samplerate, peaks[x/2], l, r);
                     smps.ps16[y * channels + x] = (short int)(l * 32767.0f);
                     smps.ps16[y * channels + x + 1] = (short int)(r * 32767.0f);
@@ -57,6 +57,10 @@ class OssMultiEngine : public AudioOut
         /* peak values used for compressor */
         float *peaks;
 
+        /* output buses played by the channel pairs */
+        float *busl[NUM_MIDI_PARTS + 1];
+        float *busr[NUM_MIDI_PARTS + 1];
+
         bool en;
         bool is32bit;
 
@@ -18,6 +18,8 @@
 #include "EngineMgr.h"
 #include "InMgr.h"
 #include "WavEngine.h"
+#include "Nio.h"
+#include "../DSP/Resampler.h"
 #include "../Misc/Master.h"
 #include "../Misc/Util.h" //for set_realtime()
 using namespace std;
@@ -32,9 +34,10 @@ OutMgr &OutMgr::getInstance(const SYNTH_T *synth)
 
 OutMgr::OutMgr(const SYNTH_T *synth_)
     :wave(new WavEngine(*synth_)),
-      priBuf(new float[4096],
-             new float[4096]), priBuffCurrent(priBuf),
-      master(NULL), stales(0), synth(*synth_)
+      priBuf(new float[maxFrames],
+             new float[maxFrames]), priBuffCurrent(priBuf),
+      master(NULL), resampler(NULL, NULL), nbuses(0), stales(0),
+      synth(*synth_)
 {
     assert(synth_);
     currentOut = NULL;
@@ -49,6 +52,8 @@ OutMgr::OutMgr(const SYNTH_T *synth_)
 OutMgr::~OutMgr()
 {
     delete wave;
+    delete resampler.l;
+    delete resampler.r;
     delete [] priBuf.l;
     delete [] priBuf.r;
     delete [] outr;
@@ -67,21 +72,42 @@ OutMgr::~OutMgr()
 const Stereo<float *> OutMgr::tick(unsigned int frameSize)
 {
     InMgr &midi = InMgr::getInstance();
+    //The audio thread may belong to a library (jack, portaudio), so the
+    //mode is (re)applied here rather than when the thread is created
+    flush_denormals();
     //SysEv->execute();
     removeStaleSmps();
+    midi.startPeriod(frameSize, synth.samplerate);
+    //leftover samples are played before the first new buffer
+    const unsigned start = storedSmps();
+    master->transport.locate(start);
     int i=0;
     while(frameSize > storedSmps()) {
         if(!midi.empty()) {
-            midi.flush(i*synth.buffersize, (i+1)*synth.buffersize);
+            //events are split at the buffer boundaries and note ons start
+            //at their offset within the buffer
+            midi.flush(start + i*synth.buffersize,
+                       start + (i+1)*synth.buffersize);
         }
+        if(nbuses)
+            master->setBuses(busl, busr, nbuses, i*synth.buffersize);
         master->AudioOut(outl, outr);
         addSmps(outl, outr);
         i++;
     }
+    if(nbuses) {
+        master->setBuses(NULL, NULL, 0);
+        nbuses = 0;
+    }
     stales = frameSize;
     return priBuf;
 }
 
+void OutMgr::setTransport(float bpm, double beat, bool playing)
+{
+    master->transport.setHost(bpm, beat, playing);
+}
+
 AudioOut *OutMgr::getOut(string name)
 {
     return dynamic_cast<AudioOut *>(EngineMgr::getInstance().getEng(name));
@@ -135,21 +161,34 @@ void OutMgr::applyOscEventRt(const char *msg)
     master->applyOscEvent(msg);
 }
 
-//perform a cheap linear interpolation for resampling
-//This will result in some distortion at frame boundries
-//returns number of samples produced
-static size_t resample(float *dest,
-                       const float *src,
-                       float s_in,
-                       float s_out,
-                       size_t elms)
+void OutMgr::setOutputRate(AudioOut *out, int rate)
 {
-    size_t out_elms = elms * s_out / s_in;
-    float  r_pos    = 0.0f;
-    for(int i = 0; i < (int)out_elms; ++i, r_pos += s_in / s_out)
-        dest[i] = interpolate(src, elms, r_pos);
+    out->setSamplerate(rate);
+    if(out != currentOut)
+        return;
 
-    return out_elms;
+    //setSink() stops the previous output before starting this one, which
+    //does not tick until it returns, so no tick() uses the old filters
+    Stereo<Resampler *> old = resampler;
+    if(rate == (int)synth.samplerate)
+        resampler = Stereo<Resampler *>(NULL, NULL);
+    else
+        resampler = Stereo<Resampler *>(
+            new Resampler(synth.samplerate, rate, synth.buffersize,
+                          Nio::resampleQuality),
+            new Resampler(synth.samplerate, rate, synth.buffersize,
+                          Nio::resampleQuality));
+    delete old.l;
+    delete old.r;
+}
+
+void OutMgr::setBuses(float *const *l, float *const *r, int n)
+{
+    nbuses = min(n, NUM_OUT_BUSES);
+    for(int i = 0; i < nbuses; ++i) {
+        busl[i] = l[i];
+        busr[i] = r[i];
+    }
 }
 
 void OutMgr::addSmps(float *l, float *r)
@@ -157,16 +196,13 @@ void OutMgr::addSmps(float *l, float *r)
     //allow wave file to syphon off stream
     wave->push(Stereo<float *>(l, r), synth.buffersize);
 
-    const int s_out = currentOut->getSampleRate(),
-              s_sys = synth.samplerate;
+    const int s_out = currentOut->getSampleRate();
 
-    if(s_out != s_sys) { //we need to resample
-        const size_t steps = resample(priBuffCurrent.l,
-                                      l,
-                                      s_sys,
-                                      s_out,
-                                      synth.buffersize);
-        resample(priBuffCurrent.r, r, s_sys, s_out, synth.buffersize);
+    if(resampler.l && (int)resampler.l->dstRate() == s_out) {
+        //both channels produce the same number of samples
+        const int steps = resampler.l->process(l, synth.buffersize,
+                                               priBuffCurrent.l);
+        resampler.r->process(r, synth.buffersize, priBuffCurrent.r);
 
         priBuffCurrent.l += steps;
         priBuffCurrent.r += steps;
@@ -21,6 +21,7 @@
 namespace zyn {
 
 class AudioOut;
+class Resampler;
 struct SYNTH_T;
 class OutMgr
 {
@@ -28,6 +29,11 @@ class OutMgr
         static OutMgr &getInstance(const SYNTH_T *synth=NULL);
         ~OutMgr();
 
+        /**Frames a tick can hold, including the samples left over from the
+         * tick before (up to a buffer), so a period may not exceed
+         * maxFrames - buffersize*/
+        static const int maxFrames = 4096;
+
         /**Execute a tick*/
         const Stereo<float *> tick(unsigned int frameSize) REALTIME;
 
@@ -57,6 +63,23 @@ class OutMgr
 
         void setMaster(class Master *master_);
         void applyOscEventRt(const char *msg);
+
+        /**Report the host transport at the start of the next tick
+         * @param bpm tempo in beats per minute
+         * @param beat position in beats
+         * @param playing true if the transport is rolling*/
+        void setTransport(float bpm, double beat, bool playing) REALTIME;
+
+        /**Prepare the conversion to the sample rate of an output
+         * (called by the output while it is being started, before it calls
+         * tick() for the first time)*/
+        void setOutputRate(AudioOut *out, int rate) NONREALTIME;
+
+        /**Let the next tick write the output buses straight to the
+         * buffers of a multichannel driver (see Master::setBuses()).
+         * The driver must run at the synth's rate with a period that is a
+         * multiple of the buffer size.*/
+        void setBuses(float *const *l, float *const *r, int n) REALTIME;
     private:
         OutMgr(const SYNTH_T *synth);
         void addSmps(float *l, float *r);
@@ -75,6 +98,14 @@ class OutMgr
         float *outr;
         class Master *master;
 
+        //Conversion from the synth to the output sample rate
+        Stereo<Resampler *> resampler;
+
+        //Output buses of the next tick
+        float *busl[NUM_OUT_BUSES];
+        float *busr[NUM_OUT_BUSES];
+        int    nbuses;
+
         int stales;
         const SYNTH_T &synth;
 };
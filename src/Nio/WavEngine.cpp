@@ -13,6 +13,7 @@
 
 #include "WavEngine.h"
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <cstdlib>
 #include "../Misc/WavFile.h"
@@ -21,82 +22,174 @@ using namespace std;
 
 namespace zyn {
 
+WavTracks::WavTracks(const SYNTH_T &synth,
+                     const std::vector<WavFile *> &files_)
+    :files(files_),
+      //about four seconds of audio
+      slots(max(4u, 4 * synth.samplerate / synth.buffersize)),
+      stride(files.size() * 2 * synth.buffersize),
+      ring(new float[slots * stride]), ringFrames(new unsigned[slots]),
+      writePos(0), readPos(0)
+{
+    //check state
+    for(auto file:files)
+        if(!file->good())
+            cerr
+            << "ERROR: WavEngine handed bad file output WavEngine::newFile()"
+            << endl;
+}
+
+WavTracks::~WavTracks()
+{
+    for(auto file:files)
+        delete file;
+    delete [] ring;
+    delete [] ringFrames;
+}
+
 WavEngine::WavEngine(const SYNTH_T &synth_)
-    :AudioOut(synth_), file(NULL), buffer(synth.samplerate * 4), pThread(NULL)
+    :AudioOut(synth_), tracks(NULL), claimed(false), claimedSlot(NULL),
+      recording(false), overruns(0), quit(false)
 {
     work.init(PTHREAD_PROCESS_PRIVATE, 0);
+
+    //the writer thread is only started and joined here, so that starting
+    //and stopping a recording from the audio thread never waits for it
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+    pthread_create(&pThread, &attr, _AudioThread, this);
 }
 
 WavEngine::~WavEngine()
 {
     Stop();
+    quit = true;
+    work.post();
+    pthread_join(pThread, NULL);
     destroyFile();
 }
 
 bool WavEngine::openAudio()
 {
-    return file && file->good();
+    const WavTracks *t = tracks;
+    return t && !t->files.empty() && t->files[0]->good();
 }
 
 bool WavEngine::Start()
 {
-    if(pThread)
-        return true;
-    pThread = new pthread_t;
-
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-    pthread_create(pThread, &attr, _AudioThread, this);
-
+    recording = true;
     return true;
 }
 
 void WavEngine::Stop()
 {
-    if(!pThread)
+    recording = false;
+    //write out what was queued before the recording stopped
+    work.post();
+}
+
+//Get the slot of the buffer being recorded (NULL when the ring is full)
+float *WavEngine::claim(WavTracks *t)
+{
+    if(!claimed) {
+        claimed = true;
+        const unsigned w = t->writePos.load(std::memory_order_relaxed);
+        if(w - t->readPos.load(std::memory_order_acquire) >= t->slots) {
+            //the writer thread fell behind, drop this buffer
+            overruns++;
+            claimedSlot = NULL;
+        } else {
+            const unsigned stride = t->stride;
+            claimedSlot = t->ring + (w % t->slots) * stride;
+            //stems which are not captured this time stay silent
+            memset(claimedSlot + 2 * synth.buffersize, 0,
+                   (stride - 2 * synth.buffersize) * sizeof(float));
+        }
+    }
+    return claimedSlot;
+}
+
+void WavEngine::capture(int track, const float *l, const float *r,
+                        float gain)
+{
+    WavTracks *t = tracks.load(std::memory_order_relaxed);
+    if(!recording || !t || track <= 0 || track >= (int)t->files.size() || !l)
         return;
 
-    pthread_t *tmp = pThread;
-    pThread = NULL;
+    float *slot = claim(t);
+    if(!slot)
+        return;
 
-    work.post();
-    pthread_join(*tmp, NULL);
-    delete pThread;
+    slot += track * 2 * synth.buffersize;
+    for(int i = 0; i < synth.buffersize; ++i) {
+        slot[2 * i]     = l[i] * gain;
+        slot[2 * i + 1] = r[i] * gain;
+    }
 }
 
 void WavEngine::push(Stereo<float *> smps, size_t len)
 {
-    if(!pThread)
+    WavTracks *t = tracks.load(std::memory_order_relaxed);
+    if(!recording || !t)
         return;
 
-
-    //copy the input [overflow when needed]
-    for(size_t i = 0; i < len; ++i) {
-        buffer.push(*smps.l++);
-        buffer.push(*smps.r++);
+    //Longer pushes take several slots, the stems captured for them are
+    //recorded along with the first one
+    for(size_t done = 0; done < len;) {
+        float *slot = claim(t);
+        claimed = false;
+        const size_t n = min(len - done, (size_t)synth.buffersize);
+        if(slot) {
+            const unsigned w = t->writePos.load(std::memory_order_relaxed);
+            for(size_t i = 0; i < n; ++i) {
+                slot[2 * i]     = smps.l[done + i];
+                slot[2 * i + 1] = smps.r[done + i];
+            }
+            t->ringFrames[w % t->slots] = n;
+            t->writePos.store(w + 1, std::memory_order_release);
+        }
+        done += n;
     }
     work.post();
 }
 
 void WavEngine::newFile(WavFile *_file)
 {
-    //ensure system is clean
-    destroyFile();
-    file = _file;
+    newFiles(std::vector<WavFile *>(1, _file));
+}
 
-    //check state
-    if(!file->good())
-        cerr
-        << "ERROR: WavEngine handed bad file output WavEngine::newFile()"
-        << endl;
+void WavEngine::newFiles(const std::vector<WavFile *> &_files)
+{
+    closeTracks(swapTracks(newTracks(_files)));
+}
+
+WavTracks *WavEngine::newTracks(const std::vector<WavFile *> &_files) const
+{
+    return new WavTracks(synth, _files);
+}
+
+WavTracks *WavEngine::swapTracks(WavTracks *_tracks)
+{
+    claimed = false;
+    return tracks.exchange(_tracks, std::memory_order_acq_rel);
+}
+
+void WavEngine::closeTracks(WavTracks *_tracks)
+{
+    if(!_tracks)
+        return;
+    {
+        //once the writer thread lets go, it only sees the new tracks
+        std::lock_guard<std::mutex> lock(writing);
+        drain(_tracks);
+    }
+    delete _tracks;
 }
 
 void WavEngine::destroyFile()
 {
-    if(file)
-        delete file;
-    file = NULL;
+    closeTracks(swapTracks(NULL));
 }
 
 void *WavEngine::_AudioThread(void *arg)
@@ -104,28 +197,34 @@ void *WavEngine::_AudioThread(void *arg)
     return (static_cast<WavEngine *>(arg))->AudioThread();
 }
 
+void WavEngine::drain(WavTracks *t)
+{
+    unsigned r = t->readPos.load(std::memory_order_relaxed);
+    while(r != t->writePos.load(std::memory_order_acquire)) {
+        const unsigned s  = r % t->slots;
+        const float *slot = t->ring + s * t->stride;
+        for(unsigned i = 0; i < t->files.size(); ++i)
+            t->files[i]->writeStereoSamples(
+                t->ringFrames[s], slot + i * 2 * synth.buffersize);
+        t->readPos.store(++r, std::memory_order_release);
+    }
+}
 void *WavEngine::AudioThread()
 {
-    short *recordbuf_16bit = new short[2 * synth.buffersize];
-
-    while(!work.wait() && pThread) {
-        for(int i = 0; i < synth.buffersize; ++i) {
-            float left = 0.0f, right = 0.0f;
-            buffer.pop(left);
-            buffer.pop(right);
-            recordbuf_16bit[2 * i] = limit((int)(left * 32767.0f),
-                                           -32768,
-                                           32767);
-            recordbuf_16bit[2 * i + 1] = limit((int)(right * 32767.0f),
-                                               -32768,
-                                               32767);
+    unsigned reported = overruns;
+    while(!work.wait() && !quit) {
+        {
+            std::lock_guard<std::mutex> lock(writing);
+            if(WavTracks *t = tracks.load(std::memory_order_acquire))
+                drain(t);
+        }
+        if(overruns != reported) {
+            reported = overruns;
+            cerr << "WARNING: WavEngine dropped " << reported
+                 << " buffers, the disk is too slow" << endl;
         }
-        if(file)
-            file->writeStereoSamples(synth.buffersize, recordbuf_16bit);
     }
 
-    delete[] recordbuf_16bit;
-
     return NULL;
 }
 
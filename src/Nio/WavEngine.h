@@ -16,13 +16,40 @@
 #define WAVENGINE_H
 #include "AudioOut.h"
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include <pthread.h>
 #include "ZynSema.h"
-#include "SafeQueue.h"
 
 namespace zyn {
 
 class WavFile;
+
+/**The files of a recording along with the ring they are written from.
+ * Opening the files and allocating the ring is not realtime safe, so it
+ * is done by whoever hands the tracks to WavEngine::swapTracks(), and
+ * closing them is left to WavEngine::closeTracks().*/
+struct WavTracks {
+    /**Takes the files, the first of them being the master mix*/
+    WavTracks(const SYNTH_T &synth, const std::vector<WavFile *> &files);
+    /**Completes and closes the files*/
+    ~WavTracks();
+
+    std::vector<WavFile *> files;
+    unsigned  slots;
+    unsigned  stride;
+    float    *ring;
+    unsigned *ringFrames;
+    /* Single producer/single consumer ring of whole interleaved stereo
+     * buffers, one per track in each slot. WavEngine::push() and capture()
+     * fill slots from the audio thread and the writer thread empties them;
+     * both positions only ever grow, so the fill level is their
+     * difference. */
+    std::atomic<unsigned> writePos;
+    std::atomic<unsigned> readPos;
+};
+
 class WavEngine:public AudioOut
 {
     public:
@@ -30,15 +57,35 @@ class WavEngine:public AudioOut
         ~WavEngine();
 
         bool openAudio();
+        /**Start and stop recording (realtime safe, the writer thread runs
+         * as long as the engine)*/
         bool Start();
         void Stop();
 
         void setAudioEn(bool /*nval*/) {}
         bool getAudioEn() const {return true; }
 
+        /**Record the master mix and complete the current buffer
+         * (pushes longer than a buffer are split over several)*/
         void push(Stereo<float *> smps, size_t len);
+        /**Record one buffer of a stem (track 1 and up) for the buffer
+         * completed by the next push(); NULL input leaves it silent*/
+        void capture(int track, const float *l, const float *r,
+                     float gain = 1.0f);
 
         void newFile(WavFile *_file);
+        /**Record several tracks, the first of them being the master mix*/
+        void newFiles(const std::vector<WavFile *> &_files);
+        /**Set up tracks for swapTracks() (not realtime safe)*/
+        WavTracks *newTracks(const std::vector<WavFile *> &_files) const;
+        /**Record to tracks set up elsewhere (realtime safe)
+         * @returns the previous tracks (or NULL), which are to be handed to
+         *          closeTracks() outside of the audio thread*/
+        WavTracks *swapTracks(WavTracks *_tracks);
+        /**Write out what is left of tracks swapped out and close their
+         * files, waiting for the writer thread to be done with them (not
+         * realtime safe)*/
+        void closeTracks(WavTracks *_tracks);
         void destroyFile();
 
     protected:
@@ -46,11 +93,22 @@ class WavEngine:public AudioOut
         static void *_AudioThread(void *arg);
 
     private:
-        WavFile *file;
+        float *claim(WavTracks *t);
+        void drain(WavTracks *t);
+
         ZynSema  work;
-        SafeQueue<float> buffer;
 
-        pthread_t *pThread;
+        //Swapped by the audio thread, drained by the writer thread while
+        //it holds the lock
+        std::atomic<WavTracks *> tracks;
+        std::mutex writing;
+        bool     claimed;
+        float   *claimedSlot;
+        std::atomic<bool>     recording;
+        std::atomic<unsigned> overruns;
+
+        std::atomic<bool> quit;
+        pthread_t  pThread;
 };
 
 }
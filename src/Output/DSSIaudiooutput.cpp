@@ -33,11 +33,16 @@ const char *instance_name = 0;
 
 namespace zyn {
 class WavFile;
+struct WavTracks;
 namespace Nio {
     bool start(void){return 1;};
     void stop(void){};
     void masterSwap(zyn::Master *){};
     void waveNew(WavFile *){}
+    WavTracks *waveOpen(const vector<WavFile *> &){return NULL;}
+    void waveClose(WavTracks *){}
+    WavTracks *waveSwap(WavTracks *){return NULL;}
+    void waveCapture(int, const float *, const float *, float){}
     void waveStart(void){}
     void waveStop(void){}
     void waveEnd(void){}
@@ -425,6 +430,7 @@ void DSSIaudiooutput::runSynth(unsigned long sample_count,
     unsigned long next_event_frame = 0;
     unsigned long to_frame = 0;
 
+    const zyn::DenormalGuard denormals;
     zyn::Master *master = middleware->spawnMaster();
 
     // forward all dssi control values to the middleware
@@ -405,9 +405,10 @@ void FilterParams::defaults()
 void FilterParams::defaults(int n)
 {
     int j = n;
+    prng_t state = 0x1234 + n; //the same vowels for every new filter
 
     for(int i = 0; i < FF_MAX_FORMANTS; ++i) {
-        Pvowels[j].formants[i].freq = (int)(RND * 127.0f); //some random freqs
+        Pvowels[j].formants[i].freq = (int)(prng_float(state) * 127.0f); //some random freqs
         Pvowels[j].formants[i].q    = 64;
         Pvowels[j].formants[i].amp  = 127;
     }
@@ -20,6 +20,7 @@
 #include "../Synth/OscilGen.h"
 #include "../Misc/WavFile.h"
 #include "../Misc/Time.h"
+#include "../Misc/Util.h"
 #include <cstdio>
 #include <thread>
 
@@ -894,6 +895,9 @@ int PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
     for(int nsample = 0; nsample < samplemax; ++nsample)
         adj[nsample] = (Pquality.oct + 1.0f) * (float)nsample / samplemax;
 
+    //the threads only read the resonance response
+    resonance->updatecurve();
+
     const PADnoteParameters* this_c = this;
 
     auto thread_cb = [basefreq, bwadjust, &cb, do_abort,
@@ -901,6 +905,8 @@ int PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
                       &adj, &profile, this_c](
                       unsigned nthreads, unsigned threadno)
     {
+        flush_denormals();
+
         //prepare a BIG IFFT
         FFTwrapper *fft      = new FFTwrapper(samplesize);
         fft_t      *fftfreqs = new fft_t[samplesize / 2];
@@ -932,8 +938,11 @@ int PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
             newsample.smp = new float[samplesize + extra_samples];
 
             newsample.smp[0] = 0.0f;
+            //the phases only depend on the sample, not on the thread
+            prng_t state = 0x1234 + nsample;
             for(int i = 1; i < spectrumsize; ++i) //randomize the phases
-                fftfreqs[i] = FFTpolar(spectrum[i], (float)RND * 2 * PI);
+                fftfreqs[i] = FFTpolar(spectrum[i],
+                                       prng_float(state) * 2 * PI);
             //that's all; here is the only ifft for the whole sample;
             //no windows are used ;-)
             fft->freqs2smps(fftfreqs, newsample.smp);
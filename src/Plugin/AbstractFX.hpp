@@ -30,6 +30,7 @@
 #include "Params/FilterParams.h"
 #include "Effects/Effect.h"
 #include "Misc/Allocator.h"
+#include "Misc/Util.h"
 #include "zyn-version.h"
 
 /* ------------------------------------------------------------------------------------------------------------
@@ -168,6 +169,8 @@ protected:
     */
     void run(const float** inputs, float** outputs, uint32_t frames) override
     {
+        const zyn::DenormalGuard denormals;
+
         if (outputs[0] != inputs[0])
             copyWithMultiply(outputs[0], inputs[0], 0.5f, frames);
         else
@@ -122,6 +122,7 @@ public:
             synth.buffersize = 32;
 
         synth.alias();
+        setLatency(synth.buffersize);
 
         _initMaster();
 
@@ -349,6 +350,18 @@ protected:
             mutex.lock();
         }
 
+        const zyn::DenormalGuard denormals;
+
+        // follow the host tempo and position for synced effects
+        const TimePosition& timePos(getTimePosition());
+        if (timePos.bbt.valid)
+        {
+            const double beat = (timePos.bbt.bar - 1) * (double)timePos.bbt.beatsPerBar
+                              + (timePos.bbt.beat - 1)
+                              + timePos.bbt.tick / timePos.bbt.ticksPerBeat;
+            master->transport.setHost(timePos.bbt.beatsPerMinute, beat, timePos.playing);
+        }
+
         uint32_t framesOffset = 0;
 
         for (uint32_t i=0; i<midiEventCount; ++i)
@@ -384,7 +397,7 @@ protected:
                 const char note = static_cast<char>(midiEvent.data[1]);
                 const char velo = static_cast<char>(midiEvent.data[2]);
 
-                master->noteOn(channel, note, velo);
+                master->noteOn(channel, note, velo, master->callbackOffset());
             } break;
 
             case 0xA0: {
@@ -456,6 +469,7 @@ protected:
             synth.buffersize = 32;
 
         synth.alias();
+        setLatency(synth.buffersize);
 
         _initMaster();
         mwss.updateMiddleWare(middleware);
@@ -593,6 +607,7 @@ END_NAMESPACE_DISTRHO
 
 namespace zyn {
 class WavFile;
+struct WavTracks;
 namespace Nio {
    void masterSwap(zyn::Master*){}
    bool setSource(std::string){return true;}
@@ -602,6 +617,10 @@ namespace Nio {
    std::string getSource(void){return "";}
    std::string getSink(void){return "";}
    void waveNew(WavFile*){}
+   WavTracks *waveOpen(const std::vector<WavFile*>&){return NULL;}
+   void waveClose(WavTracks*){}
+   WavTracks *waveSwap(WavTracks*){return NULL;}
+   void waveCapture(int, const float*, const float*, float){}
    void waveStart(){}
    void waveStop(){}
 }
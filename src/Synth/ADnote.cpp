@@ -45,8 +45,6 @@ ADnote::ADnote(ADnoteParameters *pars_, SynthParams &spars,
     NoteEnabled = ON;
     basefreq    = spars.frequency;
     velocity    = spars.velocity;
-    initial_seed = spars.seed;
-    current_prng_state = spars.seed;
     stereo = pars.GlobalPar.PStereo;
 
     NoteGlobalPar.Detune = getdetune(pars.GlobalPar.PDetuneType,
@@ -107,7 +105,7 @@ void ADnote::setupVoice(int nvoice)
     for (int i = 0; i < 14; i++)
         pinking[nvoice][i] = 0.0;
 
-    param.OscilSmp->newrandseed(prng());
+    param.OscilSmp->newrandseed(getRandomUint());
     voice.OscilSmp = NULL;
     voice.FMSmp    = NULL;
     voice.VoiceOut = NULL;
@@ -166,7 +164,7 @@ void ADnote::setupVoice(int nvoice)
     if(pars.VoicePar[nvoice].Pextoscil != -1)
         vc = pars.VoicePar[nvoice].Pextoscil;
     if(!pars.GlobalPar.Hrandgrouping)
-        pars.VoicePar[vc].OscilSmp->newrandseed(prng());
+        pars.VoicePar[vc].OscilSmp->newrandseed(getRandomUint());
     int oscposhi_start =
         pars.VoicePar[vc].OscilSmp->get(NoteVoicePar[nvoice].OscilSmp,
                 getvoicebasefreq(nvoice),
@@ -201,7 +199,7 @@ void ADnote::setupVoice(int nvoice)
         oscposhi[nvoice][k] = kth_start % synth.oscilsize;
         //put random starting point for other subvoices
         kth_start      = oscposhi_start +
-            (int)(RND * pars.VoicePar[nvoice].Unison_phase_randomness /
+            (int)(getRandomFloat() * pars.VoicePar[nvoice].Unison_phase_randomness /
                     127.0f * (synth.oscilsize - 1));
     }
 
@@ -280,7 +278,7 @@ int ADnote::setupVoiceUnison(int nvoice)
                      float min = -1e-6, max = 1e-6;
                      for(int k = 0; k < true_unison; ++k) {
                          float step = (k / (float) (true_unison - 1)) * 2.0f - 1.0f; //this makes the unison spread more uniform
-                         float val  = step + (RND * 2.0f - 1.0f) / (true_unison - 1);
+                         float val  = step + (getRandomFloat() * 2.0f - 1.0f) / (true_unison - 1);
                          unison_values[k] = val;
                          if (min > val) {
                              min = val;
@@ -322,12 +320,12 @@ int ADnote::setupVoiceUnison(int nvoice)
     const float vib_speed = pars.VoicePar[nvoice].Unison_vibratto_speed / 127.0f;
     const float vibratto_base_period  = 0.25f * powf(2.0f, (1.0f - vib_speed) * 4.0f);
     for(int k = 0; k < unison; ++k) {
-        unison_vibratto[nvoice].position[k] = RND * 1.8f - 0.9f;
+        unison_vibratto[nvoice].position[k] = getRandomFloat() * 1.8f - 0.9f;
         //make period to vary randomly from 50% to 200% vibratto base period
         const float vibratto_period = vibratto_base_period
-            * powf(2.0f, RND * 2.0f - 1.0f);
+            * powf(2.0f, getRandomFloat() * 2.0f - 1.0f);
 
-        const float m = (RND < 0.5f ? -1.0f : 1.0f) *
+        const float m = (getRandomFloat() < 0.5f ? -1.0f : 1.0f) *
             4.0f / (vibratto_period * increments_per_second);
         unison_vibratto[nvoice].step[k] = m;
 
@@ -364,7 +362,7 @@ int ADnote::setupVoiceUnison(int nvoice)
                 break;
             case 1:
                 for(int k = 0; k < unison; ++k)
-                    unison_invert_phase[nvoice][k] = (RND > 0.5f);
+                    unison_invert_phase[nvoice][k] = (getRandomFloat() > 0.5f);
                 break;
             default:
                 for(int k = 0; k < unison; ++k)
@@ -446,7 +444,7 @@ void ADnote::setupVoiceMod(int nvoice, bool first_run)
 
     //Triggers when a user enables modulation on a running voice
     if(!first_run && voice.FMEnabled != NONE && voice.FMSmp == NULL && voice.FMVoice < 0) {
-        param.FMSmp->newrandseed(prng());
+        param.FMSmp->newrandseed(getRandomUint());
         voice.FMSmp = memory.valloc<float>(synth.oscilsize + OSCIL_SMP_EXTRA_SAMPLES);
         memset(voice.FMSmp, 0, sizeof(float)*(synth.oscilsize + OSCIL_SMP_EXTRA_SAMPLES));
         int vc = nvoice;
@@ -460,7 +458,7 @@ void ADnote::setupVoiceMod(int nvoice, bool first_run)
             tmp = getFMvoicebasefreq(nvoice);
 
         if(!pars.GlobalPar.Hrandgrouping)
-            pars.VoicePar[vc].FMSmp->newrandseed(prng());
+            pars.VoicePar[vc].FMSmp->newrandseed(getRandomUint());
 
         for(int k = 0; k < unison_size[nvoice]; ++k)
             oscposhiFM[nvoice][k] = (oscposhi[nvoice][k]
@@ -730,7 +728,7 @@ void ADnote::legatonote(LegatoParams lpars)
         /* Voice Modulation Parameters Init */
         if((NoteVoicePar[nvoice].FMEnabled != NONE)
            && (NoteVoicePar[nvoice].FMVoice < 0)) {
-            pars.VoicePar[nvoice].FMSmp->newrandseed(prng());
+            pars.VoicePar[nvoice].FMSmp->newrandseed(getRandomUint());
 
             //Perform Anti-aliasing only on MIX or RING MODULATION
 
@@ -739,7 +737,7 @@ void ADnote::legatonote(LegatoParams lpars)
                 vc = pars.VoicePar[nvoice].PextFMoscil;
 
             if(!pars.GlobalPar.Hrandgrouping)
-                pars.VoicePar[vc].FMSmp->newrandseed(prng());
+                pars.VoicePar[vc].FMSmp->newrandseed(getRandomUint());
 
             for(int i = 0; i < OSCIL_SMP_EXTRA_SAMPLES; ++i)
                 NoteVoicePar[nvoice].FMSmp[synth.oscilsize + i] =
@@ -834,7 +832,7 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
     NoteGlobalPar.initparameters(pars.GlobalPar, synth,
                                  time,
                                  memory, basefreq, velocity,
-                                 stereo, wm, prefix);
+                                 stereo, getRandomUint(), wm, prefix);
 
     NoteGlobalPar.AmpEnvelope->envout_dB(); //discard the first envelope output
     globalnewamplitude = NoteGlobalPar.Volume
@@ -879,7 +877,8 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
         }
 
         if(param.PAmpLfoEnabled) {
-            vce.AmpLfo = memory.alloc<LFO>(*param.AmpLfo, basefreq, time, wm,
+            vce.AmpLfo = memory.alloc<LFO>(*param.AmpLfo, basefreq, time,
+                    getRandomUint(), wm,
                     (pre+"VoicePar"+nvoice+"/AmpLfo/").c_str);
             newamplitude[nvoice] *= vce.AmpLfo->amplfoout();
         }
@@ -891,7 +890,8 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
                     (pre+"VoicePar"+nvoice+"/FreqEnvelope/").c_str);
 
         if(param.PFreqLfoEnabled)
-            vce.FreqLfo = memory.alloc<LFO>(*param.FreqLfo, basefreq, time, wm,
+            vce.FreqLfo = memory.alloc<LFO>(*param.FreqLfo, basefreq, time,
+                    getRandomUint(), wm,
                     (pre+"VoicePar"+nvoice+"/FreqLfo/").c_str);
 
         /* Voice Filter Parameters Init */
@@ -911,7 +911,8 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
             }
 
             if(param.PFilterLfoEnabled) {
-                vce.FilterLfo = memory.alloc<LFO>(*param.FilterLfo, basefreq, time, wm,
+                vce.FilterLfo = memory.alloc<LFO>(*param.FilterLfo, basefreq, time,
+                    getRandomUint(), wm,
                         (pre+"VoicePar"+nvoice+"/FilterLfo/").c_str);
                 vce.Filter->addMod(*vce.FilterLfo);
             }
@@ -919,7 +920,7 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
 
         /* Voice Modulation Parameters Init */
         if((vce.FMEnabled != NONE) && (vce.FMVoice < 0)) {
-            param.FMSmp->newrandseed(prng());
+            param.FMSmp->newrandseed(getRandomUint());
             vce.FMSmp = memory.valloc<float>(synth.oscilsize + OSCIL_SMP_EXTRA_SAMPLES);
 
             //Perform Anti-aliasing only on MIX or RING MODULATION
@@ -935,7 +936,7 @@ void ADnote::initparameters(WatchManager *wm, const char *prefix)
                 tmp = getFMvoicebasefreq(nvoice);
 
             if(!pars.GlobalPar.Hrandgrouping)
-                pars.VoicePar[vc].FMSmp->newrandseed(prng());
+                pars.VoicePar[vc].FMSmp->newrandseed(getRandomUint());
 
             for(int k = 0; k < unison_size[nvoice]; ++k)
                 oscposhiFM[nvoice][k] = (oscposhi[nvoice][k]
@@ -1551,8 +1552,9 @@ inline void ADnote::ComputeVoiceWhiteNoise(int nvoice)
 {
     for(int k = 0; k < unison_size[nvoice]; ++k) {
         float *tw = tmpwave_unison[k];
+        prng_fill(current_prng_state, tw, synth.buffersize);
         for(int i = 0; i < synth.buffersize; ++i)
-            tw[i] = RND * 2.0f - 1.0f;
+            tw[i] = tw[i] * 2.0f - 1.0f;
     }
 }
 
@@ -1561,8 +1563,9 @@ inline void ADnote::ComputeVoicePinkNoise(int nvoice)
     for(int k = 0; k < unison_size[nvoice]; ++k) {
         float *tw = tmpwave_unison[k];
         float *f = &pinking[nvoice][k > 0 ? 7 : 0];
+        prng_fill(current_prng_state, tw, synth.buffersize);
         for(int i = 0; i < synth.buffersize; ++i) {
-            float white = (RND-0.5)/4.0;
+            float white = (tw[i]-0.5)/4.0;
             f[0] = 0.99886*f[0]+white*0.0555179;
             f[1] = 0.99332*f[1]+white*0.0750759;
             f[2] = 0.96900*f[2]+white*0.1538520;
@@ -1592,8 +1595,8 @@ inline void ADnote::ComputeVoiceDC(int nvoice)
  */
 int ADnote::noteout(float *outl, float *outr)
 {
-    memcpy(outl, synth.denormalkillbuf, synth.bufferbytes);
-    memcpy(outr, synth.denormalkillbuf, synth.bufferbytes);
+    memset(outl, 0, synth.bufferbytes);
+    memset(outr, 0, synth.bufferbytes);
 
     if(NoteEnabled == OFF)
         return 0;
@@ -1964,18 +1967,21 @@ void ADnote::Global::initparameters(const ADnoteGlobalParam &param,
                                     class Allocator &memory,
                                     float basefreq, float velocity,
                                     bool stereo,
+                                    prng_t seed,
                                     WatchManager *wm,
                                     const char *prefix)
 {
     ScratchString pre = prefix;
     FreqEnvelope = memory.alloc<Envelope>(*param.FreqEnvelope, basefreq,
             synth.dt(), wm, (pre+"GlobalPar/FreqEnvelope/").c_str);
-    FreqLfo      = memory.alloc<LFO>(*param.FreqLfo, basefreq, time, wm,
+    FreqLfo      = memory.alloc<LFO>(*param.FreqLfo, basefreq, time,
+                   prng(seed), wm,
                    (pre+"GlobalPar/FreqLfo/").c_str);
 
     AmpEnvelope = memory.alloc<Envelope>(*param.AmpEnvelope, basefreq,
             synth.dt(), wm, (pre+"GlobalPar/AmpEnvelope/").c_str);
-    AmpLfo      = memory.alloc<LFO>(*param.AmpLfo, basefreq, time, wm,
+    AmpLfo      = memory.alloc<LFO>(*param.AmpLfo, basefreq, time,
+                   prng(seed), wm,
                    (pre+"GlobalPar/AmpLfo/").c_str);
 
     Volume = 4.0f * powf(0.1f, 3.0f * (1.0f - param.PVolume / 96.0f)) //-60 dB .. 0 dB
@@ -1986,7 +1992,8 @@ void ADnote::Global::initparameters(const ADnoteGlobalParam &param,
 
     FilterEnvelope = memory.alloc<Envelope>(*param.FilterEnvelope, basefreq,
             synth.dt(), wm, (pre+"GlobalPar/FilterEnvelope/").c_str);
-    FilterLfo      = memory.alloc<LFO>(*param.FilterLfo, basefreq, time, wm,
+    FilterLfo      = memory.alloc<LFO>(*param.FilterLfo, basefreq, time,
+                   prng(seed), wm,
                    (pre+"GlobalPar/FilterLfo/").c_str);
 
     Filter->addMod(*FilterEnvelope);
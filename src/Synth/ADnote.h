@@ -127,6 +127,7 @@ class ADnote:public SynthNote
                                 class Allocator &memory,
                                 float basefreq, float velocity,
                                 bool stereo,
+                                prng_t seed,
                                 WatchManager *wm,
                                 const char *prefix);
             /******************************************
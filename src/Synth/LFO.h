@@ -16,6 +16,7 @@
 
 #include "../globals.h"
 #include "../Misc/Time.h"
+#include "../Misc/Util.h"
 #include "WatchPoint.h"
 
 namespace zyn {
@@ -28,9 +29,10 @@ class LFO
          *
          * @param lfopars pointer to a LFOParams object
          * @param basefreq base frequency of LFO
+         * @param seed seed of the random phase, amplitude and frequency
          */
-        LFO(const LFOParams &lfopars, float basefreq, const AbsTime &t, WatchManager *m=0,
-                const char *watch_prefix=0);
+        LFO(const LFOParams &lfopars, float basefreq, const AbsTime &t,
+                prng_t seed, WatchManager *m=0, const char *watch_prefix=0);
         ~LFO();
 
         float lfoout();
@@ -55,6 +57,8 @@ class LFO
         //Amount Randomness
         float lfornd, lfofreqrnd;
 
+        prng_t prng_state;
+
         //Delay before starting
         RelTime delayTime;
 
@@ -1045,11 +1045,11 @@ short int OscilGen::get(float *smps, float freqHz, int resonance)
 
     fft_t *input = freqHz > 0.0f ? oscilFFTfreqs : pendingfreqs;
 
-    unsigned int realrnd = prng();
-    sprng(randseed);
+    //The randomness of a note only depends on its seed (see newrandseed())
+    prng_t state = randseed;
 
     int outpos =
-        (int)((RND * 2.0f
+        (int)((prng_float(state) * 2.0f
                - 1.0f) * synth.oscilsize_f * (Prand - 64.0f) / 64.0f);
     outpos = (outpos + 2 * synth.oscilsize) % synth.oscilsize;
 
@@ -1088,7 +1088,7 @@ short int OscilGen::get(float *smps, float freqHz, int resonance)
         const float rnd = PI * powf((Prand - 64.0f) / 64.0f, 2.0f);
         for(int i = 1; i < nyquist - 1; ++i) //to Nyquist only for AntiAliasing
             outoscilFFTfreqs[i] *=
-                FFTpolar<fftw_real>(1.0f, (float)(rnd * i * RND));
+                FFTpolar<fftw_real>(1.0f, (float)(rnd * i * prng_float(state)));
     }
 
     //Harmonic Amplitude Randomness
@@ -1101,12 +1101,13 @@ short int OscilGen::get(float *smps, float freqHz, int resonance)
                 power = power * 2.0f - 0.5f;
                 power = powf(15.0f, power);
                 for(int i = 1; i < nyquist - 1; ++i)
-                    outoscilFFTfreqs[i] *= powf(RND, power) * normalize;
+                    outoscilFFTfreqs[i] *= powf(prng_float(state), power)
+                                           * normalize;
                 break;
             case 2:
                 power = power * 2.0f - 0.5f;
                 power = powf(15.0f, power) * 2.0f;
-                float rndfreq = 2 * PI * RND;
+                float rndfreq = 2 * PI * prng_float(state);
                 for(int i = 1; i < nyquist - 1; ++i)
                     outoscilFFTfreqs[i] *= powf(fabs(sinf(i * rndfreq)), power)
                                            * normalize;
@@ -1128,8 +1129,6 @@ short int OscilGen::get(float *smps, float freqHz, int resonance)
             smps[i] *= 0.25f;                     //correct the amplitude
     }
 
-    sprng(realrnd + 1);
-
     if(Prand < 64)
         return outpos;
     else
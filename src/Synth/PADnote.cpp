@@ -101,7 +101,7 @@ void PADnote::setup(float freq,
 
 
     if(!legato) { //not sure
-        poshi_l = (int)(RND * (size - 1));
+        poshi_l = (int)(getRandomFloat() * (size - 1));
         if(pars.PStereo)
             poshi_r = (poshi_l + size / 2) % size;
         else
@@ -111,7 +111,7 @@ void PADnote::setup(float freq,
 
 
     if(pars.PPanning == 0)
-        NoteGlobalPar.Panning = RND;
+        NoteGlobalPar.Panning = getRandomFloat();
     else
         NoteGlobalPar.Panning = pars.PPanning / 128.0f;
 
@@ -142,14 +142,14 @@ void PADnote::setup(float freq,
                     wm, (pre+"FreqEnvelope/").c_str);
         NoteGlobalPar.FreqLfo      =
             memory.alloc<LFO>(*pars.FreqLfo, basefreq, time,
-                    wm, (pre+"FreqLfo/").c_str);
+                    getRandomUint(), wm, (pre+"FreqLfo/").c_str);
 
         NoteGlobalPar.AmpEnvelope =
             memory.alloc<Envelope>(*pars.AmpEnvelope, basefreq, synth.dt(),
                     wm, (pre+"AmpEnvelope/").c_str);
         NoteGlobalPar.AmpLfo      =
             memory.alloc<LFO>(*pars.AmpLfo, basefreq, time,
-                    wm, (pre+"AmpLfo/").c_str);
+                    getRandomUint(), wm, (pre+"AmpLfo/").c_str);
     }
 
     NoteGlobalPar.Volume = 4.0f
@@ -176,7 +176,7 @@ void PADnote::setup(float freq,
         env = memory.alloc<Envelope>(*pars.FilterEnvelope, basefreq,
                 synth.dt(), wm, (pre+"FilterEnvelope/").c_str);
         lfo = memory.alloc<LFO>(*pars.FilterLfo, basefreq, time,
-                wm, (pre+"FilterLfo/").c_str);
+                getRandomUint(), wm, (pre+"FilterLfo/").c_str);
         flt->addMod(*env);
         flt->addMod(*lfo);
     }
@@ -11,8 +11,10 @@
   of the License, or (at your option) any later version.
 */
 
+#include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include "Resonance.h"
 #include "../Misc/Util.h"
 
@@ -23,12 +25,13 @@ using namespace rtosc;
 namespace zyn {
 
 #define rObject Resonance
+#undef  rChangeCb
+#define rChangeCb obj->curvechanged();
 #define rBegin [](const char *msg, RtData &d) { rObject &o = *(rObject*)d.obj
 #define rEnd }
 
-const rtosc::Ports Resonance::ports = {
+const rtosc::Ports Resonance::non_realtime_ports = {
     rSelf(Resonance),
-    rPaste,
     rToggle(Penabled,      rShort("enable"), rDefault(false),
             "resonance enable"),
     rToggle(Pprotectthefundamental, rShort("p.fund."), rDefault(false),
@@ -61,6 +64,7 @@ const rtosc::Ports Resonance::ports = {
                 if(ival.type == 'f')
                     o.Prespoints[i++] = ival.val.f*127;
             }
+            o.curvechanged();
         } else {
             rtosc_arg_t args[N_RES_POINTS];
             char        types[N_RES_POINTS+1] = {0};
@@ -72,17 +76,37 @@ const rtosc::Ports Resonance::ports = {
         }
         rEnd},
 };
+
+const rtosc::Ports Resonance::realtime_ports = {
+    rPaste,
+    {"curve-data:b", rProp(internal) rProp(realtime) rProp(pointer)
+        rDoc("Sets prepared response curve"), NULL,
+        rBegin;
+        assert(rtosc_argument(msg, 0).b.len == sizeof(void*));
+        d.reply("/free", "sb", "Resonance::curve", sizeof(void*), &o.curve);
+        o.curve = *(float**)rtosc_argument(msg, 0).b.data;
+        rEnd},
+};
+
+const rtosc::MergePorts Resonance::ports{
+    &Resonance::realtime_ports,
+    &Resonance::non_realtime_ports
+};
 #undef rBegin
 #undef rEnd
+#undef rChangeCb
 
 Resonance::Resonance():Presets()
 {
     setpresettype("Presonance");
+    curve = new float[N_RES_CURVE];
     defaults();
 }
 
 Resonance::~Resonance(void)
-{}
+{
+    delete[] curve;
+}
 
 
 void Resonance::defaults(void)
@@ -96,6 +120,10 @@ void Resonance::defaults(void)
     ctlbw     = 1.0f;
     for(int i = 0; i < N_RES_POINTS; ++i)
         Prespoints[i] = 64;
+    //all points at the same value are a flat response
+    for(int i = 0; i < N_RES_CURVE; ++i)
+        curve[i] = 1.0f;
+    curvedirty = false;
 }
 
 /*
@@ -106,6 +134,51 @@ void Resonance::setpoint(int n, unsigned char p)
     if((n < 0) || (n >= N_RES_POINTS))
         return;
     Prespoints[n] = p;
+    curvechanged();
+}
+
+/*
+ * Tabulate the response of the resonance function
+ *
+ * The points are interpolated linearly in dB, so the gain is exact on the
+ * grid and the linear interpolation between grid steps stays well below
+ * the resolution of the points.
+ */
+void Resonance::computecurve(float *dst) const
+{
+    //Provide an upper bound for resonance
+    const float upper =
+        limit<float>(array_max(Prespoints, N_RES_POINTS), 1.0f, INFINITY);
+
+    float dB[N_RES_POINTS];
+    for(int i = 0; i < N_RES_POINTS; ++i)
+        dB[i] = (Prespoints[i] - upper) / 127.0f * PmaxdB;
+
+    for(int i = 0; i < N_RES_CURVE; ++i) {
+        const int   k  = i / RES_OVERSAMPLE;
+        const float dx = (i % RES_OVERSAMPLE) / (float)RES_OVERSAMPLE;
+        const float y  = (k + 1 < N_RES_POINTS) ?
+                         dB[k] * (1.0f - dx) + dB[k + 1] * dx : dB[k];
+        dst[i] = dB2rap(y);
+    }
+}
+
+void Resonance::updatecurve(void)
+{
+    if(!curvedirty)
+        return;
+    computecurve(curve);
+    curvedirty = false;
+}
+
+float *Resonance::preparecurve(void)
+{
+    if(!curvedirty)
+        return NULL;
+    float *data = new float[N_RES_CURVE];
+    computecurve(data);
+    curvedirty = false;
+    return data;
 }
 
 /*
@@ -116,24 +189,34 @@ void Resonance::applyres(int n, fft_t *fftdata, float freq) const
     if(Penabled == 0)
         return;             //if the resonance is disabled
 
-    const float l1  = logf(getfreqx(0.0f) * ctlcenter),
-                l2  = logf(2.0f) * getoctavesfreq() * ctlbw;
-
-    //Provide an upper bound for resonance
-    const float upper =
-        limit<float>(array_max(Prespoints, N_RES_POINTS), 1.0f, (float)INFINITY);
-
+    //The harmonics are increasing in frequency, so rather than computing the
+    //position of each one on the graph the frequency of the curve steps is
+    //walked alongside them
+    //(the step ratio is small enough to interpolate in frequency)
+    const double step = exp(logf(2.0f) * getoctavesfreq() * ctlbw
+                            / (N_RES_POINTS * RES_OVERSAMPLE));
+    const double f0   = getfreqx(0.0f) * ctlcenter;
+
+    int    k     = 0;
+    double fk    = f0;
+    double fnext = f0 * step;
     for(int i = 1; i < n; ++i) {
-        //compute where the n-th hamonics fits to the graph
-        const float x  = limit((logf(freq*i) - l1) / l2, 0.0f, (float)INFINITY) * N_RES_POINTS;
-        const float dx = x - floor(x);
-        const int kx1  = limit<int>(floor(x), 0, N_RES_POINTS - 1);
-        const int kx2  = limit<int>(kx1 + 1,  0, N_RES_POINTS - 1);
-        float y =
-            ((Prespoints[kx1] * (1.0f - dx) + Prespoints[kx2] * dx)
-             - upper) / 127.0f;
+        const double f = (double)freq * i;
+        while(k < N_RES_CURVE - 1 && fnext <= f) {
+            ++k;
+            fk     = fnext;
+            fnext *= step;
+        }
 
-        y = powf(10.0f, y * PmaxdB / 20.0f);
+        float y;
+        if(f <= f0)
+            y = curve[0];
+        else if(k == N_RES_CURVE - 1)
+            y = curve[k];
+        else {
+            const float dx = (f - fk) / (fnext - fk);
+            y = curve[k] + (curve[k + 1] - curve[k]) * dx;
+        }
 
         if((Pprotectthefundamental != 0) && (i == 1))
             y = 1.0f;
@@ -154,19 +237,14 @@ float Resonance::getfreqresponse(float freq) const
     const float l1 = logf(getfreqx(0.0f) * ctlcenter),
                 l2 = logf(2.0f) * getoctavesfreq() * ctlbw;
 
-    //Provide an upper bound for resonance
-    const float upper =
-        limit<float>(array_max(Prespoints, N_RES_POINTS), 1.0f, INFINITY);
-
     //compute where the n-th hamonics fits to the graph
-    const float x   = limit((logf(freq) - l1) / l2, 0.0f, (float)INFINITY) * N_RES_POINTS;
+    const float x   = limit((logf(freq) - l1) / l2 * N_RES_POINTS, 0.0f,
+                            N_RES_POINTS - 1.0f) * RES_OVERSAMPLE;
     const float dx  = x - floor(x);
-    const int   kx1 = limit<int>(floor(x), 0, N_RES_POINTS - 1);
-    const int   kx2 = limit<int>(kx1 + 1,  0, N_RES_POINTS - 1);
+    const int   kx1 = limit<int>(floor(x), 0, N_RES_CURVE - 1);
+    const int   kx2 = limit<int>(kx1 + 1,  0, N_RES_CURVE - 1);
     //Interpolate
-    const float result =
-        ((Prespoints[kx1] * (1.0f - dx) + Prespoints[kx2] * dx) - upper) / 127.0f;
-    return powf(10.0f, result * PmaxdB / 20.0f);
+    return curve[kx1] * (1.0f - dx) + curve[kx2] * dx;
 }
 
 
@@ -187,6 +265,7 @@ void Resonance::smooth(void)
         if(Prespoints[i] > 127)
             Prespoints[i] = 127;
     }
+    curvechanged();
 }
 
 /*
@@ -209,8 +288,9 @@ void Resonance::randomize(int type)
 
 void Resonance::zero(void)
 {
-    for(int i=0; i<N_RES_POINTS; ++i) 
-        setpoint(i,64);
+    for(int i=0; i<N_RES_POINTS; ++i)
+        Prespoints[i] = 64;
+    curvechanged();
 }
 
 /*
@@ -231,6 +311,7 @@ void Resonance::interpolatepeaks(int type)
             x1 = i;
             y1 = y2;
         }
+    curvechanged();
 }
 
 /*
@@ -287,6 +368,9 @@ void Resonance::paste(Resonance &r)
 
     COPY(ctlcenter);
     COPY(ctlbw);
+    //called by the realtime side, the copy is cheap unlike a new curve
+    memcpy(curve, r.curve, N_RES_CURVE * sizeof(float));
+    COPY(curvedirty);
 }
 #undef COPY
 
@@ -325,6 +409,8 @@ void Resonance::getfromXML(XMLwrapper& xml)
         Prespoints[i] = xml.getpar127("val", Prespoints[i]);
         xml.exitbranch();
     }
+    curvechanged();
+    updatecurve();
 }
 
 }
@@ -20,6 +20,9 @@
 #include "../DSP/FFTwrapper.h"
 
 #define N_RES_POINTS 256
+//Steps of the tabulated response between two resonance points
+#define RES_OVERSAMPLE 8
+#define N_RES_CURVE ((N_RES_POINTS - 1) * RES_OVERSAMPLE + 1)
 
 namespace zyn {
 
@@ -34,6 +37,17 @@ class Resonance:public Presets
         void interpolatepeaks(int type);
         void randomize(int type);
         void zero(void);
+        //Mark the response curve as outdated, needed after changing the
+        //parameters
+        void curvechanged(void) {curvedirty = true; }
+        //Recompute the response curve in place if it is outdated
+        //Only for objects the realtime side does not read (PADsynth and
+        //objects being loaded), as applyres() and getfreqresponse() never
+        //update the curve themselves
+        void updatecurve(void);
+        //New response curve for the realtime side or NULL if it is up to
+        //date, it is sent to the curve-data port which frees the old one
+        float *preparecurve(void);
 
         void paste(Resonance &r);
         void add2XML(XMLwrapper& xml);
@@ -60,7 +74,16 @@ class Resonance:public Presets
         float ctlcenter; //center frequency(relative)
         float ctlbw; //bandwidth(relative)
 
-        static const rtosc::Ports ports;
+        static const rtosc::MergePorts ports;
+        static const rtosc::Ports      non_realtime_ports;
+        static const rtosc::Ports      realtime_ports;
+    private:
+        void computecurve(float *dst) const;
+
+        //Linear gain of the resonance function, sampled RES_OVERSAMPLE times
+        //between the points (the controllers only move the frequency axis)
+        float *curve;
+        bool   curvedirty;
 };
 
 }
@@ -103,7 +103,7 @@ void SUBnote::setup(float freq,
     if(pars.PPanning != 0)
         panning = pars.PPanning / 127.0f;
     else
-        panning = RND;
+        panning = getRandomFloat();
 
     if(!legato) { //normal note
         numstages = pars.Pnumstages;
@@ -288,9 +288,9 @@ void SUBnote::initfilter(bpfilter &filter,
         }
         else {
             float a = 0.1f * mag; //empirically
-            float p = RND * 2.0f * PI;
+            float p = getRandomFloat() * 2.0f * PI;
             if(start == 1)
-                a *= RND;
+                a *= getRandomFloat();
             filter.yn1 = a * cosf(p);
             filter.yn2 = a * cosf(p + freq * 2.0f * PI / synth.samplerate_f);
 
@@ -503,8 +503,9 @@ void SUBnote::chanOutput(float *out, bpfilter *bp, int buffer_size)
     float tmpsmp[buffer_size];
 
     //Initialize Random Input
+    prng_fill(current_prng_state, tmprnd, buffer_size);
     for(int i = 0; i < buffer_size; ++i)
-        tmprnd[i] = RND * 2.0f - 1.0f;
+        tmprnd[i] = tmprnd[i] * 2.0f - 1.0f;
 
     //For each harmonic apply the filter on the random input stream
     //Sum the filter outputs to obtain the output signal
@@ -525,8 +526,8 @@ void SUBnote::chanOutput(float *out, bpfilter *bp, int buffer_size)
  */
 int SUBnote::noteout(float *outl, float *outr)
 {
-    memcpy(outl, synth.denormalkillbuf, synth.bufferbytes);
-    memcpy(outr, synth.denormalkillbuf, synth.bufferbytes);
+    memset(outl, 0, synth.bufferbytes);
+    memset(outr, 0, synth.bufferbytes);
 
     if(!NoteEnabled)
         return 0;
@@ -10,8 +10,10 @@
   of the License, or (at your option) any later version.
 */
 #include "SynthNote.h"
+#include "../Misc/Allocator.h"
 #include "../Misc/Util.h"
 #include "../globals.h"
+#include <algorithm>
 #include <cstring>
 #include <new>
 #include <iostream>
@@ -21,8 +23,35 @@ namespace zyn {
 SynthNote::SynthNote(SynthParams &pars)
     :memory(pars.memory),
     legato(pars.synth, pars.frequency, pars.velocity, pars.portamento,
-            pars.note, pars.quiet, pars.seed), ctl(pars.ctl), synth(pars.synth), time(pars.time)
-{}
+            pars.note, pars.quiet, pars.seed),
+    initial_seed(pars.seed), current_prng_state(pars.seed),
+    offset(limit(pars.offset, 0, pars.synth.buffersize - 1)),
+    carryl(NULL), carryr(NULL),
+    ctl(pars.ctl), synth(pars.synth), time(pars.time)
+{
+    if(offset) {
+        carryl = memory.valloc<float>(offset);
+        carryr = memory.valloc<float>(offset);
+    }
+}
+
+SynthNote::~SynthNote()
+{
+    memory.devalloc(carryl);
+    memory.devalloc(carryr);
+}
+
+void SynthNote::applyoffset(float *outl, float *outr)
+{
+    if(!offset)
+        return;
+    const int n = synth.buffersize;
+    //[head, tail] -> [carry, head] with tail becoming the next carry
+    std::rotate(outl, outl + n - offset, outl + n);
+    std::rotate(outr, outr + n - offset, outr + n);
+    std::swap_ranges(outl, outl + offset, carryl);
+    std::swap_ranges(outr, outr + offset, carryr);
+}
 
 SynthNote::Legato::Legato(const SYNTH_T &synth_, float freq, float vel, int port,
                           int note, bool quiet, prng_t seed)
@@ -168,8 +197,7 @@ float SynthNote::getRandomFloat() {
 }
 
 prng_t SynthNote::getRandomUint() {
-    current_prng_state = prng_r(current_prng_state);
-    return current_prng_state;
+    return prng(current_prng_state);
 }
 
 }
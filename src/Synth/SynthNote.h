@@ -30,6 +30,7 @@ struct SynthParams
     int       note;      //Integer value of the note
     bool      quiet;     //Initial output condition for legato notes
     prng_t    seed;      //Random seed
+    int       offset;    //Sample within the first buffer where the note starts
 };
 
 struct LegatoParams
@@ -46,7 +47,7 @@ class SynthNote
 {
     public:
         SynthNote(SynthParams &pars);
-        virtual ~SynthNote() {}
+        virtual ~SynthNote();
 
         /**Compute Output Samples
          * @return 0 if note is finished*/
@@ -67,6 +68,11 @@ class SynthNote
 
         virtual SynthNote *cloneLegato(void) = 0;
 
+        /**Delay the output of noteout() by the start offset of the note
+         * (the samples pushed past the end of the buffer are carried over)*/
+        void applyoffset(float *outl, float *outr);
+        int getoffset() const {return offset; }
+
         /* For polyphonic aftertouch needed */
         void setVelocity(float velocity_);
 
@@ -117,6 +123,9 @@ class SynthNote
 
         prng_t initial_seed;
         prng_t current_prng_state;
+        //Start offset and the samples carried over to the next buffer
+        int    offset;
+        float *carryl, *carryr;
         const Controller &ctl;
         const SYNTH_T    &synth;
         const AbsTime    &time;
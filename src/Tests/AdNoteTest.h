@@ -18,6 +18,7 @@
 #include <fstream>
 #include <ctime>
 #include <string>
+#include <vector>
 #include "../Misc/Master.h"
 #include "../Misc/Util.h"
 #include "../Misc/Allocator.h"
@@ -91,7 +92,9 @@ class AdNoteTest:public CxxTest::TestSuite
             //lets go with.... 50! as a nice note
             testnote = 50;
             float freq = 440.0f * powf(2.0f, (testnote - 69.0f) / 12.0f);
-            SynthParams pars{memory, *controller, *synth, *time, freq, 120, 0, testnote, false, prng()};
+            //a fixed seed, so that the output does not depend on what the
+            //thread drew before
+            SynthParams pars{memory, *controller, *synth, *time, freq, 120, 0, testnote, false, 0x1234};
 
             note = new ADnote(defaultPreset, pars);
 
@@ -124,26 +127,29 @@ class AdNoteTest:public CxxTest::TestSuite
 #endif
             sampleCount += synth->buffersize;
 
-            TS_ASSERT_DELTA(outL[255], 0.2555f, 0.0001f);
+            //The expected values were read from a run of this test (define
+            //WRITE_OUTPUT to dump the whole note). They have to be taken again
+            //whenever the note draws its random numbers in another order.
+            TS_ASSERT_DELTA(outL[255], 0.1053f, 0.0001f);
 
             note->releasekey();
 
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.4688f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], -0.1958f, 0.0001f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.0613f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], 0.0087f, 0.0001f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.0971f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], 0.0035f, 0.0001f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.0901f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], 0.0247f, 0.0001f);
 
             while(!note->finished()) {
                 note->noteout(outL, outR);
@@ -161,6 +167,47 @@ class AdNoteTest:public CxxTest::TestSuite
             TS_ASSERT_EQUALS(sampleCount, 9472);
         }
 
+        //Output of a note started at offset within its first buffer
+        vector<float> render(int offset, int buffers) {
+            const float freq = 440.0f * powf(2.0f, (testnote - 69.0f) / 12.0f);
+            SynthParams pars{memory, *controller, *synth, *time, freq, 120, 0,
+                             testnote, false, 0x1234, offset};
+            ADnote note(defaultPreset, pars);
+            vector<float> smps;
+            for(int n = 0; n < buffers; ++n) {
+                if(n == buffers / 2)
+                    note.releasekey();
+                note.noteout(outL, outR);
+                note.applyoffset(outL, outR);
+                smps.insert(smps.end(), outL, outL + synth->buffersize);
+            }
+            return smps;
+        }
+
+        //A note started at offset k plays the same samples k later, across
+        //the buffer boundaries
+        void testOffset() {
+            const int bs = synth->buffersize;
+            const vector<float> ref = render(0, 8);
+            const int offsets[] = {1, 100, bs - 1};
+            for(int k:offsets) {
+                const vector<float> smps = render(k, 8);
+                int zeros = 0, diffs = 0;
+                for(int i = 0; i < k; ++i)
+                    zeros += smps[i] == 0.0f;
+                for(int i = k; i < 8 * bs; ++i)
+                    diffs += smps[i] != ref[i - k];
+                TS_ASSERT_EQUALS(zeros, k);
+                TS_ASSERT_EQUALS(diffs, 0);
+            }
+
+            //offsets past the buffer start at its last sample
+            const vector<float> late = render(bs + 10, 2);
+            TS_ASSERT_EQUALS(late[bs - 2], 0.0f);
+            TS_ASSERT_EQUALS(late[bs - 1], ref[0]);
+            TS_ASSERT_EQUALS(late[bs], ref[1]);
+        }
+
 #define OUTPUT_PROFILE
 #ifdef OUTPUT_PROFILE
         void testSpeed() {
@@ -0,0 +1,275 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  BankDbTest.h - CxxTest for Misc/BankDb
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../Misc/BankDb.h"
+#include "../Misc/XMLwrapper.h"
+#include "../globals.h"
+using namespace std;
+using namespace zyn;
+
+SYNTH_T *synth;
+
+static vector<string> split(const string &s, char sep = ' ')
+{
+    vector<string> res;
+    string word;
+    for(char c:s + sep) {
+        if(c != sep)
+            word += c;
+        else if(!word.empty()) {
+            res.push_back(word);
+            word.clear();
+        }
+    }
+    return res;
+}
+
+//Names of the entries found, sorted unless the ranking is checked
+static string names(const BankDb::rvec &found, bool sorted = true)
+{
+    vector<string> n;
+    for(auto e:found)
+        n.push_back(e->name);
+    if(sorted)
+        sort(n.begin(), n.end());
+    string res;
+    for(auto &s:n)
+        res += (res.empty() ? "" : ",") + s;
+    return res;
+}
+
+//Wait for the changes to be applied, calling update() as MiddleWare::tick()
+//does
+static bool settle(BankDb &db)
+{
+    for(int i = 0; i < 500; ++i) {
+        if(db.update())
+            return true;
+        usleep(10000);
+    }
+    return false;
+}
+
+class BankDbTest:public CxxTest::TestSuite
+{
+    public:
+        void setUp() {
+            char tmp[] = "/tmp/zyn-bank-XXXXXX";
+            root = string(mkdtemp(tmp)) + "/";
+            //the index file is written to the home directory
+            const char *home = getenv("HOME");
+            oldHome = home ? home : "";
+            setenv("HOME", root.c_str(), 1);
+            created.push_back(root + ".zynaddsubfx-bank-index");
+            makeDir("bank");
+        }
+
+        void tearDown() {
+            setenv("HOME", oldHome.c_str(), 1);
+            for(auto itr = created.rbegin(); itr != created.rend(); ++itr)
+                remove(itr->c_str());
+            rmdir(root.c_str());
+            created.clear();
+        }
+
+        void makeDir(const string &dir) {
+            mkdir((root + dir).c_str(), 0755);
+            created.push_back(root + dir);
+        }
+
+        //Write an instrument with one kit item
+        void write(const string &file, const string &author,
+                   const string &comments, int type, bool add = true,
+                   bool pad = false, bool sub = false) {
+            XMLwrapper xml;
+            xml.beginbranch("INSTRUMENT");
+            xml.beginbranch("INFO");
+            xml.addparstr("author", author);
+            xml.addparstr("comments", comments);
+            xml.addpar("type", type);
+            xml.endbranch();
+            xml.beginbranch("INSTRUMENT_KIT");
+            xml.beginbranch("INSTRUMENT_KIT_ITEM", 0);
+            xml.addparbool("add_enabled", add);
+            xml.addparbool("sub_enabled", sub);
+            xml.addparbool("pad_enabled", pad);
+            xml.endbranch();
+            xml.endbranch();
+            xml.endbranch();
+            xml.saveXMLfile(root + file, 0);
+            if(find(created.begin(), created.end(), root + file)
+               == created.end())
+                created.push_back(root + file);
+        }
+
+        //Instruments written, added and removed after a scan are followed
+        void testScanUpdate() {
+            write("bank/0001-Church Organ.xiz", "alice", "warm", 3);
+            write("bank/0002-Strings.xiz", "bob", "", 6);
+            BankDb db;
+            db.addRootDir(root);
+            db.addBankDir(root + "bank/");
+            db.scanBanks();
+            TS_ASSERT_EQUALS(names(db.search("")), "Church Organ,Strings");
+            TS_ASSERT_EQUALS(names(db.search("alice")), "Church Organ");
+            TS_ASSERT(!access(created[0].c_str(), F_OK));
+            TS_ASSERT(!db.update());
+
+#ifdef __linux__
+            write("bank/0002-Strings.xiz", "carol", "", 6);
+            TS_ASSERT(settle(db));
+            TS_ASSERT_EQUALS(names(db.search("bob")), "");
+            TS_ASSERT_EQUALS(names(db.search("carol")), "Strings");
+
+            write("bank/0003-Bells.xiz", "alice", "", 2);
+            TS_ASSERT(settle(db));
+            TS_ASSERT_EQUALS(names(db.search("alice")), "Bells,Church Organ");
+
+            remove((root + "bank/0001-Church Organ.xiz").c_str());
+            TS_ASSERT(settle(db));
+            TS_ASSERT_EQUALS(names(db.search("")), "Bells,Strings");
+
+            //a bank added to the root directory
+            makeDir("more");
+            write("more/0001-Choir.xiz", "dave", "", 7);
+            TS_ASSERT(settle(db));
+            TS_ASSERT_EQUALS(names(db.search("")), "Bells,Choir,Strings");
+            TS_ASSERT(!db.update());
+#endif
+
+            //a new scan reads the same from the index file
+            BankDb again;
+            again.addBankDir(root + "bank/");
+            again.addBankDir(root + "more/");
+            again.scanBanks();
+            TS_ASSERT_EQUALS(names(again.search("")), names(db.search("")));
+            TS_ASSERT_EQUALS(names(again.search("carol")),
+                             names(db.search("carol")));
+        }
+
+        //A burst of changes is read and indexed at once by a worker, the
+        //caller never waits for it
+        void testBurst() {
+#ifdef __linux__
+            write("bank/0001-Church Organ.xiz", "alice", "", 3);
+            BankDb db;
+            db.addBankDir(root + "bank/");
+            db.scanBanks();
+            for(int i = 2; i <= 40; ++i) {
+                char file[64];
+                snprintf(file, sizeof(file), "bank/%04d-Bell %d.xiz", i, i);
+                write(file, "bob", "", 2);
+            }
+            //nothing is applied while the changes keep coming
+            TS_ASSERT(!db.update());
+            TS_ASSERT_EQUALS(db.search("bob").size(), 0u);
+
+            TS_ASSERT(settle(db));
+            TS_ASSERT_EQUALS(db.search("bob").size(), 39u);
+            TS_ASSERT_EQUALS(db.search("").size(), 40u);
+            //one rebuild took them all
+            usleep(500000);
+            TS_ASSERT(!db.update());
+            usleep(500000);
+            TS_ASSERT(!db.update());
+#endif
+        }
+
+        //The index finds what matching every string did before
+        void testSearchMatch() {
+            makeDir("Pads");
+            write("bank/0001-Church Organ.xiz", "Alice Smith",
+                  "warm, full-bodied pipes", 3);
+            write("bank/0002-Strings.xiz", "bob", "slow attack", 6, false,
+                  true);
+            write("bank/0003-E-Piano.xiz", "alice", "Rhodes-like", 1);
+            write("bank/0004-Bells (FM).xiz", "dave", "metallic/bright", 2,
+                  false, false, true);
+            write("bank/0005-Organ 2.xiz", "", "", 3, true, false, true);
+            write("bank/0010-x.xiz", "Zed", "C++ test 100%", 0);
+            write("Pads/0001-Pad Strings.xiz", "carol",
+                  "lush pad; e-piano layer", 12, false, true, true);
+            write("Pads/0002-Sweep.xiz", "carol", "", 13, true, true);
+            BankDb db;
+            db.addBankDir(root + "bank/");
+            db.addBankDir(root + "Pads/");
+            db.scanBanks();
+            const BankDb::rvec all = db.search("");
+            TS_ASSERT_EQUALS(all.size(), 8u);
+
+            const char *queries[] = {
+                "o", "or", "organ", "ORGAN", "gan", "organ 2", "pad", "pads/",
+                "#pad", "#sub", "#add", "#pad strings", "#sub organ", "e-piano",
+                "e-", "-", "(fm)", "fm)", "c++", "100%", "alice", "lic smi",
+                ".xiz", "0005", "05-o", "/", "warm, full", "full-bodied",
+                "slow attack", "a e i", "zzz", "r", "s t r"};
+            for(const char *q:queries) {
+                string expected;
+                const BankDb::rvec found = db.search(q);
+                for(auto e:all) {
+                    bool match = true;
+                    for(auto &k:split(q))
+                        match &= e->match(k);
+                    if(match)
+                        expected += e->bank + e->file + "\n";
+                }
+                string got;
+                for(auto e:found)
+                    got += e->bank + e->file + "\n";
+                vector<string> g = split(got, '\n');
+                sort(g.begin(), g.end());
+                got.clear();
+                for(auto &s:g)
+                    got += s + "\n";
+                TS_ASSERT_EQUALS(got, expected);
+            }
+            TS_ASSERT_EQUALS(names(db.search("#pad")),
+                             "Pad Strings,Strings,Sweep");
+            TS_ASSERT_EQUALS(names(db.search("#sub organ")), "Organ 2");
+        }
+
+        //Keywords rank by the field they are found in and by matching at
+        //the start of a word, ties stay in bank and file order
+        void testRanking() {
+            write("bank/0001-Flute.xiz", "", "an organ like tone", 0);
+            write("bank/0002-Reed.xiz", "Organist", "", 0);
+            write("bank/0003-Barorgan.xiz", "", "", 0);
+            write("bank/0004-Organ.xiz", "", "", 0);
+            write("bank/0005-Pipe.xiz", "", "", 3); //an organ
+            write("bank/0006-Flute 2.xiz", "", "", 0);
+            BankDb db;
+            db.addBankDir(root + "bank/");
+            db.scanBanks();
+            const string order = "Organ,Barorgan,Reed,Pipe,Flute";
+            TS_ASSERT_EQUALS(names(db.search("organ"), false), order);
+            TS_ASSERT_EQUALS(names(db.search("org"), false), order);
+            TS_ASSERT_EQUALS(names(db.search("ORGAN #add"), false), order);
+            //the ranks of the keywords add up
+            TS_ASSERT_EQUALS(names(db.search("organ flute"), false), "Flute");
+            //without a match at the start of a word the tie stays in order
+            TS_ASSERT_EQUALS(names(db.search("gan"), false),
+                             "Barorgan,Organ,Reed,Pipe,Flute");
+            TS_ASSERT_EQUALS(names(db.search("flute"), false),
+                             "Flute,Flute 2");
+        }
+
+    private:
+        string root, oldHome;
+        vector<string> created; //files and directories, removed in reverse
+};
@@ -0,0 +1,339 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  BatchRender.cpp - Parallel Instrument/Song Renderer and Profiler
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+/*
+ * Renders a fixed note script through every given instrument (.xiz) or
+ * song (.xmz), with one independent Master per worker thread.
+ *
+ * For each input <out>/<name>.wav holds the rendered audio (32 bit float)
+ * and <out>/<name>.json the load times and the cost of each buffer. The
+ * name is the path of the input with the directory separators replaced by
+ * '_', and a number appended if another input already has that name.
+ *
+ * usage: batch-render [-j threads] [-o outdir] FILE|DIR...
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <rtosc/thread-link.h>
+
+#include "../Misc/Master.h"
+#include "../Misc/MiddleWare.h"
+#include "../Misc/Part.h"
+#include "../Misc/Config.h"
+#include "../Misc/WavFile.h"
+#include "../Misc/Util.h"
+#include "../Misc/Allocator.h"
+#include "../globals.h"
+using namespace std;
+using namespace zyn;
+
+// for linking purposes only:
+MiddleWare *middleware = 0;
+char *instance_name=(char*)"";
+
+//The note script: an arpeggio over two octaves, then a held chord
+struct ScriptNote {
+    float start, length; //seconds
+    int   note;
+};
+
+static const ScriptNote script[] = {
+    {0.0f, 0.4f, 48}, {0.5f, 0.4f, 55}, {1.0f, 0.4f, 60},
+    {1.5f, 0.4f, 64}, {2.0f, 0.4f, 67}, {2.5f, 0.4f, 72},
+    {3.0f, 1.5f, 48}, {3.0f, 1.5f, 60}, {3.0f, 1.5f, 64}, {3.0f, 1.5f, 67},
+};
+#define SCRIPT_NOTES    (sizeof(script) / sizeof(script[0]))
+#define SCRIPT_VELOCITY 100
+//rendered length including the release tail
+#define SCRIPT_SECONDS  6.5f
+
+struct Report {
+    bool   ok;
+    double load, apply, render; //seconds of wall time
+    float  peak;
+    unsigned long long memory;
+    vector<double> cost;        //us per buffer
+};
+
+static double seconds_since(chrono::steady_clock::time_point t)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - t).count();
+}
+
+static bool has_suffix(const string &s, const char *suffix)
+{
+    const size_t n = strlen(suffix);
+    return s.size() >= n && !strcasecmp(s.c_str() + s.size() - n, suffix);
+}
+
+static void collect(const string &path, vector<string> &files)
+{
+    struct stat st;
+    if(stat(path.c_str(), &st))
+        return;
+    if(!S_ISDIR(st.st_mode)) {
+        if(has_suffix(path, ".xiz") || has_suffix(path, ".xmz"))
+            files.push_back(path);
+        return;
+    }
+
+    DIR *dir = opendir(path.c_str());
+    if(!dir)
+        return;
+    vector<string> entries;
+    while(dirent *e = readdir(dir))
+        if(e->d_name[0] != '.')
+            entries.push_back(path + "/" + e->d_name);
+    closedir(dir);
+
+    sort(entries.begin(), entries.end());
+    for(auto &e:entries)
+        collect(e, files);
+}
+
+//Flatten a path into an output name
+static string outname(string path)
+{
+    while(path.compare(0, 2, "./") == 0)
+        path.erase(0, 2);
+    path.erase(path.rfind('.'));
+    for(auto &c:path)
+        if(c == '/' || c == '\\' || c == ' ')
+            c = '_';
+    return path;
+}
+
+//Output names of all inputs; flattening may map several paths
+//(a/b_c.xiz, a_b/c.xiz, a_b_c.xmz) to one name, so the later ones are
+//numbered
+static vector<string> outnames(const vector<string> &files)
+{
+    vector<string> names;
+    set<string>    taken;
+    for(auto &file:files) {
+        const string base = outname(file);
+        string name = base;
+        for(int n = 2; taken.count(name); ++n)
+            name = base + "-" + to_string(n);
+        if(name != base)
+            fprintf(stderr, "%s is written as %s\n", file.c_str(),
+                    name.c_str());
+        taken.insert(name);
+        names.push_back(name);
+    }
+    return names;
+}
+
+//Answer the requests a MiddleWare would answer
+static void drain(Master &master, rtosc::ThreadLink &bToU)
+{
+    while(bToU.hasNext()) {
+        const char *msg = bToU.read();
+        if(!strcmp(msg, "/request-memory")) {
+            const size_t N = 5 * 1024 * 1024;
+            master.memory->addMemory(malloc(N), N);
+            master.pendingMemory = false;
+        }
+    }
+}
+
+static Report render(const string &file, const SYNTH_T &synth, Config &config,
+                     WavFile &wav)
+{
+    Report r{false, 0, 0, 0, 0.0f, 0, {}};
+    rtosc::ThreadLink bToU(4096 * 2, 1024);
+    Master *master = new Master(synth, &config);
+    master->bToU = &bToU;
+
+    auto t = chrono::steady_clock::now();
+    const bool song = has_suffix(file, ".xmz");
+    if(song ? master->loadXML(file.c_str()) < 0
+            : master->part[0]->loadXMLinstrument(file.c_str()) < 0) {
+        delete master;
+        return r;
+    }
+    r.load = seconds_since(t);
+
+    t = chrono::steady_clock::now();
+    master->applyparameters();
+    master->initialize_rt();
+    r.apply = seconds_since(t);
+
+    const int   buffers = SCRIPT_SECONDS * synth.samplerate / synth.buffersize;
+    float      *outl    = new float[synth.buffersize];
+    float      *outr    = new float[synth.buffersize];
+    float      *frames  = new float[2 * synth.buffersize];
+    r.cost.reserve(buffers);
+
+    t = chrono::steady_clock::now();
+    for(int b = 0; b < buffers; ++b) {
+        const int pos = b * synth.buffersize;
+        auto tb = chrono::steady_clock::now();
+        for(unsigned i = 0; i < SCRIPT_NOTES; ++i) {
+            const int on  = script[i].start * synth.samplerate;
+            const int off = (script[i].start + script[i].length)
+                            * synth.samplerate;
+            if(on >= pos && on < pos + synth.buffersize)
+                master->noteOn(0, script[i].note, SCRIPT_VELOCITY, on - pos);
+            if(off >= pos && off < pos + synth.buffersize)
+                master->noteOff(0, script[i].note);
+        }
+        master->AudioOut(outl, outr);
+        r.cost.push_back(seconds_since(tb) * 1e6);
+
+        for(int i = 0; i < synth.buffersize; ++i) {
+            frames[2 * i]     = outl[i];
+            frames[2 * i + 1] = outr[i];
+            r.peak = max(r.peak, max(fabsf(outl[i]), fabsf(outr[i])));
+        }
+        wav.writeStereoSamples(synth.buffersize, frames);
+        drain(*master, bToU);
+    }
+    r.render = seconds_since(t);
+    r.memory = master->memory->totalAlloced();
+    r.ok     = true;
+
+    delete [] outl;
+    delete [] outr;
+    delete [] frames;
+    delete master;
+    return r;
+}
+
+static string json_string(const string &s)
+{
+    string out = "\"";
+    for(char c:s) {
+        if(c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void write_report(const string &name, const string &file,
+                         const SYNTH_T &synth, Report &r)
+{
+    FILE *f = fopen(name.c_str(), "w");
+    if(!f)
+        return;
+    fprintf(f, "{\n  \"file\": %s,\n  \"ok\": %s", json_string(file).c_str(),
+            r.ok ? "true" : "false");
+    if(r.ok) {
+        const double audio = r.cost.size() * synth.buffersize_f
+                             / synth.samplerate_f;
+        double total = 0;
+        for(double c:r.cost)
+            total += c;
+        vector<double> sorted = r.cost;
+        sort(sorted.begin(), sorted.end());
+        fprintf(f, ",\n  \"load_seconds\": %f,\n  \"apply_seconds\": %f,\n"
+                "  \"render_seconds\": %f,\n  \"audio_seconds\": %f,\n"
+                "  \"realtime_factor\": %f,\n  \"peak\": %f,\n"
+                "  \"rt_memory_bytes\": %llu,\n"
+                "  \"buffer_us\": {\"budget\": %f, \"mean\": %f, \"p50\": %f,"
+                " \"p99\": %f, \"max\": %f}",
+                r.load, r.apply, r.render, audio,
+                r.render > 0 ? audio / r.render : 0, r.peak, r.memory,
+                synth.dt() * 1e6, total / sorted.size(),
+                sorted[sorted.size() / 2], sorted[sorted.size() * 99 / 100],
+                sorted.back());
+    }
+    fprintf(f, "\n}\n");
+    fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+    int    threads = thread::hardware_concurrency();
+    string outdir  = ".";
+    int    opt;
+    while((opt = getopt(argc, argv, "j:o:")) != -1) {
+        switch(opt) {
+            case 'j':
+                threads = atoi(optarg);
+                break;
+            case 'o':
+                outdir = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-j threads] [-o outdir] "
+                        "FILE|DIR...\n", argv[0]);
+                return 1;
+        }
+    }
+
+    vector<string> files;
+    for(int i = optind; i < argc; ++i)
+        collect(argv[i], files);
+    if(files.empty()) {
+        fprintf(stderr, "Please supply .xiz/.xmz files or directories\n");
+        return 1;
+    }
+    threads = max(1, min(threads, (int)files.size()));
+    const vector<string> names = outnames(files);
+
+    SYNTH_T synth;
+    synth.buffersize = 256;
+    synth.samplerate = 48000;
+    synth.alias();
+
+    //Masters only read the configuration, bank scanning is skipped
+    Config config;
+    for(auto &dir:config.cfg.bankRootDirList)
+        dir.clear();
+    config.cfg.currentBankDir.clear();
+
+    atomic<unsigned> next(0), failed(0);
+    auto worker = [&]() {
+        flush_denormals();
+        for(unsigned i; (i = next++) < files.size();) {
+            const string name = outdir + "/" + names[i];
+            Report r;
+            {
+                WavFile wav(name + ".wav", synth.samplerate, 2,
+                            WavFile::Float32);
+                r = render(files[i], synth, config, wav);
+            }
+            if(!r.ok) {
+                unlink((name + ".wav").c_str());
+                failed++;
+            }
+            write_report(name + ".json", files[i], synth, r);
+            printf("%s %s\n", r.ok ? "OK    " : "FAILED", files[i].c_str());
+        }
+    };
+
+    auto t = chrono::steady_clock::now();
+    vector<thread> pool;
+    for(int i = 0; i < threads; ++i)
+        pool.emplace_back(worker);
+    for(auto &th:pool)
+        th.join();
+
+    printf("Rendered %u files on %d threads in %fs (%u failed)\n",
+           (unsigned)files.size(), threads, seconds_since(t),
+           (unsigned)failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  DenormalTest.h - CxxTest for denormal free processing
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <thread>
+#include "../Misc/Allocator.h"
+#include "../Misc/Util.h"
+#include "../Misc/XMLwrapper.h"
+#include "../Misc/Time.h"
+#include "../Misc/MiddleWare.h"
+#include "../Misc/Master.h"
+#include "../Effects/EffectMgr.h"
+#include "../Params/ADnoteParameters.h"
+#include "../Params/PADnoteParameters.h"
+#include "../Params/SUBnoteParameters.h"
+#include "../Params/Controller.h"
+#include "../Synth/ADnote.h"
+#include "../Synth/SUBnote.h"
+#include "../DSP/FFTwrapper.h"
+#include "../Nio/Nio.h"
+#include "../Nio/OutMgr.h"
+#include "../globals.h"
+#include "../UI/NSM.H"
+using namespace zyn;
+
+SYNTH_T *synth;
+NSM_Client *nsm = 0;
+MiddleWare *middleware = 0;
+
+char *instance_name=(char*)"";
+
+//True if the calling thread flushes denormals to zero
+static bool flushing()
+{
+    volatile float tiny = 1e-30f;
+    return tiny * 1e-10f == 0.0f;
+}
+
+#ifndef SOURCE_DIR
+#define SOURCE_DIR "BE QUIET COMPILER"
+#endif
+
+class DenormalTest:public CxxTest::TestSuite
+{
+    public:
+        void setUp() {
+            synth = new SYNTH_T;
+            synth->buffersize = 256;
+            synth->alias();
+            outL = new float[synth->buffersize];
+            outR = new float[synth->buffersize];
+            time = new AbsTime(*synth);
+            fft  = new FFTwrapper(synth->oscilsize);
+            controller = new Controller(*synth, time);
+        }
+
+        void tearDown() {
+            delete controller;
+            delete fft;
+            delete time;
+            delete [] outL;
+            delete [] outR;
+            delete synth;
+        }
+
+        bool subnormal(const float *smps) {
+            for(int i = 0; i < synth->buffersize; ++i)
+                if(std::fpclassify(smps[i]) == FP_SUBNORMAL)
+                    return true;
+            return false;
+        }
+
+        //The threads start with the mode of this one, which never flushes
+        //denormals itself
+        void testThreadStart() {
+            TS_ASSERT(!flushing());
+            bool flushed = true;
+            std::thread([&]() {flushed = flushing(); }).join();
+            TS_ASSERT(!flushed);
+        }
+
+        //The plugins (DPF run(), DSSI runSynth()) render in a scope of
+        //DenormalGuard within the thread of the host
+        void testGuard() {
+            bool before = true, inside = false, nested = false, after = true;
+            std::thread([&]() {
+                before = flushing();
+                {
+                    const DenormalGuard denormals;
+                    inside = flushing();
+                    {
+                        const DenormalGuard again;
+                    }
+                    nested = flushing();
+                }
+                after = flushing();
+            }).join();
+            TS_ASSERT(!before);
+            TS_ASSERT(inside);
+            TS_ASSERT(nested);
+            //the mode of the host is restored
+            TS_ASSERT(!after);
+        }
+
+        //The audio engines (including the OFFLINE renderer) get their
+        //buffers from OutMgr::tick() in a thread they own or which belongs
+        //to a library
+        void testTick() {
+            Config config;
+            MiddleWare mw(std::move(*synth), &config);
+            Master *master = mw.spawnMaster();
+            Nio::init(master->synth, config.cfg.oss_devs, master);
+            bool before = true, after = false;
+            std::thread([&]() {
+                before = flushing();
+                OutMgr::getInstance().tick(master->synth.buffersize);
+                after = flushing();
+            }).join();
+            TS_ASSERT(!before);
+            TS_ASSERT(after);
+        }
+
+        //The PADsynth samples are generated by threads of their own
+        void testPadThreads() {
+            PADnoteParameters pars(*synth, fft, time);
+            std::atomic<int> samples(0), flushed(0);
+            pars.sampleGenerator([&](int, PADnoteParameters::Sample &s) {
+                    samples++;
+                    flushed += flushing();
+                    delete[] s.smp;
+                }, []() {return false; }, 4);
+            TS_ASSERT(samples > 0);
+            TS_ASSERT_EQUALS(flushed, samples);
+            TS_ASSERT(!flushing());
+        }
+
+        //Renders within a DenormalGuard in a new thread like a plugin
+        template<class F>
+        void render(F f) {
+            std::thread([&]() {
+                const DenormalGuard denormals;
+                f();
+            }).join();
+        }
+
+        void testEffectTails() {
+            bool clean[8] = {false};
+            render([&]() {effectTails(clean); });
+            for(int nefx = 1; nefx <= 8; ++nefx)
+                TS_ASSERT(clean[nefx - 1]);
+        }
+
+        //Whether the tail of each system effect stays free of denormals
+        void effectTails(bool *clean) {
+            AllocatorClass alloc;
+            for(int nefx = 1; nefx <= 8; ++nefx) {
+                EffectMgr mgr(alloc, *synth, false);
+                mgr.changeeffect(nefx);
+                mgr.init();
+                //give the EQ a resonant band so that it has a tail too
+                if(nefx == 7) {
+                    mgr.seteffectparrt(10, 7);
+                    mgr.seteffectparrt(13, 120);
+                }
+
+                //a faint noise burst followed by ten seconds of silence
+                //(the tails reach the subnormal range within seconds)
+                prng_t seed = 1;
+                const int buffers = 10 * synth->samplerate / synth->buffersize;
+                bool denormals = false;
+                for(int b = 0; b < buffers; ++b) {
+                    for(int i = 0; i < synth->buffersize; ++i)
+                        outL[i] = outR[i] = b < 4 ?
+                            1e-35f * (prng_r(seed) / (float)INT32_MAX - 1.0f)
+                            : 0.0f;
+                    mgr.out(outL, outR);
+                    denormals |= subnormal(mgr.efxoutl)
+                                 || subnormal(mgr.efxoutr);
+                }
+                clean[nefx - 1] = !denormals;
+            }
+        }
+
+        template<class Note>
+        bool checkNote(Note &note) {
+            //let the note decay while held for 2 seconds, then release it
+            const int held = 2 * synth->samplerate / synth->buffersize;
+            bool denormals = false;
+            int  buffers   = 0;
+            while(!note.finished() && buffers < 100000) {
+                if(buffers++ == held)
+                    note.releasekey();
+                note.noteout(outL, outR);
+                denormals |= subnormal(outL) || subnormal(outR);
+            }
+            return note.finished() && !denormals;
+        }
+
+        void enterKitItem(XMLwrapper &wrap, int part, const char *branch) {
+            wrap.loadXMLfile(std::string(SOURCE_DIR)
+                              + std::string("/guitar-adnote.xmz"));
+            TS_ASSERT(wrap.enterbranch("MASTER"));
+            TS_ASSERT(wrap.enterbranch("PART", part));
+            TS_ASSERT(wrap.enterbranch("INSTRUMENT"));
+            TS_ASSERT(wrap.enterbranch("INSTRUMENT_KIT"));
+            TS_ASSERT(wrap.enterbranch("INSTRUMENT_KIT_ITEM", 0));
+            TS_ASSERT(wrap.enterbranch(branch));
+        }
+
+        void testNoteTails() {
+            const float freq = 440.0f * powf(2.0f, (50 - 69.0f) / 12.0f);
+
+            ADnoteParameters adpars(*synth, fft, time);
+            XMLwrapper adxml;
+            enterKitItem(adxml, 0, "ADD_SYNTH_PARAMETERS");
+            adpars.getfromXML(adxml);
+            SynthParams adsp{memory, *controller, *synth, *time, freq, 120, 0,
+                             50, false, prng()};
+            ADnote adnote(&adpars, adsp);
+            bool ok = false;
+            render([&]() {ok = checkNote(adnote); });
+            TS_ASSERT(ok);
+
+            SUBnoteParameters subpars(time);
+            XMLwrapper subxml;
+            enterKitItem(subxml, 1, "SUB_SYNTH_PARAMETERS");
+            subpars.getfromXML(subxml);
+            SynthParams subsp{memory, *controller, *synth, *time, freq, 120, 0,
+                              50, false, prng()};
+            SUBnote subnote(&subpars, subsp);
+            ok = false;
+            render([&]() {ok = checkNote(subnote); });
+            TS_ASSERT(ok);
+        }
+
+    private:
+        float        *outL, *outR;
+        AbsTime      *time;
+        FFTwrapper   *fft;
+        Controller   *controller;
+        Alloc         memory;
+};
@@ -0,0 +1,140 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  EQTest.h - CxxTest for Effect/EQ
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <complex>
+#include "../Effects/EQ.h"
+#include "../Misc/Allocator.h"
+#include "../globals.h"
+
+using namespace std;
+using namespace zyn;
+
+SYNTH_T *synth;
+
+class EQTest:public CxxTest::TestSuite
+{
+    public:
+        void setUp() {
+            synth = new SYNTH_T;
+            outL  = new float[synth->buffersize];
+            outR  = new float[synth->buffersize];
+            inL   = new float[synth->buffersize];
+            inR   = new float[synth->buffersize];
+            for(int i = 0; i < synth->buffersize; ++i)
+                outL[i] = outR[i] = inL[i] = inR[i] = 0.0f;
+            EffectParams pars{alloc, true, outL, outR, 0, 44100, 256, nullptr};
+            testFX = new EQ(pars);
+        }
+
+        void tearDown() {
+            delete testFX;
+            delete[] inR;
+            delete[] inL;
+            delete[] outR;
+            delete[] outL;
+            delete synth;
+        }
+
+        //A peak band at 600Hz and a three stage lowpass band at ~2.4kHz
+        void setBands() {
+            testFX->changepar(10, 7);   //band 0 peak
+            testFX->changepar(12, 100); //+16.9dB
+            testFX->changepar(15, 3);   //band 1 LP2
+            testFX->changepar(16, 90);
+            testFX->changepar(19, 2);
+        }
+
+        //Magnitude of a biquad b(z)/a(z) at the angular frequency w
+        static double magnitude(const double *b, const double *a, double w) {
+            const complex<double> z1 = polar(1.0, -w), z2 = polar(1.0, -2*w);
+            return abs((b[0] + b[1]*z1 + b[2]*z2) / (a[0] + a[1]*z1 + a[2]*z2));
+        }
+
+        //Response of setBands() in dB, straight from the Audio EQ Cookbook
+        //with the parameter mapping of the EQ
+        static double expected(double freq) {
+            const double fs = 44100, w = 2*M_PI*freq/fs;
+
+            //peak: f = 600Hz, Q = 3 * 1, A = 10^(30*(100-64)/64/20)
+            const double A  = pow(10.0, 30.0*36/64/20);
+            const double w0 = 2*M_PI*600/fs;
+            const double ap = sin(w0)/(2*3.0);
+            const double bpeak[3] = {1 + ap*A, -2*cos(w0), 1 - ap*A};
+            const double apeak[3] = {1 + ap/A, -2*cos(w0), 1 - ap/A};
+
+            //lowpass: f = 600*30^(26/64), Q = 1, three equal stages
+            const double w1 = 2*M_PI*600*pow(30.0, 26.0/64)/fs;
+            const double al = sin(w1)/2;
+            const double blp[3] = {(1 - cos(w1))/2, 1 - cos(w1),
+                                   (1 - cos(w1))/2};
+            const double alp[3] = {1 + al, -2*cos(w1), 1 - al};
+
+            //insertion effects scale by their volume (preset: 67)
+            const double volume = pow(0.005, 1 - 67/127.0) * 10;
+            return 20*log10(volume * magnitude(bpeak, apeak, w)
+                            * pow(magnitude(blp, alp, w), 3));
+        }
+
+        void testResponse() {
+            setBands();
+            const float freq[6] = {100, 600, 1000, 2400, 5000, 15000};
+            for(int i = 0; i < 6; ++i)
+                TS_ASSERT_DELTA(testFX->getfreqresponse(freq[i]),
+                                expected(freq[i]), 0.1);
+        }
+
+        //The rendered gain of a sine matches the response
+        void testRenderedResponse() {
+            setBands();
+            testFX->cleanup();
+            const float freqs[3] = {300, 1000, 3000};
+            for(float freq:freqs) {
+                float peak = 0.0f;
+                int   t    = 0;
+                for(int n = 0; n < 100; ++n) {
+                    for(int i = 0; i < synth->buffersize; ++i, ++t)
+                        inL[i] = inR[i] = 0.25 * sin(2*M_PI*freq*t/44100);
+                    testFX->out(Stereo<float *>(inL, inR));
+                    if(n >= 90)
+                        for(int i = 0; i < synth->buffersize; ++i)
+                            peak = max(peak, fabsf(outL[i]));
+                }
+                TS_ASSERT_DELTA(20*log10(peak/0.25f), expected(freq), 0.2);
+            }
+        }
+
+        void testSmoothing() {
+            testFX->changepar(10, 7);
+            testFX->changepar(12, 127);
+            testFX->cleanup();
+
+            for(int i = 0; i < synth->buffersize; ++i)
+                inL[i] = inR[i] = 0.1f;
+            for(int i = 0; i < 64; ++i)
+                testFX->out(Stereo<float *>(inL, inR));
+
+            //Moving the band over the whole range must not produce a jump
+            testFX->changepar(11, 127);
+            float last = outL[synth->buffersize - 1];
+            testFX->out(Stereo<float *>(inL, inR));
+            for(int i = 0; i < synth->buffersize; ++i) {
+                TS_ASSERT_DELTA(outL[i], last, 0.05f);
+                last = outL[i];
+            }
+        }
+
+    private:
+        float *inL, *inR, *outL, *outR;
+        EQ *testFX;
+        AllocatorClass alloc;
+};
@@ -0,0 +1,241 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  InMgrTest.h - CxxTest for the timing of MIDI input
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "../Misc/Master.h"
+#include "../Misc/Util.h"
+#include "../globals.h"
+#include "../UI/NSM.H"
+#define private public
+#define protected public
+#include "../Synth/SynthNote.h"
+#include "../Misc/Part.h"
+#include "../Nio/InMgr.h"
+#undef private
+#undef protected
+using namespace std;
+using namespace zyn;
+
+SYNTH_T *synth;
+NSM_Client *nsm = 0;
+MiddleWare *middleware = 0;
+
+char *instance_name=(char*)"";
+
+class InMgrTest:public CxxTest::TestSuite
+{
+    public:
+        Config  config;
+        Master *master;
+        InMgr  *in;
+        int     bs;
+
+        void setUp() {
+            synth = new SYNTH_T;
+            synth->buffersize = 256;
+            synth->samplerate = 48000;
+            synth->alias();
+            bs     = synth->buffersize;
+            master = new Master(*synth, &config);
+            in     = &InMgr::getInstance();
+            in->setMaster(master);
+        }
+
+        void tearDown() {
+            //nothing is left for the next master
+            in->startPeriod(bs, synth->samplerate);
+            in->flush(0, 1u << 30);
+            delete master;
+            delete synth;
+        }
+
+        void put(int note, int time, int velocity = 100) {
+            MidiEvent ev;
+            ev.type    = M_NOTE;
+            ev.channel = 0;
+            ev.num     = note;
+            ev.value   = velocity;
+            ev.time    = time;
+            in->putEvent(ev);
+        }
+
+        //An event that is dequeued without doing anything
+        void putNothing(int time) {
+            MidiEvent ev;
+            ev.time = time;
+            in->putEvent(ev);
+        }
+
+        unsigned queued() const {
+            return in->writePos - in->readPos;
+        }
+
+        //Notes started in the first part with their offsets, in the order
+        //they were played (the notes are dropped afterwards)
+        string notes() {
+            string res;
+            Part &part = *master->part[0];
+            for(auto &d:part.notePool.activeDesc())
+                for(auto &s:part.notePool.activeNotes(d))
+                    res += (res.empty() ? "" : " ") + to_s((int)d.note) + "@"
+                           + to_s(s.note->getoffset());
+            part.notePool.killAllNotes();
+            return res;
+        }
+
+        //A period is flushed buffer by buffer, each note starting at its
+        //offset from the start of the buffer
+        void testFlushOffsets() {
+            //events are stamped relative to the next period
+            put(60, 0);
+            put(61, 100);
+            put(62, bs - 1);
+            put(63, bs);
+            put(64, 3 * bs + 10);
+            put(65, 4 * bs + 5);
+            in->startPeriod(4 * bs, synth->samplerate);
+            in->flush(0, bs);
+            TS_ASSERT_EQUALS(notes(), "60@0 61@100 62@255");
+            in->flush(bs, 2 * bs);
+            TS_ASSERT_EQUALS(notes(), "63@0");
+            in->flush(2 * bs, 3 * bs);
+            TS_ASSERT_EQUALS(notes(), "");
+            in->flush(3 * bs, 4 * bs);
+            TS_ASSERT_EQUALS(notes(), "64@10");
+
+            //past the period, so it waits for the next one
+            TS_ASSERT(!in->empty());
+            in->startPeriod(4 * bs, synth->samplerate);
+            in->flush(0, bs);
+            TS_ASSERT_EQUALS(notes(), "65@5");
+            TS_ASSERT(in->empty());
+        }
+
+        //Buffers may start after samples left over from the last period,
+        //the events before the start of the first one are played at once
+        void testLeftover() {
+            const unsigned late = in->late();
+            put(60, 50);
+            put(61, 120);
+            put(62, 400);
+            in->startPeriod(2 * bs, synth->samplerate);
+            in->flush(100, 100 + bs);
+            TS_ASSERT_EQUALS(notes(), "60@0 61@20");
+            in->flush(100 + bs, 100 + 2 * bs);
+            TS_ASSERT_EQUALS(notes(), "62@44");
+            TS_ASSERT_EQUALS(in->late(), late);
+        }
+
+        //Events of a period that was not flushed are late and start at
+        //the start of the next buffer
+        void testLateClamp() {
+            const unsigned late = in->late();
+            put(60, 10);
+            put(61, bs + 20);
+            in->startPeriod(2 * bs, synth->samplerate);
+            in->startPeriod(2 * bs, synth->samplerate);
+            in->flush(0, bs);
+            TS_ASSERT_EQUALS(notes(), "60@0 61@0");
+            TS_ASSERT_EQUALS(in->late(), late + 2);
+        }
+
+        //Events from drivers without timestamps are placed where they
+        //arrived within the period
+        void testPeriodOffset() {
+            const int frames = 1024;
+            in->startPeriod(frames, 48000);
+            TS_ASSERT_LESS_THAN(in->periodOffset(), frames - 1);
+            this_thread::sleep_for(chrono::milliseconds(5));
+            //5 ms at 48 kHz
+            TS_ASSERT_LESS_THAN_EQUALS(240, in->periodOffset());
+            //arriving after the period, so the offset is its last frame
+            this_thread::sleep_for(chrono::milliseconds(50));
+            TS_ASSERT_EQUALS(in->periodOffset(), frames - 1);
+        }
+
+        //The positions wrap past 2^32 and the slots past the end of the
+        //queue, the events come out in the order they went in
+        void testWrap() {
+            const uint32_t starts[] = {0xFFFFFFFFu - 3, MIDI_QUEUE_SIZE - 3};
+            for(uint32_t pos:starts) {
+                in->writePos = pos;
+                in->readPos  = pos;
+                for(int i = 0; i < 8; ++i)
+                    put(60 + i, i);
+                //equal frames keep their order too
+                put(70, 3);
+                put(69, 3);
+                TS_ASSERT_EQUALS(queued(), 10u);
+                in->startPeriod(bs, synth->samplerate);
+                in->flush(0, bs);
+                TS_ASSERT_EQUALS(notes(),
+                        "60@0 61@1 62@2 63@3 64@4 65@5 66@6 67@7 70@3 69@3");
+                TS_ASSERT(in->empty());
+                TS_ASSERT_EQUALS((uint32_t)in->readPos, pos + 10);
+            }
+        }
+
+        //Events beyond the size of the queue are dropped and counted, the
+        //queue stays usable
+        void testOverflow() {
+            const unsigned dropped = in->overflows();
+            in->writePos = 0xFFFFFFFFu - 10;
+            in->readPos  = 0xFFFFFFFFu - 10;
+            for(int i = 0; i < MIDI_QUEUE_SIZE; ++i)
+                putNothing(0);
+            TS_ASSERT_EQUALS(queued(), (unsigned)MIDI_QUEUE_SIZE);
+            TS_ASSERT_EQUALS(in->overflows(), dropped);
+            putNothing(0);
+            put(60, 0);
+            TS_ASSERT_EQUALS(queued(), (unsigned)MIDI_QUEUE_SIZE);
+            TS_ASSERT_EQUALS(in->overflows(), dropped + 2);
+
+            //the queue is taken at once and takes events again
+            in->startPeriod(bs, synth->samplerate);
+            in->flush(0, bs);
+            TS_ASSERT(in->empty());
+            put(61, 0);
+            in->startPeriod(bs, synth->samplerate);
+            in->flush(0, bs);
+            TS_ASSERT_EQUALS(notes(), "61@0");
+            TS_ASSERT_EQUALS(in->overflows(), dropped + 2);
+        }
+
+        //A flush takes the events up to frameStop, and only late events
+        //are counted as late
+        void testFrameStop() {
+            const unsigned late = in->late();
+            for(int i = 0; i < 10; ++i)
+                putNothing(i * 25);
+            putNothing(bs);
+            putNothing(bs + 1);
+            in->startPeriod(2 * bs, synth->samplerate);
+            in->flush(0, 100);
+            TS_ASSERT_EQUALS(queued(), 8u);
+            in->flush(100, bs);
+            TS_ASSERT_EQUALS(queued(), 2u);
+            in->flush(bs, bs + 1);
+            TS_ASSERT_EQUALS(queued(), 1u);
+            TS_ASSERT_EQUALS(in->late(), late);
+
+            //left over to the next period
+            putNothing(0);
+            in->startPeriod(bs, synth->samplerate);
+            TS_ASSERT_EQUALS(queued(), 2u);
+            in->flush(0, 1);
+            TS_ASSERT(in->empty());
+            TS_ASSERT_EQUALS(in->late(), late + 1);
+        }
+};
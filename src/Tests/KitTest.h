@@ -14,6 +14,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
+#include <vector>
 #include "../Misc/Time.h"
 #include "../Misc/Allocator.h"
 #include "../DSP/FFTwrapper.h"
@@ -758,6 +759,41 @@ class KitTest:public CxxTest::TestSuite
             TS_ASSERT_EQUALS(pool.ndesc[4].note, 68);
         }
 
+        //Output of a part playing a note started at offset, until it is
+        //done and one more buffer
+        vector<float> play(Part &p, int offset) {
+            vector<float> smps;
+            p.NoteOn(64, 127, 0, offset);
+            for(int n = 0; n < 1000; ++n) {
+                if(n == 4)
+                    p.NoteOff(64);
+                const bool done = p.notePool.usedNoteDesc() == 0;
+                p.ComputePartSmps();
+                smps.insert(smps.end(), p.partoutl,
+                            p.partoutl + synth->buffersize);
+                if(done)
+                    break;
+            }
+            return smps;
+        }
+
+        //A note with a start offset plays the end of its last buffer after
+        //it finished
+        void testOffsetTail() {
+            const int k = 100;
+            Part delayed(alloc, *synth, *time, dummy, dummy, &microtonal,
+                         &fft);
+            const vector<float> ref  = play(*part, 0);
+            const vector<float> smps = play(delayed, k);
+            TS_ASSERT_EQUALS(smps.size(), ref.size() + synth->buffersize);
+            int diffs = 0;
+            for(unsigned i = 0; i < ref.size(); ++i)
+                diffs += smps[i + k] != ref[i];
+            TS_ASSERT_EQUALS(diffs, 0);
+            TS_ASSERT_EQUALS(delayed.notePool.usedNoteDesc(), 0);
+            TS_ASSERT_EQUALS(delayed.notePool.usedSynthDesc(), 0);
+        }
+
         void tearDown() {
             delete part;
             delete[] outL;
@@ -0,0 +1,151 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  LoadBench.cpp - Song Load Time against Thread Count
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+/*
+ * Loads each given song (.xmz) or instrument (.xiz) and prepares its parts
+ * with 1, 2, 4, ... threads, printing the time taken for the parse and the
+ * preparation. The best of the repeated runs is reported, followed by the
+ * total over all files.
+ *
+ * usage: load-bench [-j max-threads] [-r repeats] FILE...
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "../Misc/Master.h"
+#include "../Misc/MiddleWare.h"
+#include "../Misc/Part.h"
+#include "../Misc/Config.h"
+#include "../Misc/Util.h"
+#include "../globals.h"
+using namespace std;
+using namespace zyn;
+
+// for linking purposes only:
+MiddleWare *middleware = 0;
+char *instance_name=(char*)"";
+
+static double seconds_since(chrono::steady_clock::time_point t)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - t).count();
+}
+
+static bool has_suffix(const char *s, const char *suffix)
+{
+    const size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && !strcasecmp(s + n - m, suffix);
+}
+
+//Time the parse and the preparation of one song or instrument
+static bool load(const char *file, const SYNTH_T &synth, Config &config,
+                 unsigned threads, double &parse, double &apply)
+{
+    Master *master = new Master(synth, &config);
+
+    auto t = chrono::steady_clock::now();
+    if(has_suffix(file, ".xiz") ? master->part[0]->loadXMLinstrument(file)
+                                : master->loadXML(file)) {
+        delete master;
+        return false;
+    }
+    parse = seconds_since(t);
+
+    t = chrono::steady_clock::now();
+    master->applyparameters([]{return false;}, threads, nullptr);
+    apply = seconds_since(t);
+
+    delete master;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned maxthreads = thread::hardware_concurrency();
+    int      repeats    = 3;
+    int      opt;
+    while((opt = getopt(argc, argv, "j:r:")) != -1) {
+        switch(opt) {
+            case 'j':
+                maxthreads = atoi(optarg);
+                break;
+            case 'r':
+                repeats = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-j max-threads] [-r repeats] "
+                        "FILE...\n", argv[0]);
+                return 1;
+        }
+    }
+    if(optind >= argc) {
+        fprintf(stderr, "Please supply .xmz/.xiz files\n");
+        return 1;
+    }
+    maxthreads = max(1u, min(maxthreads, (unsigned)NUM_MIDI_PARTS));
+    repeats    = max(1, repeats);
+
+    SYNTH_T synth;
+    synth.buffersize = 256;
+    synth.samplerate = 48000;
+    synth.alias();
+
+    //Masters only read the configuration, bank scanning is skipped
+    Config config;
+    for(auto &dir:config.cfg.bankRootDirList)
+        dir.clear();
+    config.cfg.currentBankDir.clear();
+
+    flush_denormals();
+    printf("%-40s %8s %10s %10s %8s\n", "file", "threads", "parse(s)",
+           "apply(s)", "speedup");
+    vector<double> totalParse, totalApply;
+    for(int i = optind; i < argc; ++i) {
+        double base = 0;
+        unsigned step = 0;
+        for(unsigned threads = 1; threads <= maxthreads; threads *= 2, ++step) {
+            double parse = 1e9, apply = 1e9;
+            bool   ok    = true;
+            for(int r = 0; r < repeats && ok; ++r) {
+                double p, a;
+                ok    = load(argv[i], synth, config, threads, p, a);
+                parse = min(parse, p);
+                apply = min(apply, a);
+            }
+            if(!ok) {
+                printf("%-40s FAILED\n", argv[i]);
+                break;
+            }
+            if(threads == 1)
+                base = apply;
+            if(totalParse.size() <= step) {
+                totalParse.resize(step + 1);
+                totalApply.resize(step + 1);
+            }
+            totalParse[step] += parse;
+            totalApply[step] += apply;
+            printf("%-40s %8u %10.3f %10.3f %8.2f\n", argv[i], threads, parse,
+                   apply, apply > 0 ? base / apply : 0.0);
+        }
+    }
+    for(unsigned step = 0; step < totalParse.size(); ++step)
+        printf("%-40s %8u %10.3f %10.3f %8.2f\n", "total", 1u << step,
+               totalParse[step], totalApply[step],
+               totalApply[step] > 0 ? totalApply[0] / totalApply[step] : 0.0);
+    return 0;
+}
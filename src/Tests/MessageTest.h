@@ -277,6 +277,91 @@ class MessageTest:public CxxTest::TestSuite
             TS_ASSERT_EQUALS(field2, 35);
         }
 
+        //Parameters found through the dispatch table are set and reported
+        //under their own address
+        void testDispatchTable(void)
+        {
+            mw->transmitMsg("/part1/Pvolume", "i", 50);
+            mw->transmitMsg("/part0/kit0/adpars/VoicePar3/Enabled", "T");
+            mw->transmitMsg("/part0/kit0/adpars/VoicePar2/PVolume", "i", 33);
+            mw->transmitMsg("/part0/kit0/adpars/VoicePar2/PVolume", "");
+            while(ms->uToB->hasNext())
+                ms->applyOscEvent(ms->uToB->read());
+
+            TS_ASSERT_EQUALS(ms->part[1]->Pvolume, 50);
+            TS_ASSERT(ms->part[0]->kit[0].adpars->VoicePar[3].Enabled);
+            TS_ASSERT_EQUALS(ms->part[0]->kit[0].adpars->VoicePar[2].PVolume, 33);
+
+            const char *msg = NULL;
+            while(ms->bToU->hasNext())
+                msg = ms->bToU->read();
+            TS_ASSERT_EQUALS(string("/part0/kit0/adpars/VoicePar2/PVolume"), msg);
+            TS_ASSERT_EQUALS(rtosc_argument(msg, 0).i, 33);
+        }
+
+        void testCoalescing(void)
+        {
+            mw->enableCoalescing(1000);
+            for(int i = 1; i <= 3; ++i)
+                mw->transmitMsg("/part0/Pvolume", "i", i);
+            TS_ASSERT(!ms->uToB->hasNext());
+
+            //a query has to see the last value
+            mw->transmitMsg("/part0/Pvolume", "");
+            TS_ASSERT(ms->uToB->hasNext());
+            const char *msg = ms->uToB->read();
+            TS_ASSERT_EQUALS(string("/part0/Pvolume"), msg);
+            TS_ASSERT_EQUALS(rtosc_argument(msg, 0).i, 3);
+            TS_ASSERT(ms->uToB->hasNext());
+            msg = ms->uToB->read();
+            TS_ASSERT_EQUALS(rtosc_narguments(msg), 0U);
+            TS_ASSERT(!ms->uToB->hasNext());
+        }
+
+        void testOscStats(void)
+        {
+            ms->uToB->write("/part0/Pvolume", "i", 40);
+            ms->uToB->write("/part0/no-such-port", "");
+            ms->uToB->write("/Pkeyshift", "");
+            TS_ASSERT(ms->runOSC(NULL, NULL, true));
+            TS_ASSERT(!ms->uToB->hasNext());
+            TS_ASSERT_EQUALS(ms->oscCycle.processed, 3U);
+            TS_ASSERT_EQUALS(ms->oscCycle.dropped, 1U);
+            TS_ASSERT_EQUALS(ms->oscCycle.deferred, 0U);
+            TS_ASSERT_EQUALS(ms->oscTotal.processed, 3U);
+        }
+
+        //Online, the messages which do not fit in a share of the buffer
+        //period wait for the next buffer, structural changes do not
+        void testOscBudget(void)
+        {
+            //far more changes than can be handled in a buffer period
+            const unsigned n = 100000;
+            for(unsigned i = 0; i < n; ++i)
+                ms->uToB->write("/part0/Pvolume", "i", i % 128);
+            TS_ASSERT(ms->runOSC(NULL, NULL));
+            TS_ASSERT_EQUALS(ms->oscCycle.deferred, 1U);
+            TS_ASSERT_LESS_THAN(0U, ms->oscCycle.processed);
+            TS_ASSERT_LESS_THAN(ms->oscCycle.processed, n);
+            TS_ASSERT(ms->uToB->hasNext());
+
+            //the rest is handled by the next calls
+            unsigned processed = ms->oscCycle.processed;
+            while(ms->uToB->hasNext() && ms->runOSC(NULL, NULL))
+                processed += ms->oscCycle.processed;
+            TS_ASSERT_EQUALS(processed, n);
+            TS_ASSERT_EQUALS(ms->oscTotal.processed, n);
+
+            //as many effect types behind one change are all handled at once
+            ms->uToB->write("/part0/Pvolume", "i", 100);
+            for(unsigned i = 0; i < n; ++i)
+                ms->uToB->write("/sysefx0/efftype", "i", 0);
+            TS_ASSERT(ms->runOSC(NULL, NULL));
+            TS_ASSERT_EQUALS(ms->oscCycle.deferred, 0U);
+            TS_ASSERT_EQUALS(ms->oscCycle.processed, n + 1);
+            TS_ASSERT(!ms->uToB->hasNext());
+        }
+
         void testFilterDepricated(void)
         {
             vector<string> v = {"Pfreq", "Pfreqtrack", "Pgain", "Pq"};
@@ -13,11 +13,17 @@
 #include <cxxtest/TestSuite.h>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <unistd.h>
+#include <utime.h>
+#include <rtosc/rtosc.h>
 #include "../Misc/MiddleWare.h"
 #include "../Misc/Master.h"
+#include "../Misc/Part.h"
 #include "../Misc/PresetExtractor.h"
 #include "../Misc/PresetExtractor.cpp"
 #include "../Misc/Util.h"
@@ -30,6 +36,7 @@ NSM_Client *nsm = 0;
 MiddleWare *middleware = 0;
 
 char *instance_name=(char*)"";
+static bool preloadReady = false;
 
 #define NUM_MIDDLEWARE 3
 
@@ -123,6 +130,94 @@ class PluginTest:public CxxTest::TestSuite
             //const string fdata = loadfile(fname);
         }
 
+        //the ui handle stays NULL, a GUI build would take it for its own
+        static void uiCallback(void *, const char *msg)
+        {
+            if(!strcmp(msg, "/preload-ready"))
+                preloadReady = rtosc_argument(msg, 2).T;
+        }
+
+        //Wait for the instrument to be prepared for part 0
+        bool prepared(const string &file, int tries = 1000)
+        {
+            for(int i = 0; i < tries; ++i) {
+                preloadReady = false;
+                middleware[0]->transmitMsg("/preload-ready", "is", 0,
+                                           file.c_str());
+                if(preloadReady)
+                    return true;
+                usleep(10000);
+            }
+            return false;
+        }
+
+        void writeInstrument(const string &file, const char *name,
+                             time_t mtime)
+        {
+            Part *p = master[0]->part[1];
+            strcpy(p->Pname, name);
+            p->saveXML(file.c_str());
+            struct utimbuf t = {mtime, mtime};
+            utime(file.c_str(), &t);
+        }
+
+        //@return the name of the instrument part 0 got
+        string load(const string &file)
+        {
+            middleware[0]->transmitMsg("/load-part", "is", 0, file.c_str());
+            master[0]->AudioOut(outL, outR);
+            middleware[0]->tick();
+            return master[0]->part[0]->Pname;
+        }
+
+        //The set list is prepared in the background and handed out as long
+        //as its files keep their modification time
+        void testPreload(void)
+        {
+            char tmp[] = "/tmp/zyn-preload-XXXXXX";
+            const string dir  = mkdtemp(tmp);
+            const string file = dir + "/instrument.xiz";
+            middleware[0]->setUiCallback(uiCallback, NULL);
+            middleware[0]->activeUrl("GUI");
+
+            const time_t t0 = time(NULL) - 100;
+            writeInstrument(file, "first", t0);
+            middleware[0]->transmitMsg("/preload-part", "is", 0, file.c_str());
+            TS_ASSERT(prepared(file));
+
+            //a rewrite with the same modification time is not noticed, so
+            //the prepared Part is what is loaded
+            writeInstrument(file, "second", t0);
+            TS_ASSERT_EQUALS(load(file), "first");
+
+            //the set list is prepared again
+            TS_ASSERT(prepared(file));
+            writeInstrument(file, "third", t0);
+            TS_ASSERT_EQUALS(load(file), "second");
+
+            //a new modification time loads the file ...
+            TS_ASSERT(prepared(file));
+            writeInstrument(file, "fourth", t0 + 10);
+            TS_ASSERT(!prepared(file, 1));
+            TS_ASSERT_EQUALS(load(file), "fourth");
+
+            //... and keeps it in the set list
+            TS_ASSERT(prepared(file));
+            writeInstrument(file, "fifth", t0 + 10);
+            TS_ASSERT_EQUALS(load(file), "fourth");
+
+            //a cleared set list is not prepared again
+            TS_ASSERT(prepared(file));
+            middleware[0]->transmitMsg("/preload-clear", "");
+            TS_ASSERT(!prepared(file, 1));
+            writeInstrument(file, "sixth", t0 + 10);
+            TS_ASSERT_EQUALS(load(file), "sixth");
+            TS_ASSERT(!prepared(file, 10));
+
+            unlink(file.c_str());
+            rmdir(dir.c_str());
+        }
+
 
     private:
         SYNTH_T *synth;
@@ -0,0 +1,178 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  MidiFileTest.h - CxxTest for Misc/MidiFile
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../Misc/MidiFile.h"
+using namespace std;
+using namespace zyn;
+
+typedef vector<unsigned char> bytes;
+
+static bytes chunk(const char *id, const bytes &data)
+{
+    bytes b(id, id + 4);
+    const uint32_t len = data.size();
+    for(int i = 3; i >= 0; --i)
+        b.push_back(len >> (8 * i));
+    b.insert(b.end(), data.begin(), data.end());
+    return b;
+}
+
+static bytes header(int format, int ntracks, int division)
+{
+    return chunk("MThd", {0, (unsigned char)format, 0,
+                          (unsigned char)ntracks,
+                          (unsigned char)(division >> 8),
+                          (unsigned char)division});
+}
+
+static const bytes endOfTrack = {0, 0xff, 0x2f, 0};
+
+class MidiFileTest:public CxxTest::TestSuite
+{
+    public:
+        void setUp() {
+            char tmp[] = "/tmp/zyn-midi-XXXXXX";
+            const int fd = mkstemp(tmp);
+            if(fd >= 0)
+                close(fd);
+            path = tmp;
+        }
+
+        void tearDown() {
+            unlink(path.c_str());
+        }
+
+        int load(const bytes &smf) {
+            FILE *f = fopen(path.c_str(), "wb");
+            fwrite(smf.data(), 1, smf.size(), f);
+            fclose(f);
+            return midi.load(path);
+        }
+
+        int load(const bytes &hdr, const bytes &track) {
+            bytes smf = hdr, trk = track;
+            trk.insert(trk.end(), endOfTrack.begin(), endOfTrack.end());
+            const bytes c = chunk("MTrk", trk);
+            smf.insert(smf.end(), c.begin(), c.end());
+            return load(smf);
+        }
+
+        void checkEvent(size_t i, double time, unsigned char status,
+                        unsigned char d1, unsigned char d2) {
+            TS_ASSERT_LESS_THAN(i, midi.events().size());
+            if(i >= midi.events().size())
+                return;
+            const MidiFile::Event &ev = midi.events()[i];
+            TS_ASSERT_DELTA(ev.time, time, 1e-9);
+            TS_ASSERT_EQUALS(ev.msg[0], status);
+            TS_ASSERT_EQUALS(ev.msg[1], d1);
+            TS_ASSERT_EQUALS(ev.msg[2], d2);
+        }
+
+        void testFormat0() {
+            const bytes track = {
+                0,    0x90, 60, 100,              //note on
+                96,   60, 0,                      //running status note off
+                0,    0xff, 0x51, 3, 0x0f, 0x42, 0x40, //60 bpm
+                0,    0xff, 0x51, 3, 0, 0, 0,     //invalid tempo
+                96,   0xc0, 5,                    //program change
+                0,    7,                          //running status
+                0x81, 0x00, 0xb1, 7, 100          //at 128 ticks
+            };
+            TS_ASSERT_EQUALS(load(header(0, 1, 96), track), 0);
+            TS_ASSERT_EQUALS(midi.events().size(), 5u);
+            //120 bpm until the tempo change
+            checkEvent(0, 0.0, 0x90, 60, 100);
+            checkEvent(1, 0.5, 0x90, 60, 0);
+            checkEvent(2, 1.5, 0xc0, 5, 0);
+            checkEvent(3, 1.5, 0xc0, 7, 0);
+            checkEvent(4, 1.5 + 128 / 96.0, 0xb1, 7, 100);
+            TS_ASSERT_DELTA(midi.length(), 1.5 + 128 / 96.0, 1e-9);
+        }
+
+        //A conductor track holds the tempo map of the other tracks
+        void testFormat1() {
+            bytes smf = header(1, 3, 480);
+            const bytes tempo = {
+                0,          0xff, 0x51, 3, 0x09, 0x27, 0xc0, //100 bpm
+                0x87, 0x40, 0xff, 0x51, 3, 0x04, 0x93, 0xe0, //200 bpm
+                0,          0xff, 0x2f, 0};
+            const bytes notes = {
+                0,          0xf0, 3, 0x7e, 0x7f, 0xf7, //system exclusive
+                0,          0x91, 64, 90,
+                0x8f, 0x00, 0x81, 64, 0,               //at 1920 ticks
+                0,          0xff, 0x2f, 0};
+            const bytes drums = {
+                0x87, 0x40, 0x99, 36, 127,             //at 960 ticks
+                0,          0xff, 0x2f, 0};
+            for(const bytes &c:{chunk("MTrk", tempo), chunk("XFIH", {1, 2}),
+                                chunk("MTrk", notes), chunk("MTrk", drums)})
+                smf.insert(smf.end(), c.begin(), c.end());
+
+            TS_ASSERT_EQUALS(load(smf), 0);
+            TS_ASSERT_EQUALS(midi.events().size(), 3u);
+            checkEvent(0, 0.0, 0x91, 64, 90);
+            checkEvent(1, 1.2, 0x99, 36, 127);
+            checkEvent(2, 1.2 + 960 * 0.3 / 480, 0x81, 64, 0);
+        }
+
+        //Timecode divisions do not follow the tempo map
+        void testSmpte() {
+            const bytes track = {
+                0,          0xff, 0x51, 3, 0x0f, 0x42, 0x40,
+                0x83, 0x74, 0x90, 60, 100}; //at 500 ticks
+            //25 frames per second, 40 ticks per frame
+            TS_ASSERT_EQUALS(load(header(0, 1, 0xe728), track), 0);
+            checkEvent(0, 0.5, 0x90, 60, 100);
+        }
+
+        //Meta events and system exclusive messages cancel running status
+        void testRunningStatusCancelled() {
+            TS_ASSERT_EQUALS(load(header(0, 1, 96),
+                                  {0, 0x90, 60, 100,
+                                   0, 0xff, 0x01, 2, 'h', 'i',
+                                   0, 62, 100}), -1);
+            TS_ASSERT_EQUALS(load(header(0, 1, 96),
+                                  {0, 0x90, 60, 100,
+                                   0, 0xf0, 1, 0xf7,
+                                   0, 62, 100}), -1);
+            TS_ASSERT_EQUALS(load(header(0, 1, 96), {0, 60, 100}), -1);
+        }
+
+        void testMalformed() {
+            //a track longer than the file
+            bytes smf = header(0, 1, 96);
+            const bytes c = chunk("MTrk", {0, 0x90, 60, 100, 0, 0xff, 0x2f,
+                                           0});
+            smf.insert(smf.end(), c.begin(), c.end() - 2);
+            TS_ASSERT_EQUALS(load(smf), -1);
+
+            //an event cut short by the end of its track
+            smf = header(0, 1, 96);
+            const bytes cut = chunk("MTrk", {0, 0xff, 0x51, 3, 0x07});
+            smf.insert(smf.end(), cut.begin(), cut.end());
+            TS_ASSERT_EQUALS(load(smf), -1);
+            TS_ASSERT_EQUALS(load(header(2, 1, 96), {0, 0x90, 60, 100}), -1);
+            TS_ASSERT_EQUALS(load(bytes{'R', 'I', 'F', 'F', 0, 0, 0, 0,
+                                        0, 0, 0, 0, 0, 0}), -1);
+            TS_ASSERT_EQUALS(midi.load(path + ".missing"), -1);
+        }
+
+    private:
+        string   path;
+        MidiFile midi;
+};
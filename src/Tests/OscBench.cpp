@@ -0,0 +1,146 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  OscBench.cpp - Parameter Messages per Second through Master::runOSC()
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+
+/*
+ * Sends parameter changes through Master::runOSC() the way automation from
+ * a host arrives, a batch of messages per audio buffer, and prints how many
+ * messages are handled per second for each address and for all of them
+ * interleaved, along with the messages handled per runOSC() call within its
+ * time budget. The best of the repeated runs is reported.
+ *
+ * usage: osc-bench [-n messages] [-b batch] [-r repeats]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <unistd.h>
+#include <rtosc/thread-link.h>
+
+#include "../Misc/Master.h"
+#include "../Misc/MiddleWare.h"
+#include "../Misc/Config.h"
+#include "../globals.h"
+using namespace std;
+using namespace zyn;
+
+// for linking purposes only:
+MiddleWare *middleware = 0;
+char *instance_name=(char*)"";
+
+//from the top of the port tree to the leaves of a voice; the microtonal
+//one goes through Ports::dispatch()
+static const char *addresses[] = {
+    "/Pkeyshift",
+    "/part0/Pvolume",
+    "/part3/kit0/Pminkey",
+    "/part0/kit0/adpars/GlobalPar/PVolume",
+    "/part0/kit0/adpars/VoicePar2/PVolume",
+    "/sysefx0/parameter1",
+    "/microtonal/Pscaleshift",
+};
+
+static double seconds_since(chrono::steady_clock::time_point t)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - t).count();
+}
+
+//Messages per second for the addresses [first, last)
+static double rate(Master *master, int first, int last, int messages,
+                   int batch, double &percall)
+{
+    rtosc::ThreadLink &uToB = *master->uToB, &bToU = *master->bToU;
+    const Master::OscStats before = master->oscTotal;
+    auto t = chrono::steady_clock::now();
+    for(int sent = 0; sent < messages;) {
+        for(int i = 0; i < batch && sent < messages; ++i, ++sent)
+            uToB.write(addresses[first + sent % (last - first)], "i",
+                       sent % 128);
+        //runOSC() defers what it can not handle within one buffer
+        while(uToB.hasNext()) {
+            master->runOSC(NULL, NULL);
+            while(bToU.hasNext())
+                bToU.read();
+        }
+    }
+    const double seconds = seconds_since(t);
+    percall = (master->oscTotal.processed - before.processed)
+              / (double)(master->oscTotal.cycles - before.cycles);
+    return messages / seconds;
+}
+
+int main(int argc, char **argv)
+{
+    int messages = 100000;
+    int batch    = 256;
+    int repeats  = 3;
+    int opt;
+    while((opt = getopt(argc, argv, "n:b:r:")) != -1) {
+        switch(opt) {
+            case 'n':
+                messages = atoi(optarg);
+                break;
+            case 'b':
+                batch = atoi(optarg);
+                break;
+            case 'r':
+                repeats = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n messages] [-b batch] "
+                        "[-r repeats]\n", argv[0]);
+                return 1;
+        }
+    }
+    messages = max(1, messages);
+    batch    = max(1, batch);
+    repeats  = max(1, repeats);
+
+    SYNTH_T synth;
+    synth.buffersize = 256;
+    synth.samplerate = 48000;
+    synth.alias();
+
+    //Masters only read the configuration, bank scanning is skipped
+    Config config;
+    for(auto &dir:config.cfg.bankRootDirList)
+        dir.clear();
+    config.cfg.currentBankDir.clear();
+
+    Master *master = new Master(synth, &config);
+    master->uToB   = new rtosc::ThreadLink(4096*2*16, 1024/16);
+    master->bToU   = new rtosc::ThreadLink(4096*2*16, 1024/16);
+
+    const int n = sizeof(addresses) / sizeof(addresses[0]);
+    printf("%-40s %12s %10s\n", "address", "msg/s", "msg/call");
+    for(int i = 0; i <= n; ++i) {
+        const bool all = i == n;
+        double best = 0, percall = 0;
+        for(int r = 0; r < repeats; ++r) {
+            double p;
+            const double m = rate(master, all ? 0 : i, all ? n : i + 1,
+                                  messages, batch, p);
+            if(m > best) {
+                best    = m;
+                percall = p;
+            }
+        }
+        printf("%-40s %12.0f %10.1f\n", all ? "all" : addresses[i], best,
+               percall);
+    }
+
+    delete master->uToB;
+    delete master->bToU;
+    delete master;
+    return 0;
+}
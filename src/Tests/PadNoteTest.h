@@ -104,7 +104,9 @@ class PadNoteTest:public CxxTest::TestSuite
             //lets go with.... 50! as a nice note
             testnote = 50;
             float freq = 440.0f * powf(2.0f, (testnote - 69.0f) / 12.0f);
-            SynthParams pars_{memory, *controller, *synth, *time, freq, 120, 0, testnote, false, prng()};
+            //a fixed seed, so that the output does not depend on what the
+            //thread drew before
+            SynthParams pars_{memory, *controller, *synth, *time, freq, 120, 0, testnote, false, 0x1234};
 
             note = new PADnote(pars, pars_, interpolation);
         }
@@ -147,7 +149,10 @@ class PadNoteTest:public CxxTest::TestSuite
 #endif
             sampleCount += synth->buffersize;
 
-            TS_ASSERT_DELTA(outL[255], -0.0554, 0.0005f);
+            //The expected values were read from a run of this test (define
+            //WRITE_OUTPUT to dump the whole note). They have to be taken again
+            //whenever the note draws its random numbers in another order.
+            TS_ASSERT_DELTA(outL[255], -0.2175f, 0.0005f);
 
 
             note->releasekey();
@@ -155,19 +160,19 @@ class PadNoteTest:public CxxTest::TestSuite
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.0729f, 0.0005f);
+            TS_ASSERT_DELTA(outL[255], 0.2014f, 0.0005f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], -0.0331f, 0.0005f);
+            TS_ASSERT_DELTA(outL[255], 0.0626f, 0.0005f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.0219f, 0.0005f);
+            TS_ASSERT_DELTA(outL[255], 0.0369f, 0.0005f);
 
             note->noteout(outL, outR);
             sampleCount += synth->buffersize;
-            TS_ASSERT_DELTA(outL[255], 0.0137f, 0.0001f);
+            TS_ASSERT_DELTA(outL[255], -0.0134f, 0.0001f);
 
             while(!note->finished()) {
                 note->noteout(outL, outR);
@@ -202,26 +207,28 @@ class PadNoteTest:public CxxTest::TestSuite
             for(int i=8; i<PAD_MAX_SAMPLES; ++i)
                 TS_ASSERT(!pars->sample[i].smp);
 
-            TS_ASSERT_DELTA(pars->sample[0].smp[0],   0.0516f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[1],   0.0845f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[2],   0.1021f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[3],   0.0919f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[4],   0.0708f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[5],   0.0414f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[6],   0.0318f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[7],   0.0217f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[8],   0.0309f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[9],   0.0584f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[10],  0.0266f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[11],  0.0436f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[12],  0.0199f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[13],  0.0505f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[14],  0.0438f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[15],  0.0024f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[16],  0.0052f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[17], -0.0180f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[18],  0.0342f, 0.0005f);
-            TS_ASSERT_DELTA(pars->sample[0].smp[19],  0.0051f, 0.0005f);
+            //Read from a run of this test as well. The phases of sample n are
+            //drawn from a generator seeded with 0x1234 + n.
+            TS_ASSERT_DELTA(pars->sample[0].smp[0],   0.0157f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[1],  -0.0117f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[2],   0.0287f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[3],   0.0138f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[4],  -0.0115f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[5],   0.0122f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[6],   0.0112f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[7],   0.0364f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[8],   0.0702f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[9],   0.0398f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[10],  0.0363f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[11],  0.0482f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[12],  0.0967f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[13],  0.0833f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[14],  0.0704f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[15],  0.1117f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[16],  0.1174f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[17],  0.0946f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[18],  0.0951f, 0.0005f);
+            TS_ASSERT_DELTA(pars->sample[0].smp[19],  0.1113f, 0.0005f);
 
 
             //Verify Harmonic Input
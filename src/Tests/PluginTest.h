@@ -13,11 +13,14 @@
 #include <cxxtest/TestSuite.h>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include "../Misc/MiddleWare.h"
 #include "../Misc/Master.h"
+#include "../Misc/Part.h"
+#include "../Params/PADnoteParameters.h"
 #include "../Misc/PresetExtractor.h"
 #include "../Misc/PresetExtractor.cpp"
 #include "../Misc/Util.h"
@@ -214,6 +217,126 @@ class PluginTest:public CxxTest::TestSuite
             TS_ASSERT_LESS_THAN(0.1f, sum);
         }
 
+        //Parts play in the main mix and in their own bus by default. A part
+        //given a bus goes to it if the driver provides it, to the main mix
+        //otherwise
+        void testBusRouting()
+        {
+            float *busl[2] = {NULL, new float[synth->buffersize]};
+            float *busr[2] = {NULL, new float[synth->buffersize]};
+            float main = 0.0f, bus = 0.0f;
+
+            master[0]->noteOn(0,64,64);
+            master[0]->setBuses(busl, busr, 2);
+            master[0]->AudioOut(outL, outR);
+            for(int i = 0; i < synth->buffersize; ++i) {
+                main += fabs(outL[i]);
+                bus  += fabs(busl[1][i]);
+            }
+            TS_ASSERT_LESS_THAN(0.1f, main);
+            TS_ASSERT_LESS_THAN(0.1f, bus);
+
+            main = bus = 0.0f;
+            master[0]->Ppartbus[0] = 0;
+            master[0]->setBuses(busl, busr, 2);
+            master[0]->AudioOut(outL, outR);
+            for(int i = 0; i < synth->buffersize; ++i) {
+                main += fabs(outL[i]);
+                bus  += fabs(busl[1][i]);
+            }
+            TS_ASSERT_LESS_THAN(0.1f, main);
+            TS_ASSERT_EQUALS(bus, 0.0f);
+
+            main = bus = 0.0f;
+            master[0]->Ppartbus[0] = 1;
+            master[0]->setBuses(busl, busr, 2);
+            master[0]->AudioOut(outL, outR);
+            for(int i = 0; i < synth->buffersize; ++i) {
+                main += fabs(outL[i]);
+                bus  += fabs(busl[1][i]);
+            }
+            TS_ASSERT_EQUALS(main, 0.0f);
+            TS_ASSERT_LESS_THAN(0.1f, bus);
+
+            main = 0.0f;
+            master[0]->setBuses(NULL, NULL, 0);
+            master[0]->AudioOut(outL, outR);
+            for(int i = 0; i < synth->buffersize; ++i)
+                main += fabs(outL[i]);
+            TS_ASSERT_LESS_THAN(0.1f, main);
+
+            delete [] busl[1];
+            delete [] busr[1];
+        }
+
+        //Songs saved before there were buses play as they did with the
+        //multichannel drivers: JACK-MULTI had the main mix on out-L/R and
+        //each part on its own ports as well, OSS-MULTI had each part on a
+        //channel pair
+        void testOldSongRouting()
+        {
+            string song = loadfile(string(SOURCE_DIR) + "/guitar-adnote.xmz");
+            for(size_t pos; (pos = song.find("<par name=\"output_bus\""))
+                            != string::npos;)
+                song.erase(pos, song.find('\n', pos) + 1 - pos);
+
+            const int bs = synth->buffersize;
+            float *busl[NUM_OUT_BUSES], *busr[NUM_OUT_BUSES];
+            busl[0] = busr[0] = NULL;
+            for(int bus = 1; bus < NUM_OUT_BUSES; ++bus) {
+                busl[bus] = new float[bs];
+                busr[bus] = new float[bs];
+            }
+
+            //a stereo driver, JACK-MULTI (every bus) and OSS-MULTI with four
+            //channels (the buses of the first two parts)
+            const int nbuses[3] = {0, NUM_OUT_BUSES, 3};
+            float *mainl = new float[8 * bs], *mainr = new float[8 * bs];
+            for(int m = 0; m < 3; ++m) {
+                Master &ms = *master[m];
+                ms.putalldata(song.c_str());
+                sprng(1234);
+                for(int chan = 0; chan < 3; ++chan)
+                    ms.noteOn(chan, 60 + 4 * chan, 100);
+
+                float err = 0.0f, part = 0.0f;
+                for(int n = 0; n < 8; ++n) {
+                    ms.setBuses(busl, busr, nbuses[m]);
+                    ms.AudioOut(outL, outR);
+                    for(int i = 0; i < bs; ++i) {
+                        //the same main mix with every driver
+                        if(m == 0) {
+                            mainl[n * bs + i] = outL[i];
+                            mainr[n * bs + i] = outR[i];
+                        }
+                        err = max(err, fabsf(outL[i] - mainl[n * bs + i]));
+                        err = max(err, fabsf(outR[i] - mainr[n * bs + i]));
+                    }
+                    //each bus provided plays its part
+                    for(int bus = 1; bus < nbuses[m]; ++bus)
+                        for(int i = 0; i < bs; ++i) {
+                            const Part &p = *ms.part[bus - 1];
+                            const float l = p.Penabled ? p.partoutl[i] : 0.0f;
+                            const float r = p.Penabled ? p.partoutr[i] : 0.0f;
+                            err  = max(err, fabsf(busl[bus][i] - l));
+                            err  = max(err, fabsf(busr[bus][i] - r));
+                            part = max(part, fabsf(l));
+                        }
+                }
+                TS_ASSERT_EQUALS(err, 0.0f);
+                if(m)
+                    TS_ASSERT_LESS_THAN(0.01f, part);
+                ms.setBuses(NULL, NULL, 0);
+            }
+
+            for(int bus = 1; bus < NUM_OUT_BUSES; ++bus) {
+                delete [] busl[bus];
+                delete [] busr[bus];
+            }
+            delete [] mainl;
+            delete [] mainr;
+        }
+
         string loadfile(string fname) const
         {
             std::ifstream t(fname.c_str());
@@ -237,6 +360,51 @@ class PluginTest:public CxxTest::TestSuite
                 print_string_differences(fdata, result);
         }
 
+        //Parts prepared in parallel get the same PADsynth samples as parts
+        //prepared one after the other
+        void testParallelApply(void)
+        {
+            const string fname = string(SOURCE_DIR) + "/guitar-adnote.xmz";
+            for(int m = 0; m < 2; ++m) {
+                TS_ASSERT_EQUALS(master[m]->loadXML(fname.c_str()), 0);
+                //PADsynth parts of different bandwidths
+                for(int npart = 4; npart < 8; ++npart) {
+                    Part::Kit &kit = master[m]->part[npart]->kit[0];
+                    if(!kit.padpars)
+                        kit.padpars = new PADnoteParameters(
+                                *synth, master[m]->fft, &master[m]->time);
+                    kit.padpars->Pbandwidth = 100 * npart;
+                    kit.Ppadenabled = 1;
+                }
+            }
+
+            master[0]->applyparameters();
+            int finished = 0;
+            master[1]->applyparameters([]{return false;}, 4,
+                                       [&finished](int n){finished = n;});
+            TS_ASSERT_EQUALS(finished, NUM_MIDI_PARTS);
+
+            int compared = 0;
+            for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+                for(int n = 0; n < NUM_KIT_ITEMS; ++n) {
+                    Part::Kit &a = master[0]->part[npart]->kit[n];
+                    Part::Kit &b = master[1]->part[npart]->kit[n];
+                    if(!a.Ppadenabled || !a.padpars)
+                        continue;
+                    const PADnoteParameters::Sample &sa = a.padpars->sample[0];
+                    const PADnoteParameters::Sample &sb = b.padpars->sample[0];
+                    TS_ASSERT(sa.smp && sb.smp);
+                    TS_ASSERT_EQUALS(sa.size, sb.size);
+                    if(!sa.smp || !sb.smp || sa.size != sb.size)
+                        continue;
+                    float err = 0.0f;
+                    for(int i = 0; i < sa.size; ++i)
+                        err = max(err, fabsf(sa.smp[i] - sb.smp[i]));
+                    TS_ASSERT_LESS_THAN(err, 1e-5f);
+                    ++compared;
+                }
+            TS_ASSERT_LESS_THAN_EQUALS(4, compared);
+        }
 
     private:
         float *outR, *outL;
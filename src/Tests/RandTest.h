@@ -14,6 +14,8 @@
 #include "../Misc/Util.h"
 #include <cstdlib>
 #include <cstdio>
+#include <ctime>
+#include <thread>
 #include <cxxtest/TestSuite.h>
 using namespace zyn;
 
@@ -28,4 +30,38 @@ class RandTest:public CxxTest::TestSuite
             TS_ASSERT_DELTA(RND, 0.286319, 0.00001);
             TS_ASSERT_DELTA(RND, 0.511766, 0.00001);
         }
+
+        void testOwnedState(void) {
+            //a caller owned generator continues the same pattern
+            prng_t state = 0x1234;
+            TS_ASSERT_DELTA(prng_float(state), 0.607781, 0.00001);
+            TS_ASSERT_DELTA(prng_float(state), 0.591761, 0.00001);
+
+            //and a block of numbers matches drawing them one by one
+            for(int n = 1; n < 20; ++n) {
+                prng_t a = 0xbeef, b = 0xbeef;
+                float  smps[20];
+                prng_fill(a, smps, n);
+                for(int i = 0; i < n; ++i)
+                    TS_ASSERT_EQUALS(smps[i], prng_float(b));
+                TS_ASSERT_EQUALS(a, b);
+            }
+        }
+
+        void testThreadSeeds(void) {
+            //threads started after sprng() follow its seed, but do not
+            //repeat each other
+            prng_t draws[2][2];
+            for(int s = 0; s < 2; ++s) {
+                sprng(time(NULL) + s);
+                for(int i = 0; i < 2; ++i)
+                    std::thread([&draws, s, i]() {
+                            draws[s][i] = prng();
+                        }).join();
+            }
+            TS_ASSERT_DIFFERS(draws[0][0], draws[0][1]);
+            TS_ASSERT_DIFFERS(draws[1][0], draws[1][1]);
+            TS_ASSERT_DIFFERS(draws[0][0], draws[1][0]);
+            TS_ASSERT_DIFFERS(draws[0][1], draws[1][1]);
+        }
 };
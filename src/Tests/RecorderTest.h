@@ -0,0 +1,171 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  RecorderTest.h - CxxTest for recording stems through the middleware
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../Misc/MiddleWare.h"
+#include "../Misc/Master.h"
+#include "../Misc/WavFile.h"
+#include "../Effects/EffectMgr.h"
+#include "../Nio/Nio.h"
+#include "../Nio/OutMgr.h"
+#include "../Nio/WavEngine.h"
+#include "../globals.h"
+#include "../UI/NSM.H"
+using namespace std;
+using namespace zyn;
+
+NSM_Client *nsm = 0;
+MiddleWare *middleware = 0;
+
+char *instance_name=(char*)"";
+
+//Samples of the data chunk of a float WAV file
+static vector<float> readSamples(const string &name)
+{
+    vector<float> smps;
+    FILE *f = fopen(name.c_str(), "rb");
+    if(!f)
+        return smps;
+    char id[4];
+    uint32_t size;
+    fseek(f, 12, SEEK_SET);
+    while(fread(id, 1, 4, f) == 4 && fread(&size, 4, 1, f) == 1) {
+        if(!memcmp(id, "data", 4)) {
+            smps.resize(size / sizeof(float));
+            if(fread(smps.data(), sizeof(float), smps.size(), f)
+               != smps.size())
+                smps.clear();
+            break;
+        }
+        fseek(f, size + (size & 1), SEEK_CUR);
+    }
+    fclose(f);
+    return smps;
+}
+
+class RecorderTest:public CxxTest::TestSuite
+{
+    public:
+        Config config;
+        void setUp() {
+            synth = new SYNTH_T;
+            synth->buffersize = 256;
+            synth->samplerate = 48000;
+            mw     = new MiddleWare(std::move(*synth), &config);
+            master = mw->spawnMaster();
+            Nio::init(master->synth, config.cfg.oss_devs, master);
+            outL = new float[master->synth.buffersize];
+            outR = new float[master->synth.buffersize];
+
+            char tmp[] = "/tmp/zyn-rec-XXXXXX";
+            dir = mkdtemp(tmp);
+        }
+
+        void tearDown() {
+            Nio::waveEnd();
+            for(auto &name:names())
+                unlink(name.c_str());
+            rmdir(dir.c_str());
+            delete[] outL;
+            delete[] outR;
+            delete mw;
+            delete synth;
+        }
+
+        vector<string> names() const {
+            return {dir + "/take.wav", dir + "/take-part01.wav",
+                    dir + "/take-part02.wav", dir + "/take-sysefx1.wav"};
+        }
+
+        //Let the realtime side handle what the middleware sent it
+        void cycle() {
+            master->AudioOut(outL, outR);
+            mw->tick();
+        }
+
+        //Two parts and a system effect recorded with their stems
+        void testStems() {
+            const int bs = master->synth.buffersize;
+            master->partonoff(1, 1);
+            master->sysefx[0]->changeeffect(1);
+            master->setPsysefxvol(0, 0, 100);
+            mw->transmitMsg("/HDDRecorder/format", "i", WavFile::Float32);
+            mw->transmitMsg("/HDDRecorder/stems", "i",
+                            Recorder::PostInsertion);
+            cycle();
+
+            //the files are opened by the middleware and handed over
+            mw->transmitMsg("/HDDRecorder/preparefile", "s",
+                            names()[0].c_str());
+            mw->transmitMsg("/HDDRecorder/start", "");
+            cycle();
+            TS_ASSERT_EQUALS(master->HDDRecorder.status, 2);
+            for(auto &name:names())
+                TS_ASSERT_EQUALS(access(name.c_str(), F_OK), 0);
+            TS_ASSERT(access((dir + "/take-part03.wav").c_str(), F_OK));
+
+            //OutMgr pushes the master mix along with the stems
+            master->noteOn(0, 60, 100);
+            master->noteOn(1, 67, 100);
+            vector<float> mix;
+            for(int n = 0; n < 200; ++n) {
+                master->AudioOut(outL, outR);
+                OutMgr::getInstance().wave->push(Stereo<float *>(outL, outR),
+                                                 bs);
+                for(int i = 0; i < bs; ++i) {
+                    mix.push_back(outL[i]);
+                    mix.push_back(outR[i]);
+                }
+            }
+            mw->transmitMsg("/HDDRecorder/stop", "");
+            cycle();
+            Nio::waveEnd();
+
+            vector<vector<float>> tracks;
+            for(auto &name:names())
+                tracks.push_back(readSamples(name));
+            TS_ASSERT(tracks[0] == mix);
+            for(auto &t:tracks)
+                TS_ASSERT_EQUALS(t.size(), mix.size());
+            if(tracks[0] != mix)
+                return;
+
+            //each stem holds a sound of its own ...
+            for(int t = 1; t < 4; ++t) {
+                float peak = 0.0f;
+                for(float s:tracks[t])
+                    peak = max(peak, fabsf(s));
+                TS_ASSERT_LESS_THAN(1e-3f, peak);
+            }
+            TS_ASSERT(tracks[1] != tracks[2]);
+
+            //... and together they are the master mix
+            float err = 0.0f;
+            for(unsigned i = 0; i < mix.size(); ++i) {
+                const float sum = tracks[1][i] + tracks[2][i] + tracks[3][i];
+                err = max(err, fabsf(sum * master->volume - mix[i]));
+            }
+            TS_ASSERT_LESS_THAN(err, 1e-5f);
+        }
+
+    private:
+        SYNTH_T *synth;
+        float *outL, *outR;
+        MiddleWare *mw;
+        Master *master;
+        string dir;
+};
@@ -0,0 +1,111 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  ResamplerTest.h - CxxTest for DSP/Resampler
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "../DSP/Resampler.h"
+#include "../globals.h"
+using namespace std;
+using namespace zyn;
+
+SYNTH_T *synth;
+
+#define BLOCK 256
+
+class ResamplerTest:public CxxTest::TestSuite
+{
+    public:
+        //Convert blocks of a 1kHz sine and compare the output with the sine
+        //at the output rate
+        //@return signal to noise ratio in dB
+        float snr(unsigned src, unsigned dst, int quality) {
+            Resampler rs(src, dst, BLOCK, quality);
+            const double w = 2 * M_PI * 1000.0;
+            vector<float> in(BLOCK), out(rs.maxOut(BLOCK));
+            int n = 0, total = 0, lag = 0;
+            double sig = 0.0, err = 0.0;
+            for(int b = 0; b < 400; ++b) {
+                for(int i = 0; i < BLOCK; ++i, ++n)
+                    in[i] = sin(w * n / src);
+                const int count = rs.process(in.data(), BLOCK, out.data());
+                TS_ASSERT_LESS_THAN_EQUALS(count, rs.maxOut(BLOCK));
+                //output k is the input at k / dst seconds, so it lags behind
+                //the input by a constant number of samples
+                const int expected = (int)((uint64_t)n * dst / src);
+                if(b == 100)
+                    lag = expected - (total + count);
+                if(b > 100)
+                    TS_ASSERT_DELTA(expected - (total + count), lag, 1);
+                //skip the start of the sine
+                for(int k = 0; k < count; ++k, ++total) {
+                    if(total < 1000)
+                        continue;
+                    const double ref = sin(w * total / dst);
+                    sig += ref * ref;
+                    err += (out[k] - ref) * (out[k] - ref);
+                }
+            }
+            TS_ASSERT_LESS_THAN(0, lag);
+            return 10 * log10(sig / err);
+        }
+
+        //Rates with a small ratio use a phase per output position
+        void testCommonRates() {
+            TS_ASSERT_LESS_THAN(90.0f, snr(44100, 48000, Resampler::Best));
+            TS_ASSERT_LESS_THAN(90.0f, snr(48000, 44100, Resampler::Best));
+            TS_ASSERT_LESS_THAN(90.0f, snr(48000, 96000, Resampler::Best));
+            TS_ASSERT_LESS_THAN(90.0f, snr(96000, 44100, Resampler::Best));
+            TS_ASSERT_LESS_THAN(60.0f, snr(44100, 48000, Resampler::Fast));
+        }
+
+        //Other ratios interpolate between phases
+        void testOddRates() {
+            TS_ASSERT_LESS_THAN(80.0f, snr(44100, 44101, Resampler::Best));
+            TS_ASSERT_LESS_THAN(80.0f, snr(48000, 44123, Resampler::Best));
+        }
+
+        void testSameRate() {
+            TS_ASSERT_LESS_THAN(90.0f, snr(48000, 48000, Resampler::Best));
+        }
+
+        //Blocks of any size up to maxIn give the same output as whole ones
+        void testBlockSizes() {
+            Resampler a(44100, 48000, BLOCK), b(44100, 48000, BLOCK);
+            vector<float> in(4 * BLOCK), outa, outb;
+            for(int i = 0; i < 4 * BLOCK; ++i)
+                in[i] = sinf(i * 0.05f) + 0.3f * sinf(i * 0.31f);
+            vector<float> tmp(a.maxOut(BLOCK));
+            for(int i = 0; i < 4 * BLOCK; i += BLOCK) {
+                const int n = a.process(&in[i], BLOCK, tmp.data());
+                outa.insert(outa.end(), tmp.begin(), tmp.begin() + n);
+            }
+            const int sizes[] = {1, 7, 100, BLOCK, 3};
+            for(int i = 0, s = 0; i < 4 * BLOCK; ++s) {
+                const int len = min(sizes[s % 5], 4 * BLOCK - i);
+                const int n   = b.process(&in[i], len, tmp.data());
+                outb.insert(outb.end(), tmp.begin(), tmp.begin() + n);
+                i += len;
+            }
+            TS_ASSERT(outa == outb);
+            TS_ASSERT_LESS_THAN(0u, outa.size());
+
+            //after a reset the same input gives the same output again
+            b.reset();
+            outb.clear();
+            for(int i = 0; i < 4 * BLOCK; i += BLOCK) {
+                const int n = b.process(&in[i], BLOCK, tmp.data());
+                outb.insert(outb.end(), tmp.begin(), tmp.begin() + n);
+            }
+            TS_ASSERT(outa == outb);
+        }
+};
@@ -0,0 +1,170 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  ResonanceTest.h - CxxTest for Synth/Resonance
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include "../Synth/Resonance.h"
+#include "../Misc/Util.h"
+#include "../globals.h"
+using namespace std;
+using namespace zyn;
+
+SYNTH_T *synth;
+
+#define HARMONICS 1024
+
+class ResonanceTest:public CxxTest::TestSuite
+{
+    public:
+        void setUp() {
+            synth = new SYNTH_T;
+            res   = new Resonance();
+            res->Penabled = 1;
+            seed  = 1;
+        }
+
+        void tearDown() {
+            delete res;
+            delete synth;
+        }
+
+        //Gain of harmonic i as computed per call before the response was
+        //tabulated
+        float oldres(int i, float freq) {
+            const float l1 = logf(res->getfreqx(0.0f) * res->ctlcenter),
+                        l2 = logf(2.0f) * res->getoctavesfreq() * res->ctlbw;
+            const float upper = limit<float>(
+                array_max(res->Prespoints, N_RES_POINTS), 1.0f, INFINITY);
+            const float x  = limit((logf(freq*i) - l1) / l2, 0.0f,
+                                   (float)INFINITY) * N_RES_POINTS;
+            const float dx = x - floor(x);
+            const int kx1  = limit<int>(floor(x), 0, N_RES_POINTS - 1);
+            const int kx2  = limit<int>(kx1 + 1,  0, N_RES_POINTS - 1);
+            const float y  =
+                ((res->Prespoints[kx1] * (1.0f - dx)
+                  + res->Prespoints[kx2] * dx) - upper) / 127.0f;
+            if(res->Pprotectthefundamental && i == 1)
+                return 1.0f;
+            return powf(10.0f, y * res->PmaxdB / 20.0f);
+        }
+
+        //Largest difference in dB between applyres() and the old code
+        float maxError(float freq) {
+            res->updatecurve();
+            fft_t data[HARMONICS];
+            for(int i = 0; i < HARMONICS; ++i)
+                data[i] = fft_t(1.0, 0.0);
+            res->applyres(HARMONICS, data, freq);
+
+            float err = 0.0f;
+            for(int i = 1; i < HARMONICS; ++i) {
+                const float e = fabsf(rap2dB(abs(data[i]))
+                                      - rap2dB(oldres(i, freq)));
+                err = max(err, e);
+            }
+            return err;
+        }
+
+        void randomPoints() {
+            for(int i = 0; i < N_RES_POINTS; ++i) {
+                seed = seed * 1103515245 + 12345;
+                res->setpoint(i, (seed >> 16) % 128);
+            }
+        }
+
+        void testSmoothCurve() {
+            randomPoints();
+            res->smooth();
+            res->smooth();
+            const float freqs[4] = {27.5f, 110.0f, 440.0f, 1760.0f};
+            for(float freq:freqs)
+                TS_ASSERT_LESS_THAN(maxError(freq), 0.1f);
+
+            //the controllers only move the frequency axis
+            res->sendcontroller(C_resonance_center, 1.7f);
+            res->sendcontroller(C_resonance_bandwidth, 0.6f);
+            for(float freq:freqs)
+                TS_ASSERT_LESS_THAN(maxError(freq), 0.1f);
+        }
+
+        //Random points at the largest range, smoothed once like randomize()
+        void testExtremeCurve() {
+            res->PmaxdB = 127;
+            randomPoints();
+            res->smooth();
+            const float freqs[3] = {55.0f, 261.6f, 1000.0f};
+            for(float freq:freqs)
+                TS_ASSERT_LESS_THAN(maxError(freq), 0.3f);
+        }
+
+        void testChanges() {
+            res->Pprotectthefundamental = 1;
+            TS_ASSERT_LESS_THAN(maxError(100.0f), 0.1f);
+
+            //every way of editing the points updates the response
+            res->setpoint(100, 127);
+            TS_ASSERT_LESS_THAN(maxError(100.0f), 0.1f);
+            res->interpolatepeaks(0);
+            TS_ASSERT_LESS_THAN(maxError(100.0f), 0.1f);
+            res->zero();
+            TS_ASSERT_LESS_THAN(maxError(100.0f), 0.1f);
+
+            //direct writes from the ports mark the curve
+            res->Prespoints[40] = 0;
+            res->PmaxdB         = 60;
+            res->curvechanged();
+            TS_ASSERT_LESS_THAN(maxError(100.0f), 0.1f);
+            res->Pprotectthefundamental = 0;
+            TS_ASSERT_DELTA(res->getfreqresponse(res->getfreqx(0.5f)),
+                            oldres(1, res->getfreqx(0.5f)), 1e-3);
+        }
+
+        //The readers never update the curve, a new one is prepared for the
+        //realtime side instead
+        void testPrepare() {
+            TS_ASSERT(!res->preparecurve());
+            const float freq   = res->getfreqx(0.3f);
+            const float before = res->getfreqresponse(freq);
+            TS_ASSERT_DELTA(before, 1.0f, 1e-6);
+
+            randomPoints();
+            res->smooth();
+            TS_ASSERT_EQUALS(res->getfreqresponse(freq), before);
+            fft_t data[HARMONICS];
+            for(int i = 0; i < HARMONICS; ++i)
+                data[i] = fft_t(1.0, 0.0);
+            res->applyres(HARMONICS, data, 55.0f);
+            for(int i = 1; i < HARMONICS; ++i)
+                TS_ASSERT_EQUALS(abs(data[i]), 1.0f);
+
+            float *curve = res->preparecurve();
+            TS_ASSERT(curve);
+            TS_ASSERT(!res->preparecurve());
+            TS_ASSERT_EQUALS(res->getfreqresponse(freq), before);
+
+            //the prepared curve matches one computed in place
+            Resonance other;
+            other.paste(*res);
+            other.curvechanged();
+            other.updatecurve();
+            const float x = res->getfreqpos(freq) * N_RES_POINTS
+                            * RES_OVERSAMPLE;
+            const int   k = (int)x;
+            TS_ASSERT_DELTA(other.getfreqresponse(freq),
+                            curve[k] + (curve[k + 1] - curve[k]) * (x - k),
+                            1e-5);
+            delete[] curve;
+        }
+
+    private:
+        Resonance *res;
+        unsigned   seed;
+};
@@ -0,0 +1,130 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  TransportTest.h - CxxTest for the musical clock and tempo synced effects
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include "../Effects/Echo.h"
+#include "../Misc/Allocator.h"
+#include "../Misc/Time.h"
+#include "../globals.h"
+
+using namespace std;
+using namespace zyn;
+
+SYNTH_T *synth;
+
+class TransportTest:public CxxTest::TestSuite
+{
+    public:
+        void setUp() {
+            synth     = new SYNTH_T;
+            transport = new Transport(44100, 256);
+            outL      = new float[synth->buffersize];
+            outR      = new float[synth->buffersize];
+            inL       = new float[synth->buffersize];
+            inR       = new float[synth->buffersize];
+            for(int i = 0; i < synth->buffersize; ++i)
+                outL[i] = outR[i] = inL[i] = inR[i] = 0.0f;
+            EffectParams pars{alloc, true, outL, outR, 0, 44100, 256, nullptr,
+                              false, transport};
+            echo = new Echo(pars);
+        }
+
+        void tearDown() {
+            delete echo;
+            delete[] inR;
+            delete[] inL;
+            delete[] outR;
+            delete[] outL;
+            delete transport;
+            delete synth;
+        }
+
+        //Samples from an impulse to its first echo
+        int echoDelay() {
+            echo->cleanup();
+            int t = 0;
+            for(int n = 0; n < 400; ++n) {
+                for(int i = 0; i < synth->buffersize; ++i)
+                    inL[i] = inR[i] = (n == 0 && i == 0) ? 1.0f : 0.0f;
+                echo->out(Stereo<float *>(inL, inR));
+                for(int i = 0; i < synth->buffersize; ++i, ++t)
+                    if(fabsf(outL[i]) > 1e-3)
+                        return t;
+            }
+            return -1;
+        }
+
+        void testTempoClamp() {
+            transport->setTempo(5000.0f);
+            TS_ASSERT_EQUALS(transport->bpm(), 999.0f);
+            transport->setTempo(0.0f);
+            TS_ASSERT_EQUALS(transport->bpm(), 1.0f);
+            transport->setHost(2000.0f, 0.0, true);
+            transport->locate(0);
+            TS_ASSERT_EQUALS(transport->bpm(), 999.0f);
+        }
+
+        void testLocate() {
+            //the host reports bar 2, beat 1 (4/4) at 90 bpm
+            transport->setHost(90.0f, 4.0, true);
+            TS_ASSERT(!transport->hostSync());
+
+            //40 leftover samples were played before the next buffer
+            transport->skip(40);
+            transport->locate(0);
+            const double perSample = 90.0 / (60.0 * 44100);
+            TS_ASSERT(transport->hostSync());
+            TS_ASSERT(transport->playing());
+            TS_ASSERT_DELTA(transport->beat(), 4.0 + 40 * perSample, 1e-9);
+
+            //the buffer starts 100 samples after the reported position
+            transport->setHost(90.0f, 8.0, true);
+            transport->locate(100);
+            TS_ASSERT_DELTA(transport->beat(), 8.0 + 100 * perSample, 1e-9);
+            TS_ASSERT_DELTA(transport->beatAt(10), 8.0 + 110 * perSample,
+                            1e-9);
+
+            //without a new report the clock runs on one buffer at a time
+            ++*transport;
+            TS_ASSERT_DELTA(transport->beat(), 8.0 + 356 * perSample, 1e-9);
+            transport->locate(0);
+            TS_ASSERT_DELTA(transport->beat(), 8.0 + 356 * perSample, 1e-9);
+        }
+
+        void testEchoFollowsTempo() {
+            transport->setTempo(120.0f);
+            echo->changepar(7, 6); //a quarter note
+            TS_ASSERT_EQUALS(echoDelay(), 22050);
+
+            //the delay glides to the new length, which takes some buffers
+            transport->setTempo(90.0f);
+            for(int i = 0; i < 100; ++i)
+                echo->out(Stereo<float *>(inL, inR));
+            TS_ASSERT_DELTA(echoDelay(), 29400, 16);
+
+            //dotted eighth at 90 bpm
+            echo->changepar(7, 5);
+            TS_ASSERT_EQUALS(echoDelay(), 22050);
+
+            //without sync the delay parameter is used again
+            echo->changepar(7, 0);
+            echo->changepar(2, 64);
+            TS_ASSERT_EQUALS(echoDelay(),
+                             (int)(64 / 127.0f * 1.5f * 44100));
+        }
+
+    private:
+        float *inL, *inR, *outL, *outR;
+        Transport *transport;
+        Echo *echo;
+        AllocatorClass alloc;
+};
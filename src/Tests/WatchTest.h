@@ -51,7 +51,7 @@ class WatchTest:public CxxTest::TestSuite
             at  = new AbsTime(*s);
             w   = new WatchManager(tr);
             par = new LFOParams;
-            l   = new LFO(*par, 440.0, *at, w);
+            l   = new LFO(*par, 440.0, *at, 0x1234, w);
         }
 
         void tearDown() {
@@ -0,0 +1,304 @@
+/*
+  ZynAddSubFX - a software synthesizer
+
+  WavFileTest.h - CxxTest for Misc/WavFile and Nio/WavEngine
+  Copyright (C) 2026 agent
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+*/
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../Misc/WavFile.h"
+#include "../Nio/WavEngine.h"
+#include "../globals.h"
+using namespace std;
+using namespace zyn;
+
+SYNTH_T *synth;
+
+typedef vector<unsigned char> bytes;
+
+static uint64_t le(const unsigned char *p, int n)
+{
+    uint64_t v = 0;
+    for(int i = n - 1; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+//Chunks of a RIFF/RF64 file
+struct Chunk {
+    string   id;
+    uint32_t size;
+    const unsigned char *data;
+};
+
+static vector<Chunk> chunks(const bytes &b)
+{
+    vector<Chunk> res;
+    for(size_t pos = 12; pos + 8 <= b.size();) {
+        Chunk c{string((const char *)&b[pos], 4), (uint32_t)le(&b[pos + 4], 4),
+                &b[pos + 8]};
+        res.push_back(c);
+        if(c.size == 0xffffffff) //RF64 data chunk
+            break;
+        pos += 8 + c.size + (c.size & 1);
+    }
+    return res;
+}
+
+static const Chunk *find(const vector<Chunk> &c, const char *id)
+{
+    for(auto &chunk:c)
+        if(chunk.id == id)
+            return &chunk;
+    return NULL;
+}
+
+static bytes readFile(const string &name)
+{
+    bytes b;
+    FILE *f = fopen(name.c_str(), "rb");
+    if(!f)
+        return b;
+    unsigned char buf[4096];
+    size_t n;
+    while((n = fread(buf, 1, sizeof(buf), f)))
+        b.insert(b.end(), buf, buf + n);
+    fclose(f);
+    return b;
+}
+
+class WavFileTest:public CxxTest::TestSuite
+{
+    public:
+        void setUp() {
+            synth = new SYNTH_T;
+            //a small ring (64 slots) so that the tests wrap around it
+            synth->samplerate = 4096;
+            synth->buffersize = 256;
+            synth->alias();
+            char tmp[] = "/tmp/zyn-wav-XXXXXX";
+            dir = mkdtemp(tmp);
+        }
+
+        void tearDown() {
+            for(int i = 0; i < 3; ++i)
+                unlink(path(i).c_str());
+            rmdir(dir.c_str());
+            delete synth;
+        }
+
+        string path(int i) const {
+            return dir + "/track" + to_string(i) + ".wav";
+        }
+
+        //Write a stereo ramp and read it back
+        void roundTrip(WavFile::Format format, int width, int tag, float tol) {
+            const int frames = 1001; //odd, so that the data chunk is padded
+            vector<float> smps(2 * frames);
+            for(int i = 0; i < 2 * frames; ++i)
+                smps[i] = (i % 401) / 200.0f - 1.0f;
+            WavFile *wav = new WavFile(path(0), 48000, 2, format);
+            TS_ASSERT(wav->good());
+            wav->writeStereoSamples(500, smps.data());
+            wav->writeStereoSamples(frames - 500, smps.data() + 1000);
+            delete wav;
+
+            const bytes b = readFile(path(0));
+            TS_ASSERT(b.size() > 12);
+            if(b.size() <= 12)
+                return;
+            TS_ASSERT(!memcmp(b.data(), "RIFF", 4));
+            TS_ASSERT_EQUALS(le(&b[4], 4), b.size() - 8);
+            TS_ASSERT(!memcmp(&b[8], "WAVE", 4));
+
+            const vector<Chunk> c = chunks(b);
+            const Chunk *junk = find(c, "JUNK"), *fmt = find(c, "fmt "),
+                        *data = find(c, "data");
+            TS_ASSERT(junk && fmt && data);
+            if(!junk || !fmt || !data)
+                return;
+            TS_ASSERT_EQUALS(junk->size, 28u);
+            TS_ASSERT_EQUALS(le(fmt->data, 2), (uint64_t)tag);
+            TS_ASSERT_EQUALS(le(fmt->data + 2, 2), 2u);
+            TS_ASSERT_EQUALS(le(fmt->data + 4, 4), 48000u);
+            TS_ASSERT_EQUALS(le(fmt->data + 8, 4), 48000u * 2 * width);
+            TS_ASSERT_EQUALS(le(fmt->data + 12, 2), 2u * width);
+            TS_ASSERT_EQUALS(le(fmt->data + 14, 2), 8u * width);
+            TS_ASSERT_EQUALS(data->size, 2u * width * frames);
+            if(format == WavFile::Float32) {
+                const Chunk *fact = find(c, "fact");
+                TS_ASSERT(fact && le(fact->data, 4) == (uint64_t)frames);
+            }
+
+            for(int i = 0; i < 2 * frames; ++i) {
+                const unsigned char *p = data->data + i * width;
+                float v;
+                if(format == WavFile::Float32)
+                    memcpy(&v, p, 4);
+                else {
+                    //sign extend
+                    const int shift = 32 - 8 * width;
+                    v = (int32_t)(le(p, width) << shift) >> shift;
+                    v /= width == 3 ? 8388607.0f : 32767.0f;
+                }
+                TS_ASSERT_DELTA(v, smps[i], tol);
+            }
+        }
+
+        void testPCM16() {
+            roundTrip(WavFile::PCM16, 2, 1, 1.0f / 32767);
+        }
+
+        void testPCM24() {
+            roundTrip(WavFile::PCM24, 3, 1, 1.0f / 8388607);
+        }
+
+        void testFloat32() {
+            roundTrip(WavFile::Float32, 4, 3, 0.0f);
+        }
+
+        //Past 4GB the JUNK chunk turns into ds64 and the sizes move there
+        void testRF64() {
+            WavFile wav(path(0), 48000, 2, WavFile::PCM24);
+            const uint64_t frames = 800000000; //4.8GB of data
+            const bytes b = wav.header(frames);
+            TS_ASSERT(!memcmp(b.data(), "RF64", 4));
+            TS_ASSERT_EQUALS(le(&b[4], 4), 0xffffffffu);
+
+            const vector<Chunk> c = chunks(b);
+            const Chunk *ds64 = find(c, "ds64"), *data = find(c, "data");
+            TS_ASSERT(ds64 && data && !find(c, "JUNK"));
+            if(!ds64 || !data)
+                return;
+            TS_ASSERT_EQUALS(ds64->size, 28u);
+            TS_ASSERT_EQUALS(le(ds64->data, 8), b.size() - 8 + frames * 6);
+            TS_ASSERT_EQUALS(le(ds64->data + 8, 8), frames * 6);
+            TS_ASSERT_EQUALS(le(ds64->data + 16, 8), frames);
+            TS_ASSERT_EQUALS(data->size, 0xffffffffu);
+
+            //the layout does not change, so the header can be rewritten
+            TS_ASSERT_EQUALS(wav.header(0).size(), b.size());
+        }
+
+        //Buffers pushed through the ring arrive in order, stems included
+        void testRing() {
+            const int bs = synth->buffersize;
+            WavEngine engine(*synth);
+            vector<WavFile *> files;
+            for(int i = 0; i < 2; ++i)
+                files.push_back(new WavFile(path(i), synth->samplerate, 2,
+                                            WavFile::Float32));
+            engine.newFiles(files);
+
+            vector<float> l(2 * bs), r(2 * bs);
+            int n = 0;
+            //three rounds of 50 buffers wrap around the 64 slots, the
+            //writer drains each round when it is stopped
+            for(int round = 0; round < 3; ++round) {
+                engine.Start();
+                for(int b = 0; b < 50; ++b, ++n) {
+                    for(int i = 0; i < bs; ++i) {
+                        l[i] = n + i / 1024.0f;
+                        r[i] = -l[i];
+                    }
+                    //every other buffer has a stem
+                    if(n % 2)
+                        engine.capture(1, l.data(), r.data(), 0.5f);
+                    engine.push(Stereo<float *>(l.data(), r.data()), bs);
+                }
+                engine.Stop();
+            }
+
+            //a push of two buffers at once
+            engine.Start();
+            for(int i = 0; i < 2 * bs; ++i) {
+                l[i] = n + i / 1024.0f;
+                r[i] = -l[i];
+            }
+            engine.push(Stereo<float *>(l.data(), r.data()), 2 * bs);
+            engine.Stop();
+            engine.destroyFile();
+
+            const int frames = n * bs + 2 * bs;
+            for(int t = 0; t < 2; ++t) {
+                const bytes b = readFile(path(t));
+                const vector<Chunk> c = chunks(b);
+                const Chunk *data = find(c, "data");
+                TS_ASSERT(data);
+                if(!data)
+                    continue;
+                TS_ASSERT_EQUALS(data->size, 8u * frames);
+                if(data->size != 8u * frames)
+                    continue;
+                vector<float> smps(2 * frames);
+                memcpy(smps.data(), data->data, data->size);
+                bool ok = true;
+                for(int f = 0; f < frames; ++f) {
+                    const int buf = f / bs, i = f % bs;
+                    float v = buf < n ? buf + i / 1024.0f
+                                      : n + (f - n * bs) / 1024.0f;
+                    if(t == 1)
+                        v = (buf < n && buf % 2) ? v * 0.5f : 0.0f;
+                    ok &= smps[2 * f] == v && smps[2 * f + 1] == -v;
+                }
+                TS_ASSERT(ok);
+            }
+        }
+
+        //Tracks swapped in while recording take the following buffers,
+        //the old ones are written out in full when they are closed
+        void testSwap() {
+            const int bs = synth->buffersize;
+            const int n  = 40;
+            WavEngine engine(*synth);
+            vector<float> l(bs), r(bs);
+            engine.Start();
+            for(int t = 0; t < 2; ++t) {
+                vector<WavFile *> files(1, new WavFile(path(t),
+                            synth->samplerate, 2, WavFile::Float32));
+                engine.closeTracks(engine.swapTracks(engine.newTracks(files)));
+                for(int b = 0; b < n; ++b) {
+                    for(int i = 0; i < bs; ++i) {
+                        l[i] = t + 1 + b / 1024.0f;
+                        r[i] = -l[i];
+                    }
+                    engine.push(Stereo<float *>(l.data(), r.data()), bs);
+                }
+            }
+            engine.Stop();
+            engine.destroyFile();
+
+            for(int t = 0; t < 2; ++t) {
+                const bytes b = readFile(path(t));
+                const vector<Chunk> c = chunks(b);
+                const Chunk *data = find(c, "data");
+                TS_ASSERT(data);
+                if(!data)
+                    continue;
+                TS_ASSERT_EQUALS(data->size, 8u * n * bs);
+                if(data->size != 8u * n * bs)
+                    continue;
+                vector<float> smps(2 * n * bs);
+                memcpy(smps.data(), data->data, data->size);
+                bool ok = true;
+                for(int f = 0; f < n * bs; ++f) {
+                    const float v = t + 1 + (f / bs) / 1024.0f;
+                    ok &= smps[2 * f] == v && smps[2 * f + 1] == -v;
+                }
+                TS_ASSERT(ok);
+            }
+        }
+
+    private:
+        string dir;
+};
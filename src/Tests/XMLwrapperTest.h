@@ -12,13 +12,46 @@
 */
 #include <cxxtest/TestSuite.h>
 #include "../Misc/XMLwrapper.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
 #include "../globals.h"
 using namespace std;
 using namespace zyn;
 
 SYNTH_T *synth;
 
+typedef vector<unsigned char> bytes;
+
+static bytes readFile(const string &name)
+{
+    bytes b;
+    FILE *f = fopen(name.c_str(), "rb");
+    if(!f)
+        return b;
+    unsigned char buf[4096];
+    size_t n;
+    while((n = fread(buf, 1, sizeof(buf), f)))
+        b.insert(b.end(), buf, buf + n);
+    fclose(f);
+    return b;
+}
+
+//little endian words of a binary parameter file
+static uint32_t getWord(const bytes &b, size_t pos)
+{
+    return b[pos] | (b[pos + 1] << 8) | (b[pos + 2] << 16)
+           | ((uint32_t)b[pos + 3] << 24);
+}
+
+static void setWord(bytes &b, size_t pos, uint32_t w)
+{
+    for(int i = 0; i < 4; ++i)
+        b[pos + i] = w >> (8 * i);
+}
+
 class XMLwrapperTest:public CxxTest::TestSuite
 {
     public:
@@ -40,6 +73,101 @@ class XMLwrapperTest:public CxxTest::TestSuite
             xmla->loadXMLfile(location);
         }
 
+        //the binary format stores the same tree as the XML
+        void testBinaryRoundTrip() {
+            string location = string(SOURCE_DIR) + string(
+                "/Tests/guitar-adnote.xmz");
+            const string binary = "xmlwrapper-test.zynb";
+            TS_ASSERT_EQUALS(xmla->loadXMLfile(location), 0);
+            TS_ASSERT_EQUALS(xmla->saveBinaryFile(binary), 0);
+            TS_ASSERT_EQUALS(xmlb->loadXMLfile(binary), 0);
+            remove(binary.c_str());
+
+            char *a = xmla->getXMLdata();
+            char *b = xmlb->getXMLdata();
+            TS_ASSERT(!strcmp(a, b));
+            TS_ASSERT_EQUALS(xmlb->fileversion().get_major(),
+                             xmla->fileversion().get_major());
+            free(a);
+            free(b);
+        }
+
+        int loadBinary(const bytes &b) {
+            const string binary = "xmlwrapper-test.zynb";
+            FILE *f = fopen(binary.c_str(), "wb");
+            fwrite(b.data(), 1, b.size(), f);
+            fclose(f);
+            const int result = xmlb->loadXMLfile(binary);
+            remove(binary.c_str());
+            return result;
+        }
+
+        //references out of the tables and truncated files are rejected
+        void testBinaryCorrupt() {
+            const string binary = "xmlwrapper-test.zynb";
+            xmla->addpar("volume", 100);
+            TS_ASSERT_EQUALS(xmla->saveBinaryFile(binary), 0);
+            const bytes good = readFile(binary);
+            remove(binary.c_str());
+            TS_ASSERT_LESS_THAN(20u, good.size());
+            if(good.size() <= 20)
+                return;
+            TS_ASSERT_EQUALS(loadBinary(good), 0);
+
+            //a header of 5 words, records of 7 words, attributes of 2 words
+            //and then the strings
+            const uint32_t nnodes   = getWord(good, 8);
+            const uint32_t nattrs   = getWord(good, 12);
+            const uint32_t nstrings = getWord(good, 16);
+            const size_t nodes = 20, attrs = nodes + nnodes * 28;
+            size_t withattrs = nnodes;
+            for(size_t i = 0; i < nnodes && withattrs == nnodes; ++i)
+                if(getWord(good, nodes + i * 28 + 24))
+                    withattrs = i;
+            TS_ASSERT(nnodes > 1 && nattrs && withattrs < nnodes);
+            if(nnodes < 2 || !nattrs || withattrs == nnodes)
+                return;
+
+            //truncated or too long
+            TS_ASSERT_EQUALS(loadBinary(bytes(good.begin(), good.end() - 1)),
+                             -2);
+            TS_ASSERT_EQUALS(loadBinary(bytes(good.begin(), good.begin() + 12)),
+                             -2);
+            bytes b = good;
+            b.push_back(0);
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+
+            b = good;
+            setWord(b, 4, 2); //version
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+            b = good;
+            setWord(b, 8, nnodes + 1); //more nodes than the file holds
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+            b = good;
+            setWord(b, nodes, 7); //node type
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+            b = good;
+            setWord(b, nodes + 4, nstrings); //name
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+            b = good;
+            setWord(b, nodes + 28 + 8, 1); //a parent which is not built yet
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+            b = good;
+            setWord(b, nodes + withattrs * 28 + 20, nattrs); //attributes
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+            b = good;
+            setWord(b, attrs, nstrings); //attribute name
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+            b = good;
+            setWord(b, attrs + 4, nstrings + 1); //attribute value
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+            b = good;
+            b.back() = 'x'; //unterminated string
+            TS_ASSERT_EQUALS(loadBinary(b), -2);
+
+            TS_ASSERT_EQUALS(loadBinary(good), 0);
+        }
+
         void testAnotherLoad()
         {
             string dat =
@@ -18,6 +18,7 @@
 #include "../globals.h"
 
 #include <rtosc/rtosc.h>
+#include <vector>
 
 using namespace zyn;
 
@@ -132,12 +133,21 @@ void Fl_EQGraph::draw(void)
     else fl_color(200,200,80);
     fl_line_style(FL_SOLID,2);
     //fl_color( fl_color_add_alpha( fl_color(), 127 ) );
-    oiy=getresponse(ly,getfreqx(0.0));
-    fl_begin_line();
+    std::vector<float> frq(lx);
+    std::vector<int>   resp(lx);
+    int   npoints = 1;
+    frq[0] = getfreqx(0.0);
     for (i=1;i<lx;i++){
-        float frq=getfreqx(i/(float) lx);
-        if (frq>samplerate/2) break;
-        iy=getresponse(ly,frq);
+        frq[i] = getfreqx(i/(float) lx);
+        if (frq[i]>samplerate/2) break;
+        npoints++;
+    }
+    getresponse(ly,frq.data(),resp.data(),npoints);
+
+    oiy=resp[0];
+    fl_begin_line();
+    for (i=1;i<npoints;i++){
+        iy=resp[i];
         if ((oiy>=0) && (oiy<ly) &&
                 (iy>=0) && (iy<ly) )
             fl_vertex(ox+i,oy+ly-iy);
@@ -154,30 +164,32 @@ void Fl_EQGraph::draw(void)
  * This will yield a complex result which will indicate the phase and magnitude
  * transformation of the input at the set frequency denoted by \omega
  */
-double Fl_EQGraph::getresponse(int maxy,float freq) const
+void Fl_EQGraph::getresponse(int maxy, const float *freq, int *iy, int n) const
 {
-    const float angle = 2*PI*freq/samplerate;
-    float mag = 1;
-    //std::complex<float> num_res = 0;
-    //std::complex<float> dem_res = 0;
-         
+    std::vector<float> mag(n, 1.0f);
 
+    //Every biquad is applied to the whole curve at once
     for(int i = 0; i < MAX_EQ_BANDS*MAX_FILTER_STAGES; ++i) {
         if(num[3*i] == 0)
             break;
-        std::complex<float> num_res= 0;
-        std::complex<float> dem_res= 0;
-        for(int j=0; j<3; ++j) {
-            num_res += FFTpolar<float>(num[3*i+j], j*angle);
-            dem_res += FFTpolar<float>(dem[3*i+j], j*angle);
+        for(int k = 0; k < n; ++k) {
+            const float angle = 2*PI*freq[k]/samplerate;
+            std::complex<float> num_res= 0;
+            std::complex<float> dem_res= 0;
+            for(int j=0; j<3; ++j) {
+                num_res += FFTpolar<float>(num[3*i+j], j*angle);
+                dem_res += FFTpolar<float>(dem[3*i+j], j*angle);
+            }
+            mag[k] *= abs(num_res/dem_res);
         }
-        mag *= abs(num_res/dem_res);
     }
 
-    float dbresp=20*log(mag*gain)/log(10);
+    for(int k = 0; k < n; ++k) {
+        float dbresp=20*log(mag[k]*gain)/log(10);
 
-    //rescale
-    return (int) ((dbresp/MAX_DB+1.0)*maxy/2.0);
+        //rescale
+        iy[k] = (int) ((dbresp/MAX_DB+1.0)*maxy/2.0);
+    }
 }
 
 float Fl_EQGraph::getfreqx(float x) const
@@ -17,22 +17,12 @@
 
 namespace zyn {
 
-void SYNTH_T::alias(bool randomize)
+void SYNTH_T::alias(void)
 {
     halfsamplerate_f = (samplerate_f = samplerate) / 2.0f;
     buffersize_f     = buffersize;
     bufferbytes      = buffersize * sizeof(float);
     oscilsize_f      = oscilsize;
-
-    //produce denormal buf
-    // note: once there will be more buffers, use a cleanup function
-    // for deleting the buffers and also call it in the dtor
-    denormalkillbuf.resize(buffersize);
-    for(int i = 0; i < buffersize; ++i)
-        if(randomize)
-            denormalkillbuf[i] = (RND - 0.5f) * 1e-16;
-        else
-            denormalkillbuf[i] = 0;
 }
 
 }
@@ -46,6 +46,7 @@ class  SynthNote;
 
 class  Allocator;
 class  AbsTime;
+class  Transport;
 class  RelTime;
 
 class  Microtonal;
@@ -124,6 +125,19 @@ typedef std::complex<fftw_real> fft_t;
  */
 #define NUM_INS_EFX 8
 
+/*
+ * Number of stereo output buses: the main mix and one for each part and
+ * system effect
+ */
+#define NUM_OUT_BUSES (1 + NUM_MIDI_PARTS + NUM_SYS_EFX)
+
+/*
+ * Output bus setting of a part for the main mix along with a bus of its own
+ * (bus N + 1 for part N) if the driver provides it. This is the default, as
+ * it is how the multichannel drivers played parts before there were buses.
+ */
+#define OUT_BUS_OWN NUM_OUT_BUSES
+
 /*
  * Number of part's insertion effects
  */
@@ -268,43 +282,18 @@ enum LegatoMsg {
 #define O_BINARY 0
 #endif
 
-template<class T>
-class m_unique_ptr
-{
-    T* ptr = nullptr;
-public:
-    m_unique_ptr() = default;
-    m_unique_ptr(m_unique_ptr&& other) {
-        ptr = other.ptr;
-        other.ptr = nullptr;
-    }
-    m_unique_ptr(const m_unique_ptr& other) = delete;
-    ~m_unique_ptr() { ptr = nullptr; }
-    void resize(unsigned sz) {
-        delete[] ptr;
-        ptr = new T[sz]; }
-
-    operator T*() { return ptr; }
-    operator const T*() const { return ptr; }
-    //T& operator[](unsigned idx) { return ptr[idx]; }
-    //const T& operator[](unsigned idx) const { return ptr[idx]; }
-};
-
 //temporary include for synth->{samplerate/buffersize} members
 struct SYNTH_T {
 
     SYNTH_T(void)
         :samplerate(44100), buffersize(256), oscilsize(1024)
     {
-        alias(false);
+        alias();
     }
 
     SYNTH_T(const SYNTH_T& ) = delete;
     SYNTH_T(SYNTH_T&& ) = default;
 
-    /** the buffer to add noise in order to avoid denormalisation */
-    m_unique_ptr<float> denormalkillbuf;
-
     /**Sampling rate*/
     unsigned int samplerate;
 
@@ -336,8 +325,7 @@ struct SYNTH_T {
     {
         return buffersize_f / samplerate_f;
     }
-    void alias(bool randomize=true);
-    static float numRandom(void); //defined in Util.cpp for now
+    void alias(void);
 };
 
 }
@@ -17,6 +17,7 @@
 #include <map>
 #include <cmath>
 #include <cctype>
+#include <cstring>
 #include <ctime>
 #include <algorithm>
 #include <signal.h>
@@ -46,6 +47,7 @@
 //Nio System
 #include "Nio/Nio.h"
 #include "Nio/InMgr.h"
+#include "Nio/OutMgr.h"
 
 //GUI System
 #include "UI/Connection.h"
@@ -240,6 +242,7 @@ int main(int argc, char *argv[])
     synth.buffersize = config.cfg.SoundBufferSize;
     synth.oscilsize  = config.cfg.OscilSize;
     swaplr = config.cfg.SwapStereo;
+    Nio::resampleQuality = config.cfg.ResampleQuality;
 
     Nio::preferredSampleRate(synth.samplerate);
 
@@ -317,6 +320,15 @@ int main(int argc, char *argv[])
         {
             "dump-json-schema", 2, NULL, 'D'
         },
+        {
+            "render", 1, NULL, 'R'
+        },
+        {
+            "render-output", 1, NULL, 'W'
+        },
+        {
+            "render-format", 1, NULL, 'F'
+        },
         // options without single char equivalents ("getopt_flag" compulsory)
         {
             "list-inputs", no_argument, &getopt_flag, 'i'
@@ -324,6 +336,15 @@ int main(int argc, char *argv[])
         {
             "list-outputs", no_argument, &getopt_flag, 'o'
         },
+        {
+            "null-period", required_argument, &getopt_flag, 'n'
+        },
+        {
+            "render-rate", required_argument, &getopt_flag, 's'
+        },
+        {
+            "null-realtime", no_argument, &getopt_flag, 'f'
+        },
         {
             0, 0, 0, 0
         }
@@ -344,6 +365,11 @@ int main(int argc, char *argv[])
     int wmidi = -1;
 
     string loadfile, loadinstrument, execAfterInit, loadmidilearn;
+    string renderfile, renderoutput;
+    int    renderformat = 0;
+    int    renderrate   = 0;
+    int    nullperiod   = 0;
+    bool   nullrealtime = false;
 
     while(1) {
         int tmp = 0;
@@ -351,7 +377,7 @@ int main(int argc, char *argv[])
         /**\todo check this process for a small memory leak*/
         opt = getopt_long(argc,
                           argv,
-                          "l:L:M:r:b:o:I:O:N:e:P:A:d:D:hvapSDUYZ",
+                          "l:L:M:r:b:o:I:O:N:e:P:A:d:D:R:W:F:hvapSDUYZ",
                           opts,
                           &option_index);
         char *optarguments = optarg;
@@ -477,6 +503,25 @@ int main(int argc, char *argv[])
                 if(optarguments)
                     wmidi = atoi(optarguments);
                 break;
+            case 'R':
+                GETOP(renderfile);
+                break;
+            case 'W':
+                GETOP(renderoutput);
+                break;
+            case 'F':
+                if(!optarguments || !strcmp(optarguments, "16"))
+                    renderformat = 0;
+                else if(!strcmp(optarguments, "24"))
+                    renderformat = 1;
+                else if(!strcmp(optarguments, "float"))
+                    renderformat = 2;
+                else {
+                    cerr << "ERROR:Incorrect render format: " << optarguments
+                         << endl;
+                    exit(1);
+                }
+                break;
             case 0: // catch options without single char equivalent
                 switch(getopt_flag)
                 {
@@ -486,6 +531,23 @@ int main(int argc, char *argv[])
                     case 'o':
                         exit_with = exit_with_t::list_outputs;
                         break;
+                    case 'n':
+                        GETOPNUM(nullperiod);
+                        if(nullperiod < 0) {
+                            cerr << "ERROR:Incorrect null period" << endl;
+                            exit(1);
+                        }
+                        break;
+                    case 'f':
+                        nullrealtime = true;
+                        break;
+                    case 's':
+                        GETOPNUM(renderrate);
+                        if(renderrate < 4000) {
+                            cerr << "ERROR:Incorrect render rate" << endl;
+                            exit(1);
+                        }
+                        break;
                 }
                 break;
             case '?':
@@ -528,6 +590,16 @@ int main(int argc, char *argv[])
                  << "  -e , --exec-after-init\t\t Run post-initialization script\n"
                  << "  -d , --dump-oscdoc=FILE\t\t Dump oscdoc xml to file\n"
                  << "  -D , --dump-json-schema=FILE\t\t Dump osc schema (.json) to file\n"
+                 << "  -R , --render=FILE\t\t\t Render a MIDI file to a .wav file\n"
+                 << "\t\t\t\t\t as fast as possible and exit\n"
+                 << "  -W , --render-output=FILE\t\t Set the rendered .wav file\n"
+                 << "  -F , --render-format=FORMAT\t\t Set the rendered sample format\n"
+                 << "\t\t\t\t\t (16, 24 or float)\n"
+                 << "  --render-rate=SR\t\t\t Set the sample rate of the rendered\n"
+                 << "\t\t\t\t\t .wav file (defaults to the synth's)\n"
+                 << "  --null-period=FRAMES\t\t\t Set the period of the NULL output\n"
+                 << "\t\t\t\t\t (defaults to the buffer size)\n"
+                 << "  --null-realtime\t\t\t Run the NULL output with SCHED_FIFO\n"
                  << endl;
             break;
         case exit_with_t::list_inputs:
@@ -559,6 +631,27 @@ int main(int argc, char *argv[])
     cerr << "Internal latency = \t" << synth.dt() * 1000.0f << " ms" << endl;
     cerr << "ADsynth Oscil.Size = \t" << synth.oscilsize << " samples" << endl;
 
+    //Offline rendering runs without user interface or realtime drivers
+    if(!renderfile.empty()) {
+        if(renderoutput.empty()) {
+            renderoutput = renderfile;
+            const size_t ext = renderoutput.rfind('.');
+            if(ext != string::npos && renderoutput.find('/', ext) == string::npos)
+                renderoutput.erase(ext);
+            renderoutput += ".wav";
+        }
+        noui = 1;
+        Nio::setRender(renderfile, renderoutput, renderformat, renderrate);
+    }
+    //the buffer of OutMgr holds a period and the leftovers of the last one
+    if(nullperiod + synth.buffersize > OutMgr::maxFrames) {
+        cerr << "ERROR:The null period may be at most "
+             << OutMgr::maxFrames - synth.buffersize
+             << " frames with this buffer size" << endl;
+        exit(1);
+    }
+    Nio::setNullClock(nullperiod, nullrealtime);
+
     initprogram(std::move(synth), &config, preferred_port);
 
     bool altered_master = false;
@@ -800,6 +893,8 @@ done:
 #ifdef WIN32
         Sleep(1);
 #endif
+        if(!renderfile.empty() && Nio::renderDone())
+            Pexitprogram = 1;
 
 #ifdef ZEST_GUI
 #ifndef WIN32
@@ -828,6 +923,8 @@ done:
 #else
     (void)already_exited;
 #endif
+    //a render which could not read or write its files fails
+    const int status = !renderfile.empty() && Nio::renderFailed();
     exitprogram(config);
-    return 0;
+    return status;
 }